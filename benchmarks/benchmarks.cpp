@@ -0,0 +1,556 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+/*
+ * Throughput benchmarks for the hot kernels, built with SST_BASIC_BLOCKS_BUILD_BENCHMARKS.
+ * Each kernel runs at several block sizes and reports ns per sample and samples per second
+ * as JSON, so two runs can be diffed to catch regressions.
+ *
+ *   sst-basic-blocks-benchmarks [--filter substring] [--ms per-run-ms] [--out file.json]
+ */
+
+// the AVX kernels are only compiled when immintrin.h comes first
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+#include "smoke_test_sse.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "sst/basic-blocks/mechanics/block-ops.h"
+#include "sst/basic-blocks/mechanics/endian-block-ops.h"
+#include "sst/basic-blocks/dsp/FastMath.h"
+#include "sst/basic-blocks/dsp/LanczosResampler.h"
+#include "sst/basic-blocks/dsp/OversampledClipper.h"
+#include "sst/basic-blocks/dsp/SSESincDelayLine.h"
+#include "sst/basic-blocks/tables/SincTableProvider.h"
+#include "sst/basic-blocks/mod-matrix/ModMatrix.h"
+#include "sst/basic-blocks/mod-matrix/VoiceGroupScheduler.h"
+#include "sst/basic-blocks/modulators/ADSREnvelope.h"
+#include "sst/basic-blocks/modulators/ADAREnvelope.h"
+#include "sst/basic-blocks/modulators/AHDSRShapedSC.h"
+#include "sst/basic-blocks/modulators/DAHDEnvelope.h"
+#include "sst/basic-blocks/modulators/DAHDSREnvelope.h"
+#include "sst/basic-blocks/modulators/DAREnvelope.h"
+#include "sst/basic-blocks/modulators/SimpleLFO.h"
+
+namespace sbb = sst::basic_blocks;
+
+namespace
+{
+struct Result
+{
+    std::string name;
+    int blockSize;
+    double nsPerSample;
+    double samplesPerSecond;
+};
+
+struct Runner
+{
+    std::string filter;
+    double msPerRun{20};
+    std::vector<Result> results;
+
+    // kernels write here so the optimizer can't drop their work
+    volatile float sink{0};
+
+    /*
+     * f processes samplesPerCall samples. It is warmed up, the repeat count is sized so one
+     * run takes about msPerRun, and the median of five runs is reported.
+     */
+    template <typename F>
+    void measure(const std::string &name, int blockSize, size_t samplesPerCall, F &&f)
+    {
+        if (!filter.empty() && name.find(filter) == std::string::npos)
+            return;
+
+        using clock = std::chrono::steady_clock;
+        auto elapsedNs = [](clock::time_point a, clock::time_point b) {
+            return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count();
+        };
+
+        size_t calls = 1;
+        while (true)
+        {
+            auto s = clock::now();
+            for (size_t i = 0; i < calls; ++i)
+                f();
+            auto ns = elapsedNs(s, clock::now());
+            if (ns > msPerRun * 1e6 * 0.25 || calls > ((size_t)1 << 30))
+            {
+                calls = std::max((size_t)1, (size_t)(calls * msPerRun * 1e6 / std::max(ns, 1.0)));
+                break;
+            }
+            calls *= 2;
+        }
+
+        std::vector<double> nsPer;
+        for (int run = 0; run < 5; ++run)
+        {
+            auto s = clock::now();
+            for (size_t i = 0; i < calls; ++i)
+                f();
+            nsPer.push_back(elapsedNs(s, clock::now()) / (double)(calls * samplesPerCall));
+        }
+        std::sort(nsPer.begin(), nsPer.end());
+        auto median = nsPer[nsPer.size() / 2];
+        results.push_back({name, blockSize, median, 1e9 / median});
+        std::cerr << name << " bs=" << blockSize << " " << median << " ns/sample\n";
+    }
+
+    void writeJSON(std::ostream &os) const
+    {
+        os << "{\n  \"library\": \"sst-basic-blocks\",\n"
+           << "  \"avx\": " << (SST_BASIC_BLOCKS_AVX ? "true" : "false") << ",\n"
+           << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto &r = results[i];
+            char line[512];
+            snprintf(line, sizeof(line),
+                     "    {\"name\": \"%s\", \"block_size\": %d, \"ns_per_sample\": %.4f, "
+                     "\"samples_per_sec\": %.1f}%s\n",
+                     r.name.c_str(), r.blockSize, r.nsPerSample, r.samplesPerSecond,
+                     i + 1 == results.size() ? "" : ",");
+            os << line;
+        }
+        os << "  ]\n}\n";
+    }
+};
+
+template <int... sizes, typename F> void forBlockSizes(F &&f)
+{
+    (f(std::integral_constant<int, sizes>()), ...);
+}
+
+template <int BS> struct SRProvider
+{
+    double samplerate{48000}, sampleRateInv{1.0 / 48000};
+    float envelope_rate_linear_nowrap(float f) const { return BS * sampleRateInv * pow(2.f, -f); }
+};
+
+void fillNoise(float *d, size_t n)
+{
+    uint32_t s{0x1234567};
+    for (size_t i = 0; i < n; ++i)
+    {
+        s = s * 1664525 + 1013904223;
+        d[i] = (float)(s >> 8) / (float)(1 << 23) - 1.f;
+    }
+}
+
+void benchBlockOps(Runner &r)
+{
+    namespace mech = sbb::mechanics;
+    forBlockSizes<16, 32, 64, 128, 256>([&r](auto bsc) {
+        static constexpr int bs = decltype(bsc)::value;
+        float a alignas(32)[bs], b alignas(32)[bs], c alignas(32)[bs];
+        fillNoise(a, bs);
+        fillNoise(b, bs);
+        fillNoise(c, bs);
+
+        r.measure("block-ops/copy_from_to", bs, bs, [&]() {
+            mech::copy_from_to<bs>(a, c);
+            r.sink = r.sink + c[0];
+        });
+        r.measure("block-ops/accumulate_from_to", bs, bs, [&]() {
+            mech::accumulate_from_to<bs>(a, c);
+            r.sink = r.sink + c[bs - 1];
+            c[bs - 1] = 0;
+        });
+        r.measure("block-ops/mul_block", bs, bs, [&]() {
+            mech::mul_block<bs>(a, b, c);
+            r.sink = r.sink + c[0];
+        });
+        bool up{false};
+        r.measure("block-ops/scale_by", bs, bs, [&]() {
+            // alternate so the values neither decay into denormals nor blow up
+            mech::scale_by<bs>(up ? 2.f : 0.5f, c);
+            up = !up;
+            r.sink = r.sink + c[0];
+        });
+        r.measure("block-ops/blockAbsMax", bs, bs,
+                  [&]() { r.sink = r.sink + mech::blockAbsMax<bs>(a); });
+    });
+}
+
+void benchEndianBlocks(Runner &r)
+{
+    namespace mech = sbb::mechanics;
+    static constexpr int n{4096};
+    auto f = std::make_unique<float[]>(n);
+    auto bytes = std::make_unique<uint8_t[]>(n * 4);
+    fillNoise(f.get(), n);
+    mech::endian_write_block_int32BE(bytes.get(), f.get(), n);
+
+    // the per value path a loader would otherwise take
+    r.measure("endian/read-int16BE-scalar", n, n, [&]() {
+        auto s = (const uint16_t *)bytes.get();
+        for (int i = 0; i < n; ++i)
+            f[i] = (int16_t)mech::endian_read_int16BE(s[i]) * (1.f / 32768.f);
+        r.sink = r.sink + f[n - 1];
+    });
+    r.measure("endian/read-int16BE", n, n, [&]() {
+        mech::endian_read_block_int16BE(f.get(), bytes.get(), n);
+        r.sink = r.sink + f[n - 1];
+    });
+    r.measure("endian/read-int24BE", n, n, [&]() {
+        mech::endian_read_block_int24BE(f.get(), bytes.get(), n);
+        r.sink = r.sink + f[n - 1];
+    });
+    r.measure("endian/read-float32BE", n, n, [&]() {
+        mech::endian_read_block_float32BE(f.get(), bytes.get(), n);
+        r.sink = r.sink + f[n - 1];
+    });
+    r.measure("endian/write-int24BE", n, n, [&]() {
+        mech::endian_write_block_int24BE(bytes.get(), f.get(), n);
+        r.sink = r.sink + bytes[0];
+    });
+}
+
+void benchFastMath(Runner &r)
+{
+    namespace sdsp = sbb::dsp;
+    forBlockSizes<16, 64, 256>([&r](auto bsc) {
+        static constexpr int bs = decltype(bsc)::value;
+        float in alignas(16)[bs], out alignas(16)[bs];
+        fillNoise(in, bs);
+        for (auto &f : in)
+            f = f * 3.f;
+
+        auto run = [&](const char *name, auto fn) {
+            r.measure(std::string("fastmath/") + name, bs, bs, [&]() {
+                for (int i = 0; i < bs; i += 4)
+                    _mm_store_ps(out + i, fn(_mm_load_ps(in + i)));
+                r.sink = r.sink + out[bs - 1];
+            });
+        };
+        run("fastsinSSE", [](__m128 x) { return sdsp::fastsinSSE(x); });
+        run("fastcosSSE", [](__m128 x) { return sdsp::fastcosSSE(x); });
+        run("fastsinPolySSE<5>", [](__m128 x) { return sdsp::fastsinPolySSE<5>(x); });
+        run("fasttanhSSEclamped", [](__m128 x) { return sdsp::fasttanhSSEclamped(x); });
+        run("fastexpSSE", [](__m128 x) { return sdsp::fastexpSSE(x); });
+        run("fastpow2SSE", [](__m128 x) { return sdsp::fastpow2SSE(x); });
+        run("fastlog2SSE", [](__m128 x) {
+            return sdsp::fastlog2SSE(_mm_add_ps(x, _mm_set1_ps(4.f)));
+        });
+        run("fastatanSSE", [](__m128 x) { return sdsp::fastatanSSE(x); });
+        run("std::sin", [](__m128 x) {
+            float v alignas(16)[4];
+            _mm_store_ps(v, x);
+            for (auto &f : v)
+                f = std::sin(f);
+            return _mm_load_ps(v);
+        });
+    });
+}
+
+void benchLanczos(Runner &r)
+{
+    forBlockSizes<16, 32, 64, 128>([&r](auto bsc) {
+        static constexpr int bs = decltype(bsc)::value;
+        auto rs = std::make_unique<sbb::dsp::LanczosResampler<bs>>(48000, 44100);
+        float inL alignas(16)[bs * 2], inR alignas(16)[bs * 2];
+        float outL alignas(16)[bs], outR alignas(16)[bs];
+        fillNoise(inL, bs * 2);
+        fillNoise(inR, bs * 2);
+
+        r.measure("LanczosResampler/48k-44.1k", bs, bs, [&]() {
+            auto need = rs->inputsRequiredToGenerateOutputs(bs);
+            for (size_t i = 0; i < need && i < bs * 2; ++i)
+                rs->push(inL[i], inR[i]);
+            auto got = rs->populateNext(outL, outR, bs);
+            r.sink = r.sink + outL[got ? got - 1 : 0];
+        });
+    });
+}
+
+void benchOversampledClipper(Runner &r)
+{
+    forBlockSizes<16, 32, 64, 128>([&r](auto bsc) {
+        static constexpr int bs = decltype(bsc)::value;
+        float in alignas(16)[bs], out alignas(16)[bs];
+        fillNoise(in, bs);
+        for (auto &f : in)
+            f = f * 4.f;
+
+        auto c2 = std::make_unique<sbb::dsp::OversampledClipper<bs, 2>>();
+        r.measure("OversampledClipper/softclip-2x", bs, bs, [&]() {
+            c2->process_block(in, out);
+            r.sink = r.sink + out[bs - 1];
+        });
+        auto c4 = std::make_unique<sbb::dsp::OversampledClipper<bs, 4>>();
+        r.measure("OversampledClipper/softclip-4x", bs, bs, [&]() {
+            c4->process_block(in, out);
+            r.sink = r.sink + out[bs - 1];
+        });
+    });
+}
+
+void benchSincDelay(Runner &r)
+{
+    static auto sinc = std::make_unique<sbb::tables::SurgeSincTableProvider>();
+    forBlockSizes<16, 32, 64, 128>([&r](auto bsc) {
+        static constexpr int bs = decltype(bsc)::value;
+        auto line = std::make_unique<sbb::dsp::SSESincDelayLine<8192>>(*sinc);
+        float in alignas(16)[bs], delays alignas(16)[bs], out alignas(16)[bs];
+        fillNoise(in, bs);
+        for (int i = 0; i < bs; ++i)
+            delays[i] = 1000.f + 300.f * in[i];
+
+        r.measure("SSESincDelayLine/per-sample", bs, bs, [&]() {
+            for (int i = 0; i < bs; ++i)
+            {
+                line->write(in[i]);
+                out[i] = line->read(delays[i]);
+            }
+            r.sink = r.sink + out[bs - 1];
+        });
+        r.measure("SSESincDelayLine/block", bs, bs, [&]() {
+            line->writeBlock(in, bs);
+            line->readBlock(delays, out, bs);
+            r.sink = r.sink + out[bs - 1];
+        });
+    });
+}
+
+struct MatrixConfig
+{
+    using SourceIdentifier = int;
+    using TargetIdentifier = int;
+    using CurveIdentifier = int;
+    using RoutingExtraPayload = int;
+
+    static bool isTargetModMatrixDepth(const TargetIdentifier &) { return false; }
+    static size_t getTargetModMatrixElement(const TargetIdentifier &) { return 0; }
+
+    static constexpr bool IsFixedMatrix{true};
+    static constexpr size_t FixedMatrixSize{16};
+};
+
+void benchFixedMatrix(Runner &r)
+{
+    namespace mm = sbb::mod_matrix;
+    static constexpr int nSrc{8}, nTgt{16};
+    float src[nSrc], tgt[nTgt];
+    fillNoise(src, nSrc);
+    fillNoise(tgt, nTgt);
+
+    auto m = std::make_unique<mm::FixedMatrix<MatrixConfig>>();
+    auto rt = std::make_unique<mm::FixedMatrix<MatrixConfig>::RoutingTable>();
+    for (int i = 0; i < nSrc; ++i)
+        m->bindSourceValue(i, src[i]);
+    for (int i = 0; i < nTgt; ++i)
+        m->bindTargetBaseValue(i, tgt[i]);
+    for (int i = 0; i < (int)MatrixConfig::FixedMatrixSize; ++i)
+        rt->updateRoutingAt(i, i % nSrc, (i * 5) % nTgt, 0.1f * (i + 1));
+    m->prepare(*rt);
+
+    // the matrix runs once per block, so its cost per sample falls with block size
+    forBlockSizes<16, 32, 64, 128>([&](auto bsc) {
+        static constexpr int bs = decltype(bsc)::value;
+        r.measure("FixedMatrix/process-16-routes", bs, bs, [&]() {
+            m->process();
+            r.sink = r.sink + m->getTargetValue(3);
+        });
+    });
+}
+
+void benchVoiceGroups(Runner &r)
+{
+    namespace mm = sbb::mod_matrix;
+    static constexpr int nv{16}, nTgt{4};
+    forBlockSizes<16, 32, 64>([&r](auto bsc) {
+        static constexpr int bs = decltype(bsc)::value;
+        using sr_t = SRProvider<bs>;
+        using sched_t = mm::VoiceGroupScheduler<MatrixConfig, sr_t, bs, nv, 2>;
+
+        auto sr = std::make_unique<sr_t>();
+        auto s = std::make_unique<sched_t>(sr.get());
+        auto rt = std::make_unique<typename sched_t::RT>();
+        auto base = std::make_unique<float[][nTgt][4]>(sched_t::numGroups);
+        s->bindEnvelopeSource(0);
+        s->bindLFOSource(0, 1);
+        s->bindLFOSource(1, 2);
+        for (int g = 0; g < sched_t::numGroups; ++g)
+        {
+            auto &gr = s->group(g);
+            for (int t = 0; t < nTgt; ++t)
+            {
+                fillNoise(base[g][t], 4);
+                gr.matrix.bindTargetBaseLanes(t, base[g][t]);
+            }
+            for (int l = 0; l < 4; ++l)
+            {
+                gr.envA[l] = 0.2f;
+                gr.envD[l] = 0.3f;
+                gr.envS[l] = 0.6f;
+                gr.envR[l] = 0.4f;
+                gr.envAShape[l] = gr.envDShape[l] = gr.envRShape[l] = 1;
+            }
+            for (int l = 0; l < sched_t::numLFOLanes; ++l)
+                gr.lfoRate[l] = 1.f + 0.05f * l;
+        }
+        for (int i = 0; i < 6; ++i)
+            rt->updateRoutingAt(i, i % 3, (i * 3) % nTgt, 0.1f * (i + 1));
+        s->prepare(*rt);
+
+        // every voice of every group stays active, so this is the fully loaded cost
+        int blk{0};
+        r.measure("VoiceGroupScheduler/16-voices", bs, bs, [&]() {
+            if (blk % 600 == 0)
+                for (int v = 0; v < nv; ++v)
+                    s->attack(v);
+            s->process();
+            blk++;
+            r.sink = r.sink + s->group(0).matrix.getTargetValue(0, 0);
+        });
+    });
+}
+
+template <typename Env, typename Attack, typename Step>
+void benchEnvelope(Runner &r, const std::string &name, int bs, Attack attack, Step step)
+{
+    using sr_t = std::remove_pointer_t<decltype(std::declval<Env>().srProvider)>;
+    auto sr = std::make_unique<sr_t>();
+    auto env = std::make_unique<Env>(sr.get());
+    int blk{0};
+    /*
+     * Cycle through attack, the held gate and release, restarting every 600 blocks. That
+     * way each run covers every stage instead of timing a finished, quiescent envelope.
+     */
+    r.measure("envelope/" + name, bs, bs, [&]() {
+        if (blk % 600 == 0)
+            attack(*env);
+        step(*env, (blk % 600) < 400);
+        blk++;
+        r.sink = r.sink + env->outBlock0;
+    });
+}
+
+void benchModulators(Runner &r)
+{
+    namespace smod = sbb::modulators;
+    forBlockSizes<16, 32, 64>([&r](auto bsc) {
+        static constexpr int bs = decltype(bsc)::value;
+        using sr_t = SRProvider<bs>;
+
+        benchEnvelope<smod::ADSREnvelope<sr_t, bs>>(
+            r, "ADSREnvelope", bs, [](auto &e) { e.attackFrom(0.f, 0.2f, 1, false); },
+            [](auto &e, bool g) { e.processBlock(0.2f, 0.3f, 0.6f, 0.4f, 1, 1, 1, g); });
+        benchEnvelope<smod::ADSREnvelope<sr_t, bs>>(
+            r, "ADSREnvelope/digital", bs, [](auto &e) { e.attackFrom(0.f, 0.2f, 1, true); },
+            [](auto &e, bool g) { e.processBlock(0.2f, 0.3f, 0.6f, 0.4f, 1, 1, 1, g); });
+        benchEnvelope<smod::AHDSRShapedSC<sr_t, bs>>(
+            r, "AHDSRShapedSC", bs, [](auto &e) { e.attackFrom(0.f); },
+            [](auto &e, bool g) { e.processBlock(0.2f, 0.1f, 0.3f, 0.6f, 0.4f, 0, 0, 0, g); });
+        benchEnvelope<smod::DAHDEnvelope<sr_t, bs>>(
+            r, "DAHDEnvelope", bs, [](auto &e) { e.attackFrom(0.f, 0.2f, 1, false); },
+            [](auto &e, bool g) {
+                for (int i = 0; i < bs; ++i)
+                    e.process(0.2f, 0.3f, 0.6f, 0.4f, 1, 1, 1, g);
+            });
+        benchEnvelope<smod::ADAREnvelope<sr_t, bs>>(
+            r, "ADAREnvelope", bs, [](auto &e) { e.attackFrom(0.f, 1, false, true); },
+            [](auto &e, bool g) {
+                for (int i = 0; i < bs; ++i)
+                    e.processScaledAD(0.2f, 0.4f, 1, 1, g);
+            });
+        benchEnvelope<smod::DAREnvelope<sr_t, bs>>(
+            r, "DAREnvelope", bs, [](auto &e) { e.attack(0.1f); },
+            [](auto &e, bool g) { e.processBlockScaledAD(0.1f, 0.2f, 0.4f, g); });
+        benchEnvelope<smod::DAHDSREnvelope<sr_t, bs>>(
+            r, "DAHDSREnvelope", bs, [](auto &e) { e.attack(0.1f); },
+            [](auto &e, bool g) { e.processBlockScaledAD(0.1f, 0.2f, 0.1f, 0.3f, 0.6f, 0.4f, g); });
+
+        auto sr = std::make_unique<sr_t>();
+        auto lfo = std::make_unique<smod::SimpleLFO<sr_t, bs>>(sr.get(), 8675309);
+        using lfo_t = smod::SimpleLFO<sr_t, bs>;
+        for (auto shape : {lfo_t::SINE, lfo_t::TRI, lfo_t::SMOOTH_NOISE})
+        {
+            lfo->attack(shape);
+            r.measure("SimpleLFO/shape-" + std::to_string((int)shape), bs, bs, [&]() {
+                lfo->process_block(2.f, 0.3f, shape);
+                r.sink = r.sink + lfo->outputBlock[bs - 1];
+            });
+        }
+    });
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Runner r;
+    std::string outFile;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string a = argv[i];
+        if (a == "--filter" && i + 1 < argc)
+            r.filter = argv[++i];
+        else if (a == "--ms" && i + 1 < argc)
+            r.msPerRun = std::atof(argv[++i]);
+        else if (a == "--out" && i + 1 < argc)
+            outFile = argv[++i];
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--filter substring] [--ms per-run-ms]"
+                      << " [--out file.json]\n";
+            return 1;
+        }
+    }
+
+    benchBlockOps(r);
+    benchEndianBlocks(r);
+    benchFastMath(r);
+    benchLanczos(r);
+    benchOversampledClipper(r);
+    benchSincDelay(r);
+    benchFixedMatrix(r);
+    benchVoiceGroups(r);
+    benchModulators(r);
+
+    if (outFile.empty())
+    {
+        r.writeJSON(std::cout);
+    }
+    else
+    {
+        std::ofstream of(outFile);
+        r.writeJSON(of);
+    }
+    return 0;
+}
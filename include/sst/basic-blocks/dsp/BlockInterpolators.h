@@ -28,6 +28,7 @@
 #define INCLUDE_SST_BASIC_BLOCKS_DSP_BLOCKINTERPOLATORS_H
 
 #include <cassert>
+#include "sst/basic-blocks/mechanics/simd-ops.h"
 
 namespace sst::basic_blocks::dsp
 {
@@ -149,6 +150,15 @@ template <int maxBlockSize, bool first_run_checks = true> struct alignas(16) lip
     void multiply_block_to(float *__restrict in, float *__restrict out, int bsQuad = -1) const
     {
         assert(bsQuad == -1 || bsQuad == numRegisters);
+#if SST_BASIC_BLOCKS_AVX
+        if (!(numRegisters & 1))
+        {
+            for (int i = 0; i < numRegisters; i += 2)
+                _mm256_storeu_ps(out + (i << 2),
+                                 _mm256_mul_ps(_mm256_loadu_ps(in + (i << 2)), lineAVX(i)));
+            return;
+        }
+#endif
         for (int i = 0; i < numRegisters; ++i)
         {
             auto iv = _mm_load_ps(in + (i << 2));
@@ -160,6 +170,15 @@ template <int maxBlockSize, bool first_run_checks = true> struct alignas(16) lip
     void multiply_block(float *in, int bsQuad = -1) const
     {
         assert(bsQuad == -1 || bsQuad == numRegisters);
+#if SST_BASIC_BLOCKS_AVX
+        if (!(numRegisters & 1))
+        {
+            for (int i = 0; i < numRegisters; i += 2)
+                _mm256_storeu_ps(in + (i << 2),
+                                 _mm256_mul_ps(_mm256_loadu_ps(in + (i << 2)), lineAVX(i)));
+            return;
+        }
+#endif
         for (int i = 0; i < numRegisters; ++i)
         {
             auto iv = _mm_load_ps(in + (i << 2));
@@ -170,15 +189,130 @@ template <int maxBlockSize, bool first_run_checks = true> struct alignas(16) lip
 
     void multiply_2_blocks(float *__restrict in1, float *__restrict in2, int bsQuad = -1) const
     {
-        multiply_block(in1, bsQuad);
-        multiply_block(in2, bsQuad);
+        assert(bsQuad == -1 || bsQuad == numRegisters);
+        float *bufs[2]{in1, in2};
+        multiply_blocks(bufs, 2);
     }
 
     void multiply_2_blocks_to(float *__restrict inL, float *__restrict inR, float *__restrict outL,
                               float *__restrict outR, int bsQuad = -1) const
     {
-        multiply_block_to(inL, outL, bsQuad);
-        multiply_block_to(inR, outR, bsQuad);
+        assert(bsQuad == -1 || bsQuad == numRegisters);
+        const float *ins[2]{inL, inR};
+        float *outs[2]{outL, outR};
+        multiply_blocks_to(ins, outs, 2);
+    }
+
+    /*
+     * The same fade applied to n buffers, for instance every voice output sharing one
+     * envelope. Registers are the outer loop so each line register is loaded once for all
+     * the buffers.
+     */
+    void multiply_blocks(float *const *bufs, int n) const
+    {
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            auto l = line[i];
+            for (int b = 0; b < n; ++b)
+                _mm_store_ps(bufs[b] + (i << 2), _mm_mul_ps(_mm_load_ps(bufs[b] + (i << 2)), l));
+        }
+    }
+
+    void multiply_blocks_to(const float *const *ins, float *const *outs, int n) const
+    {
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            auto l = line[i];
+            for (int b = 0; b < n; ++b)
+                _mm_store_ps(outs[b] + (i << 2), _mm_mul_ps(_mm_load_ps(ins[b] + (i << 2)), l));
+        }
+    }
+
+    void MAC_blocks_to(const float *const *srcs, float *const *dsts, int n) const
+    {
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            auto l = line[i];
+            for (int b = 0; b < n; ++b)
+            {
+                auto ov = _mm_mul_ps(_mm_load_ps(srcs[b] + (i << 2)), l);
+                _mm_store_ps(dsts[b] + (i << 2), _mm_add_ps(ov, _mm_load_ps(dsts[b] + (i << 2))));
+            }
+        }
+    }
+
+    /*
+     * Interleaved stereo, L0 R0 L1 R1 ..., so 2 * blockSize floats. Each line register is
+     * split into g0 g0 g1 g1 and g2 g2 g3 g3 to cover two stereo registers.
+     */
+    void multiply_block_interleaved_to(const float *__restrict inLR, float *__restrict outLR) const
+    {
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            auto lo = _mm_unpacklo_ps(line[i], line[i]);
+            auto hi = _mm_unpackhi_ps(line[i], line[i]);
+            _mm_store_ps(outLR + (i << 3), _mm_mul_ps(_mm_load_ps(inLR + (i << 3)), lo));
+            _mm_store_ps(outLR + (i << 3) + 4, _mm_mul_ps(_mm_load_ps(inLR + (i << 3) + 4), hi));
+        }
+    }
+
+    void multiply_block_interleaved(float *LR) const
+    {
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            auto lo = _mm_unpacklo_ps(line[i], line[i]);
+            auto hi = _mm_unpackhi_ps(line[i], line[i]);
+            _mm_store_ps(LR + (i << 3), _mm_mul_ps(_mm_load_ps(LR + (i << 3)), lo));
+            _mm_store_ps(LR + (i << 3) + 4, _mm_mul_ps(_mm_load_ps(LR + (i << 3) + 4), hi));
+        }
+    }
+
+    void MAC_block_interleaved_to(const float *__restrict srcLR, float *__restrict dstLR) const
+    {
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            auto lo = _mm_unpacklo_ps(line[i], line[i]);
+            auto hi = _mm_unpackhi_ps(line[i], line[i]);
+            auto d = dstLR + (i << 3);
+            auto s = srcLR + (i << 3);
+            _mm_store_ps(d, _mm_add_ps(_mm_mul_ps(_mm_load_ps(s), lo), _mm_load_ps(d)));
+            _mm_store_ps(d + 4, _mm_add_ps(_mm_mul_ps(_mm_load_ps(s + 4), hi), _mm_load_ps(d + 4)));
+        }
+    }
+
+    /*
+     * Mixer bus form: dst += sum over k of gains[k] * srcs[k], each source with its own
+     * interpolator, summed in registers and stored once. All gains must share a block size.
+     * The sum runs in k order so it matches K calls of MAC_block_to.
+     */
+    static void MAC_mix_to(const lipol_sse *const *gains, const float *const *srcs, int K,
+                           float *__restrict dst)
+    {
+        for (int i = 0; K > 0 && i < gains[0]->numRegisters; ++i)
+        {
+            auto acc = _mm_load_ps(dst + (i << 2));
+            for (int k = 0; k < K; ++k)
+            {
+                assert(gains[k]->numRegisters == gains[0]->numRegisters);
+                acc = _mm_add_ps(_mm_mul_ps(_mm_load_ps(srcs[k] + (i << 2)), gains[k]->line[i]),
+                                 acc);
+            }
+            _mm_store_ps(dst + (i << 2), acc);
+        }
+    }
+
+    // Each of K buffers multiplied by its own interpolator in one pass over the registers
+    static void multiply_each(const lipol_sse *const *gains, float *const *bufs, int K)
+    {
+        for (int i = 0; K > 0 && i < gains[0]->numRegisters; ++i)
+        {
+            for (int k = 0; k < K; ++k)
+            {
+                assert(gains[k]->numRegisters == gains[0]->numRegisters);
+                _mm_store_ps(bufs[k] + (i << 2),
+                             _mm_mul_ps(_mm_load_ps(bufs[k] + (i << 2)), gains[k]->line[i]));
+            }
+        }
     }
 
     /*
@@ -187,6 +321,19 @@ template <int maxBlockSize, bool first_run_checks = true> struct alignas(16) lip
     void MAC_block_to(float *__restrict src, float *__restrict dst, int bsQuad = -1) const
     {
         assert(bsQuad == -1 || bsQuad == numRegisters);
+#if SST_BASIC_BLOCKS_AVX
+        if (!(numRegisters & 1))
+        {
+            // multiply then add rather than fmadd_ps, so results match the SSE path
+            for (int i = 0; i < numRegisters; i += 2)
+            {
+                auto ov = _mm256_mul_ps(_mm256_loadu_ps(src + (i << 2)), lineAVX(i));
+                _mm256_storeu_ps(dst + (i << 2),
+                                 _mm256_add_ps(ov, _mm256_loadu_ps(dst + (i << 2))));
+            }
+            return;
+        }
+#endif
         for (int i = 0; i < numRegisters; ++i)
         {
             auto iv = _mm_load_ps(src + (i << 2));
@@ -199,8 +346,10 @@ template <int maxBlockSize, bool first_run_checks = true> struct alignas(16) lip
     void MAC_2_blocks_to(float *__restrict src1, float *__restrict src2, float *__restrict dst1,
                          float *__restrict dst2, int bsQuad = -1) const
     {
-        MAC_block_to(src1, dst1, bsQuad);
-        MAC_block_to(src2, dst2, bsQuad);
+        assert(bsQuad == -1 || bsQuad == numRegisters);
+        const float *srcs[2]{src1, src2};
+        float *dsts[2]{dst1, dst2};
+        MAC_blocks_to(srcs, dsts, 2);
     }
 
     /*
@@ -301,6 +450,11 @@ template <int maxBlockSize, bool first_run_checks = true> struct alignas(16) lip
     }
 
   private:
+#if SST_BASIC_BLOCKS_AVX
+    // line registers i and i + 1 as one 256 bit value
+    inline __m256 lineAVX(int i) const { return _mm256_loadu_ps((const float *)&line[i]); }
+#endif
+
     void updateLine()
     {
         auto cs = _mm_set1_ps(current);
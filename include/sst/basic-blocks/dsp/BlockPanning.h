@@ -0,0 +1,206 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_DSP_BLOCKPANNING_H
+#define INCLUDE_SST_BASIC_BLOCKS_DSP_BLOCKPANNING_H
+
+#include <cmath>
+#include <cstddef>
+
+#include "PanLaws.h"
+#include "MidSide.h"
+#include "BlockInterpolators.h"
+
+/*
+ * Block kernels for audio rate panning and mid/side, four samples at a time. Each
+ * pan_laws law has an SSE twin here producing the four panmatrix_t entries as registers,
+ * and panBlock applies a law to a stereo block with a pan value per sample, either from a
+ * buffer or ramped by a lipol_sse. The matrix is applied the usual way:
+ *
+ *   L' = L * m[0] + R * m[2]      R' = R * m[1] + L * m[3]
+ *
+ * so a mono source is just L == R == in. The SSE laws evaluate the same polynomial as
+ * pan_laws::sinCos, so a block rendered at a constant pan matches the scalar matrix.
+ * Buffers are 16 byte aligned and blockSize is a multiple of 4. Like the rest of the
+ * SIMD code, include your SSE headers first.
+ */
+namespace sst::basic_blocks::dsp::pan_laws
+{
+typedef __m128 panmatrix_sse_t[4]; // L R RinL LinR, one lane per sample
+
+inline void sinCosSSE(__m128 &destSin, __m128 &destCos, __m128 theta)
+{
+    auto poly = [](__m128 t) {
+        auto t2 = _mm_mul_ps(t, t);
+        auto inner = _mm_add_ps(_mm_set1_ps(-0.166666667f),
+                                _mm_mul_ps(t2, _mm_set1_ps(0.00833333333f)));
+        return _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(t2, t), inner));
+    };
+    destSin = poly(theta);
+    destCos = poly(_mm_sub_ps(_mm_set1_ps(float(M_PI * 0.5)), theta));
+}
+inline void sinCosSqrt2SSE(__m128 &destSin, __m128 &destCos, __m128 theta)
+{
+    sinCosSSE(destSin, destCos, theta);
+    destSin = _mm_mul_ps(destSin, _mm_set1_ps(sqrt2));
+    destCos = _mm_mul_ps(destCos, _mm_set1_ps(sqrt2));
+}
+
+inline void monoLinearSSE(__m128 pan, panmatrix_sse_t &res)
+{
+    res[3] = _mm_mul_ps(pan, _mm_set1_ps(2.f));
+    res[0] = _mm_sub_ps(_mm_set1_ps(2.f), res[3]);
+    res[1] = _mm_setzero_ps();
+    res[2] = _mm_setzero_ps();
+}
+
+inline void monoEqualPowerSSE(__m128 pan, panmatrix_sse_t &res)
+{
+    res[1] = _mm_setzero_ps();
+    res[2] = _mm_setzero_ps();
+    sinCosSqrt2SSE(res[3], res[0], _mm_mul_ps(pan, _mm_set1_ps(float(M_PI * 0.5))));
+}
+
+inline void monoEqualPowerUnityGainAtExtremaSSE(__m128 pan, panmatrix_sse_t &res)
+{
+    res[1] = _mm_setzero_ps();
+    res[2] = _mm_setzero_ps();
+    sinCosSSE(res[3], res[0], _mm_mul_ps(pan, _mm_set1_ps(float(M_PI * 0.5))));
+}
+
+inline void stereoEqualPowerSSE(__m128 pan, panmatrix_sse_t &res)
+{
+    res[2] = _mm_setzero_ps();
+    res[3] = _mm_setzero_ps();
+    __m128 s, c;
+    sinCosSqrt2SSE(s, c, _mm_mul_ps(pan, _mm_set1_ps(float(M_PI_2))));
+
+    // the scalar law returns exactly unity at center
+    auto center = _mm_cmpeq_ps(pan, _mm_set1_ps(0.5f));
+    auto one = _mm_set1_ps(1.f);
+    res[0] = _mm_or_ps(_mm_and_ps(center, one), _mm_andnot_ps(center, c));
+    res[1] = _mm_or_ps(_mm_and_ps(center, one), _mm_andnot_ps(center, s));
+}
+
+inline void stereoTruePanningSSE(__m128 pan, panmatrix_sse_t &res)
+{
+    auto half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.f), zero = _mm_setzero_ps();
+    auto right = _mm_cmpgt_ps(pan, half);
+    auto left = _mm_cmplt_ps(pan, half);
+
+    // pan > 0.5 moves L into R; pan < 0.5 moves R into L; center is the identity
+    __m128 rs, rc, ls, lc;
+    sinCosSSE(rs, rc, _mm_mul_ps(_mm_sub_ps(pan, half), _mm_set1_ps(float(M_PI))));
+    sinCosSSE(ls, lc, _mm_mul_ps(pan, _mm_set1_ps(float(M_PI))));
+
+    auto pick = [](__m128 m, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    };
+    res[0] = pick(right, rc, one);
+    res[1] = pick(left, ls, one);
+    res[2] = pick(left, lc, zero);
+    res[3] = pick(right, rs, zero);
+}
+
+/*
+ * outL/outR = the matrix for pan[i] applied to inL[i]/inR[i]. Law is one of the SSE
+ * laws above; in and out buffers may be the same.
+ */
+template <int blockSize, typename Law>
+inline void panBlock(Law law, const float *pan, const float *inL, const float *inR, float *outL,
+                     float *outR)
+{
+    static_assert(!(blockSize & 3), "Block size must be a multiple of 4");
+    for (int i = 0; i < blockSize; i += 4)
+    {
+        panmatrix_sse_t m;
+        law(_mm_load_ps(pan + i), m);
+        auto l = _mm_load_ps(inL + i);
+        auto r = _mm_load_ps(inR + i);
+        _mm_store_ps(outL + i, _mm_add_ps(_mm_mul_ps(l, m[0]), _mm_mul_ps(r, m[2])));
+        _mm_store_ps(outR + i, _mm_add_ps(_mm_mul_ps(r, m[1]), _mm_mul_ps(l, m[3])));
+    }
+}
+
+// The same with the pan ramped across the block by a lipol_sse
+template <int blockSize, typename Law, int maxBlockSize, bool frc>
+inline void panBlock(Law law, const lipol_sse<maxBlockSize, frc> &pan, const float *inL,
+                     const float *inR, float *outL, float *outR)
+{
+    static_assert(blockSize <= maxBlockSize);
+    float p alignas(16)[blockSize];
+    pan.store_block(p);
+    panBlock<blockSize>(law, p, inL, inR, outL, outR);
+}
+
+template <int blockSize, typename Law>
+inline void panMonoBlock(Law law, const float *pan, const float *in, float *outL, float *outR)
+{
+    panBlock<blockSize>(law, pan, in, in, outL, outR);
+}
+
+template <int blockSize, typename Law, int maxBlockSize, bool frc>
+inline void panMonoBlock(Law law, const lipol_sse<maxBlockSize, frc> &pan, const float *in,
+                         float *outL, float *outR)
+{
+    panBlock<blockSize>(law, pan, in, in, outL, outR);
+}
+} // namespace sst::basic_blocks::dsp::pan_laws
+
+namespace sst::basic_blocks::dsp
+{
+// SSE versions of encodeMS / decodeMS in MidSide.h
+template <size_t blocksize>
+void encodeMSSSE(const float *__restrict L, const float *__restrict R, float *__restrict M,
+                 float *__restrict S)
+{
+    static_assert(!(blocksize & 3), "Block size must be a multiple of 4");
+    auto half = _mm_set1_ps(0.5f);
+    for (auto i = 0U; i < blocksize; i += 4)
+    {
+        auto l = _mm_load_ps(L + i);
+        auto r = _mm_load_ps(R + i);
+        _mm_store_ps(M + i, _mm_mul_ps(half, _mm_add_ps(l, r)));
+        _mm_store_ps(S + i, _mm_mul_ps(half, _mm_sub_ps(l, r)));
+    }
+}
+
+template <size_t blocksize>
+void decodeMSSSE(const float *__restrict M, const float *__restrict S, float *__restrict L,
+                 float *__restrict R)
+{
+    static_assert(!(blocksize & 3), "Block size must be a multiple of 4");
+    for (auto i = 0U; i < blocksize; i += 4)
+    {
+        auto m = _mm_load_ps(M + i);
+        auto s = _mm_load_ps(S + i);
+        _mm_store_ps(L + i, _mm_add_ps(m, s));
+        _mm_store_ps(R + i, _mm_sub_ps(m, s));
+    }
+}
+} // namespace sst::basic_blocks::dsp
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_DSP_BLOCKPANNING_H
@@ -27,6 +27,8 @@
 #ifndef INCLUDE_SST_BASIC_BLOCKS_DSP_CLIPPERS_H
 #define INCLUDE_SST_BASIC_BLOCKS_DSP_CLIPPERS_H
 
+#include "sst/basic-blocks/mechanics/simd-ops.h"
+
 namespace sst::basic_blocks::dsp
 {
 
@@ -94,8 +96,64 @@ inline __m128 tanh7_ps(__m128 v)
     return _mm_mul_ps(y, x);
 }
 
+#if SST_BASIC_BLOCKS_AVX
+/*
+ * Eight wide softclip_ps and tanh7_ps. The block functions below switch to these when the
+ * target has AVX and the block is a whole number of eight floats.
+ */
+inline __m256 softclip_avx(__m256 in)
+{
+    auto x = _mm256_max_ps(_mm256_min_ps(in, _mm256_set1_ps(1.5f)), _mm256_set1_ps(-1.5f));
+    auto xx = _mm256_mul_ps(x, x);
+    auto t = _mm256_mul_ps(x, _mm256_set1_ps(-4.f / 27.f));
+    return mechanics::fmadd_ps(t, xx, x);
+}
+
+inline __m256 tanh7_avx(__m256 v)
+{
+    auto x = _mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(-1.139f)), _mm256_set1_ps(1.139f));
+
+    auto xx = _mm256_mul_ps(x, x);
+    auto y = mechanics::fmadd_ps(_mm256_set1_ps(-17.f / 315.f), xx, _mm256_set1_ps(2.f / 15.f));
+    y = mechanics::fmadd_ps(y, xx, _mm256_set1_ps(-1.f / 3.f));
+    y = mechanics::fmadd_ps(y, xx, _mm256_set1_ps(1.f));
+    return _mm256_mul_ps(y, x);
+}
+#endif
+
+/*
+ * softclip_ps and tanh7_ps as shapers for a mechanics::fuse chain, for instance
+ *   fuse<blockSize>(in).mul(env).shape(dsp::softclip_shaper{}).accumulate_to(out);
+ * They take whichever register width the chain runs at, and single floats for the tail.
+ */
+struct softclip_shaper
+{
+    __m128 operator()(__m128 x) const { return softclip_ps(x); }
+#if SST_BASIC_BLOCKS_AVX
+    __m256 operator()(__m256 x) const { return softclip_avx(x); }
+#endif
+    float operator()(float x) const { return _mm_cvtss_f32(softclip_ps(_mm_set_ss(x))); }
+};
+
+struct tanh7_shaper
+{
+    __m128 operator()(__m128 x) const { return tanh7_ps(x); }
+#if SST_BASIC_BLOCKS_AVX
+    __m256 operator()(__m256 x) const { return tanh7_avx(x); }
+#endif
+    float operator()(float x) const { return _mm_cvtss_f32(tanh7_ps(_mm_set_ss(x))); }
+};
+
 template <size_t blockSize> void softclip_block(float *__restrict x)
 {
+#if SST_BASIC_BLOCKS_AVX
+    if constexpr (blockSize % 8 == 0)
+    {
+        for (unsigned int i = 0; i < blockSize; i += 8)
+            _mm256_storeu_ps(x + i, softclip_avx(_mm256_loadu_ps(x + i)));
+        return;
+    }
+#endif
     for (unsigned int i = 0; i < blockSize; i += 4)
     {
         _mm_store_ps(x + i, softclip_ps(_mm_load_ps(x + i)));
@@ -104,6 +162,14 @@ template <size_t blockSize> void softclip_block(float *__restrict x)
 
 template <size_t blockSize> void tanh7_block(float *__restrict x)
 {
+#if SST_BASIC_BLOCKS_AVX
+    if constexpr (blockSize % 8 == 0)
+    {
+        for (unsigned int i = 0; i < blockSize; i += 8)
+            _mm256_storeu_ps(x + i, tanh7_avx(_mm256_loadu_ps(x + i)));
+        return;
+    }
+#endif
     for (unsigned int i = 0; i < blockSize; i += 4)
     {
         _mm_store_ps(x + i, tanh7_ps(_mm_load_ps(x + i)));
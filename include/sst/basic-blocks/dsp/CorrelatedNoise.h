@@ -27,6 +27,7 @@
 #ifndef INCLUDE_SST_BASIC_BLOCKS_DSP_CORRELATEDNOISE_H
 #define INCLUDE_SST_BASIC_BLOCKS_DSP_CORRELATEDNOISE_H
 
+#include <cstdint>
 #include <functional>
 #include <cmath>
 
@@ -63,5 +64,131 @@ inline float correlated_noise_o2mk2_suppliedrng(float &lastval, float &lastval2,
 {
     return correlated_noise_o2mk2_supplied_value(lastval, lastval2, correlation, urng());
 }
+
+/*
+ * Fill n samples with the same recurrence as correlated_noise_o2mk2_supplied_value. The
+ * correlation coefficients are worked out once for the block and the rng is any callable
+ * returning a bipolar uniform float, taken by template so there is no std::function call per
+ * sample.
+ */
+template <typename URNG>
+inline void correlated_noise_o2mk2_block(float &lastval, float &lastval2, float correlation,
+                                         URNG &&urng, float *out, int n)
+{
+    float wfabs = fabs(correlation) * 0.8f;
+    wfabs = (2.f * wfabs - wfabs * wfabs);
+    float wf = correlation > 0.f ? wfabs : -wfabs;
+    float m = 1.f - wfabs;
+    _mm_store_ss(&m, _mm_rsqrt_ss(_mm_load_ss(&m)));
+    const float omw = 1 - wfabs;
+
+    auto l1 = lastval, l2 = lastval2;
+    for (int i = 0; i < n; ++i)
+    {
+        float rand11 = urng();
+        l2 = rand11 * omw - wf * l2;
+        l1 = l2 * omw - wf * l1;
+        out[i] = l1 * m;
+    }
+    lastval = l1;
+    lastval2 = l2;
+}
+
+/*
+ * Four independent xorshift32 streams, one per SSE lane. Each lane is Marsaglia's 13/17/5
+ * xorshift, so a lane can be checked against the scalar recurrence, and the lanes are seeded
+ * through a splitmix style hash so nearby seeds give unrelated streams.
+ */
+struct XorShift32x4
+{
+    __m128i state;
+
+    XorShift32x4(uint32_t seed = 2112) { reseed(seed); }
+
+    void reseed(uint32_t seed)
+    {
+        uint32_t s alignas(16)[4];
+        for (int l = 0; l < 4; ++l)
+        {
+            uint32_t z = seed + 0x9E3779B9u * (l + 1);
+            z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+            z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+            z ^= z >> 16;
+            s[l] = z ? z : 0x6D2B79F5u; // xorshift must not start at zero
+        }
+        state = _mm_load_si128((const __m128i *)s);
+    }
+
+    inline __m128i nextBits()
+    {
+        auto x = state;
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+        state = x;
+        return x;
+    }
+
+    // uniform in [-1, 1): the top 23 bits as the mantissa of a float in [1, 2), then 2x - 3
+    inline __m128 nextBipolar()
+    {
+        auto bits = _mm_or_si128(_mm_srli_epi32(nextBits(), 9), _mm_set1_epi32(0x3F800000));
+        auto f = _mm_castsi128_ps(bits);
+        return _mm_sub_ps(_mm_add_ps(f, f), _mm_set1_ps(3.f));
+    }
+};
+
+/*
+ * Four lanes of o2mk2 correlated noise, each with its own correlation and state, fed from an
+ * XorShift32x4, for independent per voice noise streams. Lane l gives the same values as
+ * correlated_noise_o2mk2_supplied_value on lane l of the rng's nextBipolar.
+ */
+struct CorrelatedNoiseQuad
+{
+    __m128 lastval, lastval2;
+    __m128 wf, omw, m; // the coefficients of the last setCorrelation
+    XorShift32x4 rng;
+
+    CorrelatedNoiseQuad(uint32_t seed = 2112) : rng(seed)
+    {
+        lastval = _mm_setzero_ps();
+        lastval2 = _mm_setzero_ps();
+        setCorrelation(_mm_setzero_ps());
+    }
+
+    void setCorrelation(float c) { setCorrelation(_mm_set1_ps(c)); }
+    void setCorrelation(__m128 c)
+    {
+        const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        auto wfabs = _mm_mul_ps(_mm_and_ps(c, absMask), _mm_set1_ps(0.8f));
+        wfabs = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.f), wfabs), _mm_mul_ps(wfabs, wfabs));
+        auto pos = _mm_cmpgt_ps(c, _mm_setzero_ps());
+        auto neg = _mm_sub_ps(_mm_setzero_ps(), wfabs);
+        wf = _mm_or_ps(_mm_and_ps(pos, wfabs), _mm_andnot_ps(pos, neg));
+        omw = _mm_sub_ps(_mm_set1_ps(1.f), wfabs);
+        m = _mm_rsqrt_ps(omw);
+    }
+
+    inline __m128 step()
+    {
+        auto r = rng.nextBipolar();
+        lastval2 = _mm_sub_ps(_mm_mul_ps(r, omw), _mm_mul_ps(wf, lastval2));
+        lastval = _mm_sub_ps(_mm_mul_ps(lastval2, omw), _mm_mul_ps(wf, lastval));
+        return _mm_mul_ps(lastval, m);
+    }
+
+    // out[lane][sample]
+    template <int blockSize> void processBlock(float out[4][blockSize])
+    {
+        static_assert(blockSize % 4 == 0);
+        for (int s = 0; s < blockSize; s += 4)
+        {
+            __m128 o[4] = {step(), step(), step(), step()};
+            _MM_TRANSPOSE4_PS(o[0], o[1], o[2], o[3]);
+            for (int l = 0; l < 4; ++l)
+                _mm_storeu_ps(out[l] + s, o[l]);
+        }
+    }
+};
 } // namespace sst::basic_blocks::dsp
 #endif // SURGEXTRACK_CORRELATEDNOISE_H
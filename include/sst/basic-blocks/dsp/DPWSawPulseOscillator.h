@@ -177,6 +177,239 @@ template <typename SmoothingStrategy = LagSmoothingStrategy> struct DPWPulseOsci
     typename SmoothingStrategy::smoothValue_t dPhase;
     typename SmoothingStrategy::smoothValue_t pulseWidth;
 };
+namespace detail
+{
+/*
+ * The register operations the oscillator bank needs, for float (four lanes in an __m128)
+ * and double (two lanes in an __m128d) phase.
+ */
+template <typename T> struct dpw_simd;
+
+template <> struct dpw_simd<float>
+{
+    using reg_t = __m128;
+    static constexpr int width{4};
+    static reg_t set1(float f) { return _mm_set1_ps(f); }
+    static reg_t load(const float *p) { return _mm_load_ps(p); }
+    static void store(float *p, reg_t v) { _mm_store_ps(p, v); }
+    static reg_t add(reg_t a, reg_t b) { return _mm_add_ps(a, b); }
+    static reg_t sub(reg_t a, reg_t b) { return _mm_sub_ps(a, b); }
+    static reg_t mul(reg_t a, reg_t b) { return _mm_mul_ps(a, b); }
+    static reg_t div(reg_t a, reg_t b) { return _mm_div_ps(a, b); }
+    static reg_t lt(reg_t a, reg_t b) { return _mm_cmplt_ps(a, b); }
+    static reg_t gt(reg_t a, reg_t b) { return _mm_cmpgt_ps(a, b); }
+    static reg_t or_(reg_t a, reg_t b) { return _mm_or_ps(a, b); }
+    static reg_t and_(reg_t a, reg_t b) { return _mm_and_ps(a, b); }
+    static reg_t select(reg_t m, reg_t a, reg_t b)
+    {
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+    // x - floor(x) for the small |x| a phase takes
+    static reg_t frac(reg_t x)
+    {
+        auto t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        t = _mm_sub_ps(t, _mm_and_ps(_mm_cmplt_ps(x, t), _mm_set1_ps(1.f)));
+        return _mm_sub_ps(x, t);
+    }
+};
+
+template <> struct dpw_simd<double>
+{
+    using reg_t = __m128d;
+    static constexpr int width{2};
+    static reg_t set1(double f) { return _mm_set1_pd(f); }
+    static reg_t load(const double *p) { return _mm_load_pd(p); }
+    static void store(double *p, reg_t v) { _mm_store_pd(p, v); }
+    static reg_t add(reg_t a, reg_t b) { return _mm_add_pd(a, b); }
+    static reg_t sub(reg_t a, reg_t b) { return _mm_sub_pd(a, b); }
+    static reg_t mul(reg_t a, reg_t b) { return _mm_mul_pd(a, b); }
+    static reg_t div(reg_t a, reg_t b) { return _mm_div_pd(a, b); }
+    static reg_t lt(reg_t a, reg_t b) { return _mm_cmplt_pd(a, b); }
+    static reg_t gt(reg_t a, reg_t b) { return _mm_cmpgt_pd(a, b); }
+    static reg_t or_(reg_t a, reg_t b) { return _mm_or_pd(a, b); }
+    static reg_t and_(reg_t a, reg_t b) { return _mm_and_pd(a, b); }
+    static reg_t select(reg_t m, reg_t a, reg_t b)
+    {
+        return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+    }
+    static reg_t frac(reg_t x)
+    {
+        auto t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(x));
+        t = _mm_sub_pd(t, _mm_and_pd(_mm_cmplt_pd(x, t), _mm_set1_pd(1.0)));
+        return _mm_sub_pd(x, t);
+    }
+};
+} // namespace detail
+
+/*
+ * N DPW saws (or pulses) run a register of lanes at a time, for unison stacks. Each lane is
+ * the DPWSawOscillator / DPWPulseOscillator math with BlockInterpSmoothingStrategy style
+ * smoothing: calling setFrequency (and setPulseWidth) once per block ramps the value
+ * linearly across the next block, exactly as lipol does.
+ *
+ * phase_t picks the precision. double runs two lanes per register and matches the scalar
+ * oscillators; float runs four and is plenty above a couple of hundred Hz, but the
+ * differentiated cubic loses precision as the phase increment gets small, so prefer double
+ * for low notes and LFO rates.
+ */
+template <int N, int blockSize, typename phase_t = float, bool isPulse = false>
+struct DPWOscillatorBank
+{
+    using simd = detail::dpw_simd<phase_t>;
+    static constexpr int lanes{simd::width};
+    static_assert(N % lanes == 0, "N must be a multiple of the lanes per register");
+    static_assert(blockSize > 0);
+
+    phase_t phase alignas(16)[N]{};
+    phase_t dPhase alignas(16)[N]{}, dPhaseTarget alignas(16)[N]{}, ddPhase alignas(16)[N]{};
+    phase_t pulseWidth alignas(16)[N]{}, pulseWidthTarget alignas(16)[N]{},
+        dPulseWidth alignas(16)[N]{};
+    bool firstRun[N], pulseWidthFirstRun[N];
+
+    DPWOscillatorBank()
+    {
+        for (int l = 0; l < N; ++l)
+        {
+            firstRun[l] = true;
+            pulseWidthFirstRun[l] = false;
+            pulseWidth[l] = pulseWidthTarget[l] = 0.5;
+        }
+    }
+
+    void retrigger(int lane, phase_t startPhase = 0)
+    {
+        phase[lane] = startPhase;
+        firstRun[lane] = true;
+        pulseWidthFirstRun[lane] = true;
+    }
+
+    void setFrequency(int lane, double freqInHz, double sampleRateInv)
+    {
+        // the scalar strategies take their target as a float too
+        newValue(dPhase[lane], dPhaseTarget[lane], ddPhase[lane], firstRun[lane],
+                 (float)(freqInHz * sampleRateInv));
+    }
+
+    void setPulseWidth(int lane, double pw)
+    {
+        static_assert(isPulse);
+        newValue(pulseWidth[lane], pulseWidthTarget[lane], dPulseWidth[lane],
+                 pulseWidthFirstRun[lane], (float)pw);
+    }
+
+    // out[lane][sample]
+    void processBlock(float out[N][blockSize])
+    {
+        for (int g = 0; g < N; g += lanes)
+        {
+            float *o[lanes];
+            for (int l = 0; l < lanes; ++l)
+                o[l] = out[g + l];
+            processGroup(g, o);
+        }
+    }
+
+    /*
+     * The summed unison output: out[s] = sum over lanes of gains[lane] * oscillator[lane][s],
+     * or the plain sum with no gains. out is overwritten.
+     */
+    void processBlockSummed(float *out, const float *gains = nullptr)
+    {
+        float tmp alignas(16)[lanes][blockSize];
+        for (int s = 0; s < blockSize; ++s)
+            out[s] = 0.f;
+        for (int g = 0; g < N; g += lanes)
+        {
+            float *o[lanes];
+            for (int l = 0; l < lanes; ++l)
+                o[l] = tmp[l];
+            processGroup(g, o);
+            for (int l = 0; l < lanes; ++l)
+            {
+                auto gn = gains ? gains[g + l] : 1.f;
+                for (int s = 0; s < blockSize; ++s)
+                    out[s] += gn * tmp[l][s];
+            }
+        }
+    }
+
+  private:
+    static void newValue(phase_t &v, phase_t &target, phase_t &dv, bool &first, phase_t f)
+    {
+        v = target;
+        target = f;
+        if (first)
+        {
+            v = f;
+            first = false;
+        }
+        dv = (target - v) * (phase_t)(1.0 / blockSize);
+    }
+
+    static typename simd::reg_t valueAt(typename simd::reg_t p, typename simd::reg_t dp)
+    {
+        using S = simd;
+        const auto one = S::set1(1), two = S::set1(2), three = S::set1(3);
+        auto res = S::sub(S::mul(p, two), one);
+
+        auto threeDp = S::mul(three, dp);
+        auto near = S::or_(S::lt(p, threeDp), S::gt(p, S::sub(one, threeDp)));
+
+        typename S::reg_t steps[3];
+        for (int q = -1; q <= 1; ++q)
+        {
+            auto ph = S::frac(S::sub(p, S::mul(S::set1(q), dp)));
+            ph = S::sub(S::mul(ph, two), one);
+            steps[q + 1] = S::div(S::mul(S::sub(S::mul(ph, ph), one), ph), S::set1(6));
+        }
+        auto num = S::sub(S::add(steps[0], steps[2]), S::mul(two, steps[1]));
+        auto resNear = S::div(num, S::mul(S::mul(S::set1(4), dp), dp));
+
+        return S::select(near, resNear, res);
+    }
+
+    void processGroup(int g, float *const *out)
+    {
+        using S = simd;
+        const auto one = S::set1(1);
+        auto p = S::load(phase + g);
+        auto dp = S::load(dPhase + g);
+        auto ddp = S::load(ddPhase + g);
+        auto pw = S::load(pulseWidth + g);
+        auto dpw = S::load(dPulseWidth + g);
+
+        phase_t r alignas(16)[lanes];
+        for (int s = 0; s < blockSize; ++s)
+        {
+            auto v = valueAt(p, dp);
+            if constexpr (isPulse)
+            {
+                auto np = S::add(p, pw);
+                np = S::sub(np, S::and_(S::gt(np, one), one));
+                v = S::sub(v, valueAt(np, dp));
+                pw = S::add(pw, dpw);
+            }
+            S::store(r, v);
+            for (int l = 0; l < lanes; ++l)
+                out[l][s] = (float)r[l];
+
+            p = S::add(p, dp);
+            p = S::sub(p, S::and_(S::gt(p, one), one));
+            dp = S::add(dp, ddp);
+        }
+
+        S::store(phase + g, p);
+        S::store(dPhase + g, dp);
+        if constexpr (isPulse)
+            S::store(pulseWidth + g, pw);
+    }
+};
+
+template <int N, int blockSize, typename phase_t = float>
+using DPWSawOscillatorBank = DPWOscillatorBank<N, blockSize, phase_t, false>;
+
+template <int N, int blockSize, typename phase_t = float>
+using DPWPulseOscillatorBank = DPWOscillatorBank<N, blockSize, phase_t, true>;
 } // namespace sst::basic_blocks::dsp
 
 #endif // INCLUDE_SST_BASIC_BLOCKS_DSP_DPWSAWPULSEOSCILLATOR_H
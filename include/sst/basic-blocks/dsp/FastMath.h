@@ -27,7 +27,11 @@
 #ifndef INCLUDE_SST_BASIC_BLOCKS_DSP_FASTMATH_H
 #define INCLUDE_SST_BASIC_BLOCKS_DSP_FASTMATH_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "sst/basic-blocks/mechanics/simd-ops.h"
 
 /*
 ** Fast Math Approximations to various Functions
@@ -246,5 +250,350 @@ inline __m128 fastexpSSE(__m128 x) noexcept
 #undef F
 }
 
+/*
+ * Polynomial approximations with a selectable order, so a call site can trade accuracy for
+ * speed: fastsinPoly<7>(x), fastpow2SSE<4>(x) and so on. The coefficients are minimax fits and
+ * each order lists its maximum error as measured in float over the valid range. The sin and
+ * cos family is named fastsinPoly rather than overloading fastsin so that &fastsinSSE and
+ * friends still name a single function.
+ *
+ * fastsinPoly / fastcosPoly <Order>, valid -PI to PI, absolute error
+ *     3: 4.5e-3   5: 6.8e-5   7: 7.2e-7   9: 1.5e-7 (float rounding bound)
+ * fastpow2 <Order>, 2^x for x in -126 to 127, relative error
+ *     2: 1.7e-3   3: 7.5e-5   4: 2.7e-6   5: 1.6e-7   6: 9.2e-8
+ * fastlog2 <Order>, positive normal floats, absolute error for x in 1/4 to 4 (beyond that
+ * the float spacing of the result dominates)
+ *     3: 5.7e-6   5: 2.0e-7   7: 1.4e-7
+ * fastatan <Order>, any x, absolute error
+ *     5: 6.1e-4   7: 8.1e-5   9: 1.2e-5  11: 1.8e-6  13: 3.7e-7
+ *
+ * The scalar and SSE version of each evaluate the same polynomial in the same order.
+ */
+namespace detail
+{
+template <int Order> struct sin_poly
+{
+    static_assert(Order == -1, "fastsinPoly and fastcosPoly support orders 3, 5, 7 and 9");
+};
+template <> struct sin_poly<3>
+{
+    static constexpr float c[]{0.985529543f, -0.142566727f};
+};
+template <> struct sin_poly<5>
+{
+    static constexpr float c[]{0.999696773f, -0.165673079f, 0.00751437718f};
+};
+template <> struct sin_poly<7>
+{
+    static constexpr float c[]{0.999996616f, -0.166648284f, 0.00830632523f, -0.000183636540f};
+};
+template <> struct sin_poly<9>
+{
+    static constexpr float c[]{0.999999999f, -0.166666625f, 0.00833313078f, -0.000198134239f,
+                               2.61253804e-06f};
+};
+
+template <int Order> struct pow2_poly
+{
+    static_assert(Order == -1, "fastpow2 supports orders 2 through 6");
+};
+template <> struct pow2_poly<2>
+{
+    static constexpr float c[]{1.00172476f, 0.657636276f, 0.337189435f};
+};
+template <> struct pow2_poly<3>
+{
+    static constexpr float c[]{0.999925219f, 0.695833541f, 0.226067155f, 0.0780245227f};
+};
+template <> struct pow2_poly<4>
+{
+    static constexpr float c[]{1.00000259f, 0.693003834f, 0.241442757f, 0.0520114606f,
+                               0.0135341679f};
+};
+template <> struct pow2_poly<5>
+{
+    static constexpr float c[]{0.999999925f, 0.693153073f, 0.240153617f, 0.0558263181f,
+                               0.00898934009f, 0.00187757667f};
+};
+template <> struct pow2_poly<6>
+{
+    static constexpr float c[]{1.00000000f,     0.693146984f,   0.240229836f,   0.0554833420f,
+                               0.00967884100f, 0.00124396878f, 0.000217022555f};
+};
+
+// log2(m) = s * P(s^2) with s = (m - 1) / (m + 1) and m in sqrt(1/2), sqrt(2)
+template <int Order> struct log2_poly
+{
+    static_assert(Order == -1, "fastlog2 supports orders 3, 5 and 7");
+};
+template <> struct log2_poly<3>
+{
+    static constexpr float c[]{2.88522857f, 0.983534509f};
+};
+template <> struct log2_poly<5>
+{
+    static constexpr float c[]{2.88539047f, 0.961552153f, 0.597360944f};
+};
+template <> struct log2_poly<7>
+{
+    static constexpr float c[]{2.88539007f, 0.961800759f, 0.576584541f, 0.434255943f};
+};
+
+// atan(t) = t * P(t^2) for t in 0, 1
+template <int Order> struct atan_poly
+{
+    static_assert(Order == -1, "fastatan supports orders 5, 7, 9, 11 and 13");
+};
+template <> struct atan_poly<5>
+{
+    static constexpr float c[]{0.995357955f, -0.288690238f, 0.0793390414f};
+};
+template <> struct atan_poly<7>
+{
+    static constexpr float c[]{0.999213813f, -0.321174969f, 0.146264464f, -0.0389865142f};
+};
+template <> struct atan_poly<9>
+{
+    static constexpr float c[]{0.999866329f, -0.330304786f, 0.180159295f, -0.0851563509f,
+                               0.0208451142f};
+};
+template <> struct atan_poly<11>
+{
+    static constexpr float c[]{0.999977219f,  -0.332622828f, 0.193540376f,
+                               -0.116426482f, 0.0526473515f, -0.0117191357f};
+};
+template <> struct atan_poly<13>
+{
+    static constexpr float c[]{0.999996112f, -0.333173681f, 0.198078156f,  -0.132333421f,
+                               0.0796236724f, -0.0336042206f, 0.00681179329f};
+};
+
+template <size_t N> inline float horner(const float (&c)[N], float x) noexcept
+{
+    float r = c[N - 1];
+    for (int i = (int)N - 2; i >= 0; --i)
+        r = r * x + c[i];
+    return r;
+}
+
+template <size_t N> inline __m128 horner(const float (&c)[N], __m128 x) noexcept
+{
+    auto r = _mm_set1_ps(c[N - 1]);
+    for (int i = (int)N - 2; i >= 0; --i)
+        r = _mm_add_ps(_mm_mul_ps(r, x), _mm_set1_ps(c[i]));
+    return r;
+}
+} // namespace detail
+
+// x in -PI, PI; the odd polynomial is fit on -PI/2, PI/2 and the rest folds onto it
+template <int Order> inline float fastsinPoly(float x) noexcept
+{
+    constexpr float hpi = M_PI_2, pi = M_PI;
+    x = x > hpi ? pi - x : (x < -hpi ? -pi - x : x);
+    return x * detail::horner(detail::sin_poly<Order>::c, x * x);
+}
+
+template <int Order> inline __m128 fastsinPolySSE(__m128 x) noexcept
+{
+    const auto hpi = _mm_set1_ps(M_PI_2), pi = _mm_set1_ps(M_PI), npi = _mm_set1_ps(-M_PI);
+    auto hi = _mm_cmpgt_ps(x, hpi);
+    auto lo = _mm_cmplt_ps(x, _mm_sub_ps(_mm_setzero_ps(), hpi));
+    auto folded = _mm_or_ps(_mm_and_ps(hi, _mm_sub_ps(pi, x)), _mm_and_ps(lo, _mm_sub_ps(npi, x)));
+    x = _mm_or_ps(folded, _mm_andnot_ps(_mm_or_ps(hi, lo), x));
+    return _mm_mul_ps(x, detail::horner(detail::sin_poly<Order>::c, _mm_mul_ps(x, x)));
+}
+
+// cos(x) = sin(PI/2 - |x|), which is already in the polynomial's range for x in -PI, PI
+template <int Order> inline float fastcosPoly(float x) noexcept
+{
+    constexpr float hpi = M_PI_2;
+    x = hpi - std::fabs(x);
+    return x * detail::horner(detail::sin_poly<Order>::c, x * x);
+}
+
+template <int Order> inline __m128 fastcosPolySSE(__m128 x) noexcept
+{
+    const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    x = _mm_sub_ps(_mm_set1_ps(M_PI_2), _mm_and_ps(x, absMask));
+    return _mm_mul_ps(x, detail::horner(detail::sin_poly<Order>::c, _mm_mul_ps(x, x)));
+}
+
+/*
+ * 2^x from the exponent bits and a polynomial on the fractional part. x is clamped to
+ * -126, 127 so the result stays a normal float.
+ */
+template <int Order = 5> inline float fastpow2(float x) noexcept
+{
+    x = std::clamp(x, -126.f, 127.f);
+    auto xi = (int)x;
+    xi -= (x < (float)xi);
+    auto f = x - (float)xi;
+    auto p = detail::horner(detail::pow2_poly<Order>::c, f);
+    int32_t bits{(xi + 127) << 23};
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+template <int Order = 5> inline __m128 fastpow2SSE(__m128 x) noexcept
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.f)), _mm_set1_ps(127.f));
+    auto xi = _mm_cvttps_epi32(x);
+    // truncation rounds negative values up; step those down one to get the floor
+    xi = _mm_add_epi32(xi, _mm_castps_si128(_mm_cmplt_ps(x, _mm_cvtepi32_ps(xi))));
+    auto f = _mm_sub_ps(x, _mm_cvtepi32_ps(xi));
+    auto p = detail::horner(detail::pow2_poly<Order>::c, f);
+    auto scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(xi, _mm_set1_epi32(127)), 23));
+    return _mm_mul_ps(p, scale);
+}
+
+/*
+ * log2 of a positive normal float: the exponent bits plus a polynomial in
+ * s = (m - 1) / (m + 1) of the mantissa m, taken in sqrt(1/2), sqrt(2). Zero, negative and
+ * denormal inputs give meaningless results.
+ */
+template <int Order = 5> inline float fastlog2(float x) noexcept
+{
+    int32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    auto e = ((bits >> 23) & 0xFF) - 127;
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    if (m > (float)M_SQRT2)
+    {
+        m *= 0.5f;
+        e++;
+    }
+    auto s = (m - 1.f) / (m + 1.f);
+    return (float)e + s * detail::horner(detail::log2_poly<Order>::c, s * s);
+}
+
+template <int Order = 5> inline __m128 fastlog2SSE(__m128 x) noexcept
+{
+    auto bits = _mm_castps_si128(x);
+    auto e = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xFF)),
+                           _mm_set1_epi32(127));
+    auto m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)),
+                                           _mm_set1_epi32(0x3F800000)));
+    auto big = _mm_cmpgt_ps(m, _mm_set1_ps((float)M_SQRT2));
+    m = _mm_or_ps(_mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(big, m));
+    // the all ones mask is -1, so subtracting it steps the exponent up
+    e = _mm_sub_epi32(e, _mm_castps_si128(big));
+
+    const auto one = _mm_set1_ps(1.f);
+    auto s = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+    auto p = detail::horner(detail::log2_poly<Order>::c, _mm_mul_ps(s, s));
+    return _mm_add_ps(_mm_cvtepi32_ps(e), _mm_mul_ps(s, p));
+}
+
+// atan for any x, using atan(x) = sign(x) * PI/2 - atan(1/x) when |x| > 1
+template <int Order = 9> inline float fastatan(float x) noexcept
+{
+    constexpr float hpi = M_PI_2;
+    auto ax = std::fabs(x);
+    auto big = ax > 1.f;
+    auto t = big ? 1.f / ax : ax;
+    auto r = t * detail::horner(detail::atan_poly<Order>::c, t * t);
+    r = big ? hpi - r : r;
+    return std::copysign(r, x);
+}
+
+template <int Order = 9> inline __m128 fastatanSSE(__m128 x) noexcept
+{
+    const auto signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const auto one = _mm_set1_ps(1.f);
+    auto ax = _mm_andnot_ps(signMask, x);
+    auto big = _mm_cmpgt_ps(ax, one);
+    auto t = _mm_or_ps(_mm_and_ps(big, _mm_div_ps(one, ax)), _mm_andnot_ps(big, ax));
+    auto r = _mm_mul_ps(t, detail::horner(detail::atan_poly<Order>::c, _mm_mul_ps(t, t)));
+    r = _mm_or_ps(_mm_and_ps(big, _mm_sub_ps(_mm_set1_ps(M_PI_2), r)), _mm_andnot_ps(big, r));
+    return _mm_or_ps(r, _mm_and_ps(signMask, x));
+}
+
+#if SST_BASIC_BLOCKS_AVX
+/*
+ * Eight wide versions of the SSE approximations above, for builds targeting AVX. The
+ * polynomials are evaluated in Horner form through fmadd_ps so they fuse when FMA is there.
+ */
+#define F(a) _mm256_set1_ps((float)(a))
+#define MA(a, b, c) sst::basic_blocks::mechanics::fmadd_ps(a, b, c)
+
+inline __m256 fastsinAVX(__m256 x) noexcept
+{
+    auto x2 = _mm256_mul_ps(x, x);
+    auto num = MA(x2, F(479249), F(-52785432));
+    num = MA(x2, num, F(1640635920));
+    num = MA(x2, num, F(-11511339840.0));
+    num = _mm256_mul_ps(_mm256_sub_ps(_mm256_setzero_ps(), x), num);
+    auto den = MA(x2, F(18361), F(3177720));
+    den = MA(x2, den, F(277920720));
+    den = MA(x2, den, F(11511339840.0));
+    return _mm256_div_ps(num, den);
+}
+
+inline __m256 fastcosAVX(__m256 x) noexcept
+{
+    auto x2 = _mm256_mul_ps(x, x);
+    auto num = MA(x2, F(-14615), F(1075032));
+    num = MA(x2, num, F(-18471600));
+    num = MA(x2, num, F(39251520));
+    auto den = MA(x2, F(127), F(16632));
+    den = MA(x2, den, F(1154160));
+    den = MA(x2, den, F(39251520));
+    return _mm256_div_ps(num, den);
+}
+
+inline __m256 clampToPiRangeAVX(__m256 x)
+{
+    const auto mpi = F(M_PI);
+    const auto m2pi = F(2.0 * M_PI);
+
+    auto y = _mm256_add_ps(x, mpi);
+    auto yip = _mm256_round_ps(_mm256_mul_ps(y, F(1.0 / (2.0 * M_PI))),
+                               _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    auto p = _mm256_sub_ps(y, _mm256_mul_ps(m2pi, yip));
+    auto off = _mm256_and_ps(_mm256_cmp_ps(p, _mm256_setzero_ps(), _CMP_LT_OQ), m2pi);
+    p = _mm256_add_ps(p, off);
+
+    return _mm256_sub_ps(p, mpi);
+}
+
+inline __m256 fasttanhAVX(__m256 x)
+{
+    auto x2 = _mm256_mul_ps(x, x);
+    auto num = _mm256_add_ps(F(378), x2);
+    num = MA(x2, num, F(17325));
+    num = MA(x2, num, F(135135));
+    num = _mm256_mul_ps(x, num);
+    auto den = MA(x2, F(28), F(3150));
+    den = MA(x2, den, F(62370));
+    den = MA(x2, den, F(135135));
+    return _mm256_div_ps(num, den);
+}
+
+inline __m256 fasttanhAVXclamped(__m256 x)
+{
+    auto xc = _mm256_min_ps(F(5), _mm256_max_ps(F(-5), x));
+    return fasttanhAVX(xc);
+}
+
+inline __m256 fastexpAVX(__m256 x) noexcept
+{
+    auto num = _mm256_add_ps(F(20), x);
+    num = MA(x, num, F(180));
+    num = MA(x, num, F(840));
+    num = MA(x, num, F(1680));
+    auto den = _mm256_add_ps(F(-20), x);
+    den = MA(x, den, F(180));
+    den = MA(x, den, F(-840));
+    den = MA(x, den, F(1680));
+    return _mm256_div_ps(num, den);
+}
+
+#undef MA
+#undef F
+#endif
+
 } // namespace sst::basic_blocks::dsp
 #endif
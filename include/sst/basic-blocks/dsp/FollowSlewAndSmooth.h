@@ -28,6 +28,7 @@
 #define INCLUDE_SST_BASIC_BLOCKS_DSP_FOLLOWSLEWANDSMOOTH_H
 
 #include <algorithm>
+#include <cmath>
 #include <utility>
 
 namespace sst::basic_blocks::dsp
@@ -104,6 +105,26 @@ struct LowPassEnvelopeFollower
 
         return r;
     }
+
+    // step over a block with the filter state in locals; out may be in
+    void processBlock(const float *in, float *out, int n)
+    {
+        auto x0 = xp[0], x1 = xp[1], y0 = yp[0], y1 = yp[1];
+        for (int i = 0; i < n; ++i)
+        {
+            auto x = std::fabs(in[i]);
+            auto r = xc[0] * x + xc[1] * x0 + xc[2] * x1 + yc[1] * y0 + yc[2] * y1;
+            y1 = y0;
+            y0 = r;
+            x1 = x0;
+            x0 = x;
+            out[i] = r;
+        }
+        xp[0] = x0;
+        xp[1] = x1;
+        yp[0] = y0;
+        yp[1] = y1;
+    }
 };
 
 struct SlewLimiter
@@ -134,6 +155,18 @@ struct SlewLimiter
         last = res;
         return res;
     }
+
+    // the same limit as step, written as a clamp to [last - delta, last + delta]
+    void processBlock(const float *in, float *out, int n)
+    {
+        auto l = last;
+        for (int i = 0; i < n; ++i)
+        {
+            l = std::max(std::min(in[i], l + delta), l - delta);
+            out[i] = l;
+        }
+        last = l;
+    }
 };
 
 struct RunningAverage
@@ -171,6 +204,211 @@ struct RunningAverage
 
         return avg;
     }
+
+    /*
+     * step over a block. The update is already O(1) per sample; this splits the block into
+     * runs where neither head nor tail wraps so the inner loop has no index checks.
+     */
+    void processBlock(const float *in, float *out, size_t n)
+    {
+        size_t done = 0;
+        while (done < n)
+        {
+            auto run = std::min({n - done, nPoints - head, nPoints - tail});
+            auto *h = storage + head;
+            const auto *t = storage + tail;
+            for (size_t i = 0; i < run; ++i)
+            {
+                h[i] = in[done + i];
+                avg += (h[i] - t[i]) * oneOverN;
+                out[done + i] = avg;
+            }
+            head += run;
+            if (head >= nPoints)
+                head = 0;
+            tail += run;
+            if (tail >= nPoints)
+                tail = 0;
+            done += run;
+        }
+    }
+};
+
+namespace detail
+{
+/*
+ * Drive a four channel stepper over four channel buffers, transposing four samples at a time
+ * into and out of the frame-per-register layout step wants.
+ */
+template <typename Step>
+inline void quad_channel_block(const float *const in[4], float *const out[4], int n, Step &&step)
+{
+    int s = 0;
+    for (; s + 4 <= n; s += 4)
+    {
+        __m128 v[4] = {_mm_loadu_ps(in[0] + s), _mm_loadu_ps(in[1] + s), _mm_loadu_ps(in[2] + s),
+                       _mm_loadu_ps(in[3] + s)};
+        _MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+        for (int k = 0; k < 4; ++k)
+            v[k] = step(v[k]);
+        _MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+        for (int c = 0; c < 4; ++c)
+            _mm_storeu_ps(out[c] + s, v[c]);
+    }
+    for (; s < n; ++s)
+    {
+        float r alignas(16)[4];
+        _mm_store_ps(r, step(_mm_setr_ps(in[0][s], in[1][s], in[2][s], in[3][s])));
+        for (int c = 0; c < 4; ++c)
+            out[c][s] = r[c];
+    }
+}
+} // namespace detail
+
+/*
+ * Four LowPassEnvelopeFollowers, one channel per SSE lane, each with its own sensitivity.
+ * Each lane matches the scalar follower.
+ */
+struct LowPassEnvelopeFollowerQuad
+{
+    __m128 xp[2], yp[2];
+    __m128 xc[3], yc[3];
+
+    LowPassEnvelopeFollowerQuad() { reset(); }
+
+    void reset()
+    {
+        LowPassEnvelopeFollower f;
+        for (int c = 0; c < 4; ++c)
+            setFrom(c, f);
+        xp[0] = xp[1] = yp[0] = yp[1] = _mm_setzero_ps();
+    }
+
+    void setSensitivity01(int channel, float sens01, float sampleRate)
+    {
+        LowPassEnvelopeFollower f;
+        f.setSensitivity01(sens01, sampleRate);
+        setFrom(channel, f);
+    }
+
+    inline __m128 step(__m128 x)
+    {
+        x = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+        auto r = _mm_mul_ps(xc[0], x);
+        r = _mm_add_ps(r, _mm_mul_ps(xc[1], xp[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(xc[2], xp[1]));
+        r = _mm_add_ps(r, _mm_mul_ps(yc[1], yp[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(yc[2], yp[1]));
+
+        yp[1] = yp[0];
+        yp[0] = r;
+        xp[1] = xp[0];
+        xp[0] = x;
+        return r;
+    }
+
+    void processBlock(const float *const in[4], float *const out[4], int n)
+    {
+        detail::quad_channel_block(in, out, n, [this](__m128 v) { return step(v); });
+    }
+
+  private:
+    static void setLane(__m128 &v, int i, float f)
+    {
+        float r alignas(16)[4];
+        _mm_store_ps(r, v);
+        r[i] = f;
+        v = _mm_load_ps(r);
+    }
+    void setFrom(int c, const LowPassEnvelopeFollower &f)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            setLane(xc[i], c, f.xc[i]);
+            setLane(yc[i], c, f.yc[i]);
+        }
+    }
+};
+
+// Four SlewLimiters, one channel per SSE lane
+struct SlewLimiterQuad
+{
+    __m128 delta{_mm_setzero_ps()}, last{_mm_setzero_ps()};
+
+    void setParams(int channel, float ms, float range, float sampleRate)
+    {
+        SlewLimiter s;
+        s.setParams(ms, range, sampleRate);
+        float d alignas(16)[4];
+        _mm_store_ps(d, delta);
+        d[channel] = s.delta;
+        delta = _mm_load_ps(d);
+    }
+    void setParams(float ms, float range, float sampleRate)
+    {
+        for (int c = 0; c < 4; ++c)
+            setParams(c, ms, range, sampleRate);
+    }
+
+    void setLast(__m128 l) { last = l; }
+    void reset() { setLast(_mm_setzero_ps()); }
+
+    inline __m128 step(__m128 x)
+    {
+        last = _mm_max_ps(_mm_min_ps(x, _mm_add_ps(last, delta)), _mm_sub_ps(last, delta));
+        return last;
+    }
+
+    void processBlock(const float *const in[4], float *const out[4], int n)
+    {
+        detail::quad_channel_block(in, out, n, [this](__m128 v) { return step(v); });
+    }
+};
+
+/*
+ * Four RunningAverages sharing one window length. ontoStorage holds nPoints registers, so
+ * 16 byte aligned and 4 * np floats.
+ */
+struct RunningAverageQuad
+{
+    __m128 *storage{nullptr};
+    size_t nPoints{0};
+    size_t head{0}, tail{0};
+    __m128 avg, oneOverN;
+
+    RunningAverageQuad(float *ontoStorage, size_t np)
+        : storage{reinterpret_cast<__m128 *>(ontoStorage)}, nPoints{np}
+    {
+        reset();
+        oneOverN = _mm_set1_ps(1.0 / (nPoints - 1));
+    }
+    RunningAverageQuad() = delete;
+
+    void reset()
+    {
+        std::fill(storage, storage + nPoints, _mm_setzero_ps());
+        head = 0;
+        tail = 1;
+        avg = _mm_setzero_ps();
+    }
+
+    inline __m128 step(__m128 x)
+    {
+        storage[head] = x;
+        avg = _mm_add_ps(avg, _mm_mul_ps(_mm_sub_ps(x, storage[tail]), oneOverN));
+        head++;
+        if (head >= nPoints)
+            head = 0;
+        tail++;
+        if (tail >= nPoints)
+            tail = 0;
+        return avg;
+    }
+
+    void processBlock(const float *const in[4], float *const out[4], int n)
+    {
+        detail::quad_channel_block(in, out, n, [this](__m128 v) { return step(v); });
+    }
 };
 } // namespace sst::basic_blocks::dsp
 
@@ -52,8 +52,8 @@
  * The actual calculation of the hilbert transform numerically
  * is tricky, which is why we are particularly grateful to
  * Sean for sharing this implementation (which he shared
- * in float form, and which is presented here both in
- * mono-float form and in stereo-SSE form).
+ * in float form, and which is presented here in mono-float
+ * form, in stereo-SSE form and as four SSE mono lanes).
  */
 
 #include <utility>
@@ -286,6 +286,180 @@ struct HilbertTransformStereoSSE
         _mm_store_ps(r, v);
         return {{r[0], r[1]}, {r[2], r[3]}};
     }
+
+    /*
+     * Run n samples keeping the biquad state in locals for the whole block. Four samples are
+     * handled per pass: the inputs are splatted into L L R R straight from two loads and the four
+     * reL imL reR imR results are transposed into the output rows, so nothing goes through a
+     * stack array. The results are identical to calling stepStereo n times.
+     */
+    void processBlock(const float *L, const float *R, float *reL, float *imL, float *reR,
+                      float *imR, int n)
+    {
+        BQ ap[3]{allpassSSE[0], allpassSSE[1], allpassSSE[2]};
+
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            auto l4 = _mm_loadu_ps(L + i);
+            auto r4 = _mm_loadu_ps(R + i);
+            auto lo = _mm_unpacklo_ps(l4, r4); // L0 R0 L1 R1
+            auto hi = _mm_unpackhi_ps(l4, r4); // L2 R2 L3 R3
+            __m128 o[4] = {_mm_shuffle_ps(lo, lo, _MM_SHUFFLE(1, 1, 0, 0)),
+                           _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(3, 3, 2, 2)),
+                           _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(1, 1, 0, 0)),
+                           _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(3, 3, 2, 2))};
+            for (int k = 0; k < 4; ++k)
+                for (int j = 0; j < 3; ++j)
+                    o[k] = ap[j].step(o[k]);
+
+            _MM_TRANSPOSE4_PS(o[0], o[1], o[2], o[3]);
+            _mm_storeu_ps(reL + i, o[0]);
+            _mm_storeu_ps(imL + i, o[1]);
+            _mm_storeu_ps(reR + i, o[2]);
+            _mm_storeu_ps(imR + i, o[3]);
+        }
+        for (; i < n; ++i)
+        {
+            auto v = _mm_setr_ps(L[i], L[i], R[i], R[i]);
+            for (int j = 0; j < 3; ++j)
+                v = ap[j].step(v);
+            float r alignas(16)[4];
+            _mm_store_ps(r, v);
+            reL[i] = r[0];
+            imL[i] = r[1];
+            reR[i] = r[2];
+            imR[i] = r[3];
+        }
+
+        for (int j = 0; j < 3; ++j)
+        {
+            allpassSSE[j].reg0 = ap[j].reg0;
+            allpassSSE[j].reg1 = ap[j].reg1;
+        }
+    }
+};
+
+/*
+ * Four independent mono hilbert transforms, one per SSE lane, for polyphonic frequency
+ * shifters and ring mods. The real and imaginary allpass chains each run all four lanes at
+ * once, so every lane matches the L channel of HilbertTransformStereoSSE.
+ */
+struct HilbertTransformQuadSSE
+{
+    HilbertTransformStereoSSE::BQ allpassRe[3], allpassIm[3];
+
+    float sampleRate{0};
+    void setSampleRate(float sr)
+    {
+        sampleRate = sr;
+        setHilbertCoefs();
+    }
+
+    void setHilbertCoefs()
+    {
+        assert(sampleRate);
+        // Borrow the coefficient calculation and take the L lanes of each chain
+        HilbertTransformStereoSSE st;
+        st.setSampleRate(sampleRate);
+        for (int j = 0; j < 3; ++j)
+        {
+            auto &s = st.allpassSSE[j];
+            const auto lane = [](__m128 v, int i) {
+                float r alignas(16)[4];
+                _mm_store_ps(r, v);
+                return _mm_set1_ps(r[i]);
+            };
+            for (int c = 0; c < 2; ++c)
+            {
+                auto &bq = c == 0 ? allpassRe[j] : allpassIm[j];
+                bq.a1 = lane(s.a1, c);
+                bq.a2 = lane(s.a2, c);
+                bq.b0 = lane(s.b0, c);
+                bq.b1 = lane(s.b1, c);
+                bq.b2 = lane(s.b2, c);
+                bq.reset();
+            }
+        }
+    }
+
+    void reset()
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            allpassRe[j].reset();
+            allpassIm[j].reset();
+        }
+    }
+
+    inline void step(__m128 in, __m128 &re, __m128 &im)
+    {
+        re = in;
+        im = in;
+        for (int j = 0; j < 3; ++j)
+        {
+            re = allpassRe[j].step(re);
+            im = allpassIm[j].step(im);
+        }
+    }
+
+    // Block form over four separate lane buffers, state held in locals across the block
+    void processBlock(const float *const in[4], float *const re[4], float *const im[4], int n)
+    {
+        HilbertTransformStereoSSE::BQ apRe[3]{allpassRe[0], allpassRe[1], allpassRe[2]};
+        HilbertTransformStereoSSE::BQ apIm[3]{allpassIm[0], allpassIm[1], allpassIm[2]};
+
+        const auto stepBoth = [&](__m128 v, __m128 &r, __m128 &i) {
+            r = v;
+            i = v;
+            for (int j = 0; j < 3; ++j)
+            {
+                r = apRe[j].step(r);
+                i = apIm[j].step(i);
+            }
+        };
+
+        int s = 0;
+        for (; s + 4 <= n; s += 4)
+        {
+            __m128 v[4] = {_mm_loadu_ps(in[0] + s), _mm_loadu_ps(in[1] + s),
+                           _mm_loadu_ps(in[2] + s), _mm_loadu_ps(in[3] + s)};
+            _MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]); // v[k] is frame s + k across lanes
+
+            __m128 r[4], i[4];
+            for (int k = 0; k < 4; ++k)
+                stepBoth(v[k], r[k], i[k]);
+
+            _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+            _MM_TRANSPOSE4_PS(i[0], i[1], i[2], i[3]);
+            for (int c = 0; c < 4; ++c)
+            {
+                _mm_storeu_ps(re[c] + s, r[c]);
+                _mm_storeu_ps(im[c] + s, i[c]);
+            }
+        }
+        for (; s < n; ++s)
+        {
+            __m128 r, i;
+            stepBoth(_mm_setr_ps(in[0][s], in[1][s], in[2][s], in[3][s]), r, i);
+            float rr alignas(16)[4], ii alignas(16)[4];
+            _mm_store_ps(rr, r);
+            _mm_store_ps(ii, i);
+            for (int c = 0; c < 4; ++c)
+            {
+                re[c][s] = rr[c];
+                im[c][s] = ii[c];
+            }
+        }
+
+        for (int j = 0; j < 3; ++j)
+        {
+            allpassRe[j].reg0 = apRe[j].reg0;
+            allpassRe[j].reg1 = apRe[j].reg1;
+            allpassIm[j].reg0 = apIm[j].reg0;
+            allpassIm[j].reg1 = apIm[j].reg1;
+        }
+    }
 };
 } // namespace sst::basic_blocks::dsp
 
@@ -0,0 +1,331 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_DSP_LAGBANK_H
+#define INCLUDE_SST_BASIC_BLOCKS_DSP_LAGBANK_H
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include "Lag.h"
+
+/*
+ * Structure-of-arrays banks of N SurgeLags and N UIComponentLagHandlers, with N a
+ * multiple of 4. Lanes are stepped four at a time in SSE, and a group of four only
+ * costs anything while one of its lanes is moving: the banks keep the moving groups in
+ * an active list, so a process() call is O(active groups) rather than O(N). Like the
+ * rest of the SIMD code, include your SSE headers first.
+ */
+namespace sst::basic_blocks::dsp
+{
+namespace details
+{
+/*
+ * The active groups as a dense list with an index back into it, so activation and
+ * removal are O(1). Walk it from the back when removing while iterating, since removal
+ * moves the last entry into the hole.
+ */
+template <int G> struct ActiveGroupList
+{
+    int list[G];
+    int position[G];
+    int count{0};
+
+    ActiveGroupList()
+    {
+        for (auto &p : position)
+            p = -1;
+    }
+
+    bool contains(int g) const { return position[g] >= 0; }
+    void add(int g)
+    {
+        if (position[g] >= 0)
+            return;
+        position[g] = count;
+        list[count++] = g;
+    }
+    void remove(int g)
+    {
+        auto p = position[g];
+        if (p < 0)
+            return;
+        auto last = list[--count];
+        list[p] = last;
+        position[last] = p;
+        position[g] = -1;
+    }
+};
+
+inline __m128 laneMask(const uint32_t *m)
+{
+    return _mm_castsi128_ps(_mm_load_si128((const __m128i *)m));
+}
+} // namespace details
+
+/*
+ * N SurgeLag<float> lanes. Each active lane steps exactly as SurgeLag::process does, and
+ * once it is within convergenceThreshold of its target, or a step no longer moves it, it
+ * snaps to the target and goes idle, which a lone SurgeLag never does. newValue and
+ * startValue follow the SurgeLag first run rules lane by lane. Read the smoothed values
+ * from v.
+ */
+template <int N> struct SurgeLagBank
+{
+    static_assert(N > 0 && !(N & 3), "Bank size must be a multiple of 4");
+    static constexpr int numLanes{N};
+
+    float v alignas(16)[N];
+    float target_v alignas(16)[N];
+    float convergenceThreshold{1e-6f};
+
+    SurgeLagBank(float lp = 0.004f)
+    {
+        for (int l = 0; l < N; ++l)
+        {
+            v[l] = 0;
+            target_v[l] = 0;
+            active[l] = 0;
+            first_run[l] = true;
+            setRate(l, lp);
+        }
+    }
+
+    void setRate(int l, float lp)
+    {
+        assert(l >= 0 && l < N);
+        this->lp[l] = lp;
+        lpinv[l] = 1 - lp;
+    }
+    void setRateAll(float lp)
+    {
+        for (int l = 0; l < N; ++l)
+            setRate(l, lp);
+    }
+
+    inline void newValue(int l, float f)
+    {
+        target_v[l] = f;
+        if (first_run[l])
+        {
+            v[l] = f;
+            first_run[l] = false;
+        }
+        if (v[l] != f)
+            activate(l);
+    }
+
+    inline void startValue(int l, float f)
+    {
+        target_v[l] = f;
+        v[l] = f;
+        first_run[l] = false;
+    }
+
+    inline void instantize(int l) { v[l] = target_v[l]; }
+    inline float getTargetValue(int l) const { return target_v[l]; }
+    inline float getValue(int l) const { return v[l]; }
+    inline bool isActive(int l) const { return active[l] != 0; }
+    inline int activeGroupCount() const { return groups.count; }
+
+    inline void process()
+    {
+        auto thresh = _mm_set1_ps(convergenceThreshold);
+        auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for (int i = groups.count - 1; i >= 0; --i)
+        {
+            auto g = groups.list[i];
+            auto o = g * 4;
+            auto vv = _mm_load_ps(v + o);
+            auto tv = _mm_load_ps(target_v + o);
+            auto nv = _mm_add_ps(_mm_mul_ps(vv, _mm_load_ps(lpinv + o)),
+                                 _mm_mul_ps(tv, _mm_load_ps(lp + o)));
+            auto am = details::laneMask(active + o);
+            // a float one pole can stall ulp/lp short of the target, so no movement is done too
+            auto close = _mm_cmplt_ps(_mm_and_ps(_mm_sub_ps(nv, tv), absMask), thresh);
+            auto done = _mm_and_ps(am, _mm_or_ps(close, _mm_cmpeq_ps(nv, vv)));
+            nv = _mm_or_ps(_mm_and_ps(done, tv), _mm_andnot_ps(done, nv));
+            _mm_store_ps(v + o, _mm_or_ps(_mm_and_ps(am, nv), _mm_andnot_ps(am, vv)));
+
+            auto dm = _mm_movemask_ps(done);
+            if (dm)
+                retire(g, dm);
+        }
+    }
+
+  private:
+    float lp alignas(16)[N], lpinv alignas(16)[N];
+    uint32_t active alignas(16)[N];
+    bool first_run[N];
+    details::ActiveGroupList<N / 4> groups;
+
+    void activate(int l)
+    {
+        active[l] = 0xFFFFFFFF;
+        groups.add(l >> 2);
+    }
+
+    void retire(int g, int doneMask)
+    {
+        auto o = g * 4;
+        for (int j = 0; j < 4; ++j)
+            if (doneMask & (1 << j))
+                active[o + j] = 0;
+        if (!(active[o] | active[o + 1] | active[o + 2] | active[o + 3]))
+            groups.remove(g);
+    }
+};
+
+/*
+ * N UIComponentLagHandlers; each lane ramps linearly onto its destination pointer
+ * with the same semantics as UIComponentLagHandler, including writing the destination
+ * on every active step. The arithmetic is four-wide; the destination writes are scalar.
+ */
+template <int N> struct UIComponentLagBank
+{
+    static_assert(N > 0 && !(N & 3), "Bank size must be a multiple of 4");
+    static constexpr int numLanes{N};
+
+    float *destination[N];
+    float targetValue alignas(16)[N];
+    float value alignas(16)[N];
+    float dTarget alignas(16)[N];
+    float dTargetScale[N];
+
+    UIComponentLagBank()
+    {
+        for (int l = 0; l < N; ++l)
+        {
+            destination[l] = nullptr;
+            targetValue[l] = 0;
+            value[l] = 0;
+            dTarget[l] = 0;
+            dTargetScale[l] = 0.05f;
+            active[l] = 0;
+        }
+    }
+
+    void setRate(int l, float rateInHz, uint16_t blockSize, float sampleRate)
+    {
+        int blocks = (int)std::round(sampleRate / rateInHz / blockSize);
+        dTargetScale[l] = 1.f / blocks;
+    }
+    void setRate(float rateInHz, uint16_t blockSize, float sampleRate)
+    {
+        for (int l = 0; l < N; ++l)
+            setRate(l, rateInHz, blockSize, sampleRate);
+    }
+
+    void setNewDestination(int l, float *d, float toTarget)
+    {
+        if (isActive(l) && d == destination[l])
+        {
+            // restating an active target
+            setTarget(l, toTarget);
+        }
+        else
+        {
+            if (isActive(l))
+            {
+                // We are still lagging the prior. Rare case. Just speed it up.
+                *destination[l] = targetValue[l];
+            }
+            value[l] = *d;
+            destination[l] = d;
+            setTarget(l, toTarget);
+        }
+    }
+
+    void setTarget(int l, float t)
+    {
+        targetValue[l] = t;
+        dTarget[l] = (targetValue[l] - value[l]) * dTargetScale[l];
+        active[l] = 0xFFFFFFFF;
+        groups.add(l >> 2);
+    }
+
+    void instantlySnap(int l)
+    {
+        if (!isActive(l))
+            return;
+
+        if (destination[l])
+        {
+            *destination[l] = targetValue[l];
+        }
+        deactivate(l);
+    }
+
+    inline bool isActive(int l) const { return active[l] != 0; }
+    inline int activeGroupCount() const { return groups.count; }
+
+    void process()
+    {
+        auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for (int i = groups.count - 1; i >= 0; --i)
+        {
+            auto g = groups.list[i];
+            auto o = g * 4;
+            auto vv = _mm_load_ps(value + o);
+            auto dv = _mm_load_ps(dTarget + o);
+            auto tv = _mm_load_ps(targetValue + o);
+            auto am = details::laneMask(active + o);
+
+            auto nv = _mm_add_ps(vv, dv);
+            auto done = _mm_and_ps(am, _mm_cmplt_ps(_mm_and_ps(_mm_sub_ps(nv, tv), absMask),
+                                                    _mm_and_ps(dv, absMask)));
+            nv = _mm_or_ps(_mm_and_ps(done, tv), _mm_andnot_ps(done, nv));
+            nv = _mm_or_ps(_mm_and_ps(am, nv), _mm_andnot_ps(am, vv));
+            _mm_store_ps(value + o, nv);
+
+            auto dm = _mm_movemask_ps(done);
+            for (int j = 0; j < 4; ++j)
+            {
+                if (!active[o + j])
+                    continue;
+                *destination[o + j] = value[o + j];
+                if (dm & (1 << j))
+                    deactivate(o + j);
+            }
+        }
+    }
+
+  private:
+    uint32_t active alignas(16)[N];
+    details::ActiveGroupList<N / 4> groups;
+
+    void deactivate(int l)
+    {
+        active[l] = 0;
+        auto o = l & ~3;
+        if (!(active[o] | active[o + 1] | active[o + 2] | active[o + 3]))
+            groups.remove(l >> 2);
+    }
+};
+} // namespace sst::basic_blocks::dsp
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_DSP_LAGBANK_H
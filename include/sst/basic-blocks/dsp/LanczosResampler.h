@@ -33,8 +33,9 @@
  * README.md. If you commit changes to this file, you are also
  * willing to have it re-used in a GPL3 or MIT/BSD context.
  *
- * If you do use this in a GPL3 context, you will need to copy,
- * strip the single include and replace the `sum_ps_to_float`
+ * If you do use this in a GPL3 context, you will need to copy
+ * this and tables/LanczosTableProvider.h (which is under the same
+ * terms), strip the simd-ops include and replace the `sum_ps_to_float`
  * call below with either an hadd if you are SSE3 or higher or
  * an appropriate reduction operator from your toolkit.
  *
@@ -50,7 +51,10 @@
 #include <utility>
 #include <cmath>
 #include <cstring>
+#include <cassert>
 #include "sst/basic-blocks/mechanics/simd-ops.h"
+#include "sst/basic-blocks/tables/LanczosTableProvider.h"
+#include "sst/basic-blocks/mechanics/instrumentation.h"
 
 namespace sst::basic_blocks::dsp
 {
@@ -58,31 +62,54 @@ namespace sst::basic_blocks::dsp
  * See https://en.wikipedia.org/wiki/Lanczos_resampling
  */
 
-template <int blockSize> struct LanczosResampler
+/*
+ * The resampler holds nChannels of input history in a mirrored buffer of bufferSize
+ * frames, so mono voices and wider buses only pay for the channels they have. The
+ * stereo push / read / populate signatures remain for nChannels == 2, and the
+ * channel pointer forms work for any channel count.
+ *
+ * Quality comes in two tiers. At compile time lanczosA sets the kernel window (2A taps;
+ * 2, 3, 4 and 8 are the usual choices) and lanczosTableObs the kernel table resolution.
+ * Per instance, setInterpolation picks the Lanczos read or the cheap zero order hold and
+ * linear reads. The populate functions switch on that once per call, so the per frame
+ * loops carry no dispatch.
+ */
+template <int blockSize, int nChannels = 2, size_t bufferSize = 4096, size_t lanczosA = 4,
+          size_t lanczosTableObs = 8192>
+struct LanczosResampler
 {
-    static constexpr size_t A = 4;
-    static constexpr size_t BUFFER_SZ = 4096;
+    static_assert(nChannels > 0, "Need at least one channel");
+    static_assert(bufferSize >= 16 && !(bufferSize & (bufferSize - 1)),
+                  "Buffer size must be a power of 2");
+
+    static constexpr size_t A = lanczosA;
+    static constexpr size_t BUFFER_SZ = bufferSize;
+    static constexpr int numChannels = nChannels;
     static constexpr size_t filterWidth = A * 2;
-    static constexpr size_t tableObs = 8192;
+    static constexpr size_t tableObs = lanczosTableObs;
     static constexpr double dx = 1.0 / (tableObs);
+    static_assert(BUFFER_SZ > 4 * A, "Buffer too small for the kernel window");
 
-    // Fixme: Make this static and shared
-    static float lanczosTable alignas(16)[tableObs + 1][filterWidth], lanczosTableDX
-        alignas(16)[tableObs + 1][filterWidth];
-    static bool tablesInitialized;
+    // The kernel tables are built once and shared by every resampler with this window
+    using tables_t = tables::LanczosTableProvider<A, tableObs>;
+    static constexpr size_t kernelQuads = tables_t::rowWidth / 4;
+    const float (*lanczosTable)[tables_t::rowWidth]{nullptr};
+    const float (*lanczosTableDX)[tables_t::rowWidth]{nullptr};
 
-    // This is a stereo resampler
-    float input[2][BUFFER_SZ * 2];
+    enum Interpolation
+    {
+        ZERO_ORDER_HOLD,
+        LINEAR,
+        LANCZOS
+    } interpolation{LANCZOS};
+    inline void setInterpolation(Interpolation i) { interpolation = i; }
+
+    float input[nChannels][BUFFER_SZ * 2];
     int wp = 0;
     float sri, sro;
     double phaseI, phaseO, dPhaseI, dPhaseO;
 
-    inline double kernel(double x)
-    {
-        if (fabs(x) < 1e-7)
-            return 1;
-        return A * std::sin(M_PI * x) * std::sin(M_PI * x / A) / (M_PI * M_PI * x * x);
-    }
+    inline double kernel(double x) { return tables_t::kernel(x); }
 
     LanczosResampler(float inputRate, float outputRate) : sri(inputRate), sro(outputRate)
     {
@@ -92,38 +119,17 @@ template <int blockSize> struct LanczosResampler
         dPhaseI = 1.0;
         dPhaseO = sri / sro;
 
-        memset(input[0], 0, 2 * BUFFER_SZ * sizeof(float));
-        memset(input[1], 0, 2 * BUFFER_SZ * sizeof(float));
-        if (!tablesInitialized)
-        {
-            for (size_t t = 0; t < tableObs + 1; ++t)
-            {
-                double x0 = dx * t;
-                for (size_t i = 0; i < filterWidth; ++i)
-                {
-                    double x = x0 + i - A;
-                    lanczosTable[t][i] = kernel(x);
-                }
-            }
-            for (size_t t = 0; t < tableObs; ++t)
-            {
-                for (size_t i = 0; i < filterWidth; ++i)
-                {
-                    // t+1 is fine here since the input goes up to tableObs + 1 size
-                    lanczosTableDX[t][i] = lanczosTable[t + 1][i] - lanczosTable[t][i];
-                }
-            }
-            for (size_t i = 0; i < filterWidth; ++i)
-            {
-                // Wrap at the end - deriv is the same
-                lanczosTableDX[tableObs][i] = lanczosTableDX[0][i];
-            }
-            tablesInitialized = true;
-        }
+        for (int c = 0; c < nChannels; ++c)
+            memset(input[c], 0, 2 * BUFFER_SZ * sizeof(float));
+
+        const auto &tables = tables_t::shared();
+        lanczosTable = tables.lanczosTable;
+        lanczosTableDX = tables.lanczosTableDX;
     }
 
     inline void push(float fL, float fR)
     {
+        static_assert(nChannels == 2, "push(L, R) is the stereo push");
         input[0][wp] = fL;
         input[0][wp + BUFFER_SZ] = fL; // this way we can always wrap
         input[1][wp] = fR;
@@ -132,18 +138,61 @@ template <int blockSize> struct LanczosResampler
         phaseI += dPhaseI;
     }
 
-    inline void readZOH(double xBack, float &L, float &R) const
+    inline void push(float f)
+    {
+        static_assert(nChannels == 1, "push(f) is the mono push");
+        input[0][wp] = f;
+        input[0][wp + BUFFER_SZ] = f;
+        wp = (wp + 1) & (BUFFER_SZ - 1);
+        phaseI += dPhaseI;
+    }
+
+    // push one frame of nChannels values
+    inline void pushFrame(const float *frame)
+    {
+        for (int c = 0; c < nChannels; ++c)
+        {
+            input[c][wp] = frame[c];
+            input[c][wp + BUFFER_SZ] = frame[c];
+        }
+        wp = (wp + 1) & (BUFFER_SZ - 1);
+        phaseI += dPhaseI;
+    }
+
+    /*
+     * Push n frames, channels[c][0..n), copying runs straight into both halves of the
+     * mirrored buffer rather than a frame at a time.
+     */
+    inline void push(const float *const *channels, size_t n)
+    {
+        assert(n <= BUFFER_SZ);
+        size_t done = 0;
+        while (done < n)
+        {
+            auto chunk = std::min(n - done, BUFFER_SZ - wp);
+            for (int c = 0; c < nChannels; ++c)
+            {
+                memcpy(&input[c][wp], channels[c] + done, chunk * sizeof(float));
+                memcpy(&input[c][wp + BUFFER_SZ], channels[c] + done, chunk * sizeof(float));
+            }
+            wp = (wp + chunk) & (BUFFER_SZ - 1);
+            done += chunk;
+        }
+        phaseI += n * dPhaseI;
+    }
+
+    inline void readZOH(double xBack, float *out) const
     {
         double p0 = wp - xBack;
         int idx0 = (int)p0;
         idx0 = (idx0 + BUFFER_SZ) & (BUFFER_SZ - 1);
         if (idx0 <= (int)A)
             idx0 += BUFFER_SZ;
-        L = input[0][idx0];
-        R = input[1][idx0];
+        for (int c = 0; c < nChannels; ++c)
+            out[c] = input[c][idx0];
     }
 
-    inline void readLin(double xBack, float &L, float &R) const
+    inline void readLin(double xBack, float *out) const
     {
         double p0 = wp - xBack;
         int idx0 = (int)p0;
@@ -151,14 +200,16 @@ template <int blockSize> struct LanczosResampler
         idx0 = (idx0 + BUFFER_SZ) & (BUFFER_SZ - 1);
         if (idx0 <= (int)A)
             idx0 += BUFFER_SZ;
-        L = (1.0 - frac) * input[0][idx0] + frac * input[0][idx0 + 1];
-        R = (1.0 - frac) * input[1][idx0] + frac * input[1][idx0 + 1];
+        for (int c = 0; c < nChannels; ++c)
+            out[c] = (1.0 - frac) * input[c][idx0] + frac * input[c][idx0 + 1];
     }
 
-    inline void read(double xBack, float &L, float &R) const
+    // the buffer position and interpolated kernel quads for a read xBack behind wp
+    inline void kernelAt(double xBack, int &idx0, __m128 *f) const
     {
         double p0 = wp - xBack;
-        int idx0 = floor(p0);
+        idx0 = (int)p0;
+        idx0 -= (p0 < idx0); // floor without the libm call
         double off0 = 1.0 - (p0 - idx0);
 
         idx0 = (idx0 + BUFFER_SZ) & (BUFFER_SZ - 1);
@@ -166,27 +217,88 @@ template <int blockSize> struct LanczosResampler
 
         double off0byto = off0 * tableObs;
         int tidx = (int)(off0byto);
-        double fidx = (off0byto - tidx);
+        auto fl = _mm_set1_ps((float)(off0byto - tidx));
 
-        auto fl = _mm_set1_ps((float)fidx);
-        auto f0 = _mm_load_ps(&lanczosTable[tidx][0]);
-        auto df0 = _mm_load_ps(&lanczosTableDX[tidx][0]);
+        for (size_t q = 0; q < kernelQuads; ++q)
+            f[q] = _mm_add_ps(_mm_load_ps(&lanczosTable[tidx][4 * q]),
+                              _mm_mul_ps(_mm_load_ps(&lanczosTableDX[tidx][4 * q]), fl));
+    }
 
-        f0 = _mm_add_ps(f0, _mm_mul_ps(df0, fl));
+    // tap i multiplies input[idx0 - A + i]; padded taps are zero
+    inline __m128 tapProducts(int c, int idx0, const __m128 *f) const
+    {
+        auto r = _mm_mul_ps(f[0], _mm_loadu_ps(&input[c][idx0 - A]));
+        for (size_t q = 1; q < kernelQuads; ++q)
+            r = _mm_add_ps(r, _mm_mul_ps(f[q], _mm_loadu_ps(&input[c][idx0 - A + 4 * q])));
+        return r;
+    }
 
-        auto f1 = _mm_load_ps(&lanczosTable[tidx][4]);
-        auto df1 = _mm_load_ps(&lanczosTableDX[tidx][4]);
-        f1 = _mm_add_ps(f1, _mm_mul_ps(df1, fl));
+    // read one frame into out[0..nChannels)
+    inline void read(double xBack, float *out) const
+    {
+        int idx0;
+        __m128 f[kernelQuads];
+        kernelAt(xBack, idx0, f);
+        for (int c = 0; c < nChannels; ++c)
+            out[c] = mechanics::sum_ps_to_float(tapProducts(c, idx0, f));
+    }
 
-        auto d0 = _mm_loadu_ps(&input[0][idx0 - A]);
-        auto d1 = _mm_loadu_ps(&input[0][idx0]);
-        auto rv = _mm_add_ps(_mm_mul_ps(f0, d0), _mm_mul_ps(f1, d1));
-        L = mechanics::sum_ps_to_float(rv);
+    /*
+     * Read four frames at xBack0 - k * dxBack, k = 0..3, into out[c][0..3].
+     * Rather than reducing each frame's tap products horizontally, the four frames'
+     * products are transposed so a column add gives all four outputs at once. The sums
+     * pair up as in sum_ps_to_float so this agrees with read() frame for frame.
+     */
+    inline void read4(double xBack0, double dxBack, float *const *out) const
+    {
+        int idx[4];
+        __m128 f[4][kernelQuads];
+        for (int k = 0; k < 4; ++k)
+            kernelAt(xBack0 - k * dxBack, idx[k], f[k]);
 
-        d0 = _mm_loadu_ps(&input[1][idx0 - A]);
-        d1 = _mm_loadu_ps(&input[1][idx0]);
-        rv = _mm_add_ps(_mm_mul_ps(f0, d0), _mm_mul_ps(f1, d1));
-        R = mechanics::sum_ps_to_float(rv);
+        for (int c = 0; c < nChannels; ++c)
+        {
+            auto r0 = tapProducts(c, idx[0], f[0]);
+            auto r1 = tapProducts(c, idx[1], f[1]);
+            auto r2 = tapProducts(c, idx[2], f[2]);
+            auto r3 = tapProducts(c, idx[3], f[3]);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(out[c], _mm_add_ps(_mm_add_ps(r0, r2), _mm_add_ps(r1, r3)));
+        }
+    }
+
+    inline void readZOH(double xBack, float &L, float &R) const
+    {
+        static_assert(nChannels == 2, "The L, R reads are stereo");
+        float o[2];
+        readZOH(xBack, o);
+        L = o[0];
+        R = o[1];
+    }
+
+    inline void readLin(double xBack, float &L, float &R) const
+    {
+        static_assert(nChannels == 2, "The L, R reads are stereo");
+        float o[2];
+        readLin(xBack, o);
+        L = o[0];
+        R = o[1];
+    }
+
+    inline void read(double xBack, float &L, float &R) const
+    {
+        static_assert(nChannels == 2, "The L, R reads are stereo");
+        float o[2];
+        read(xBack, o);
+        L = o[0];
+        R = o[1];
+    }
+
+    inline void read4(double xBack0, double dxBack, float *L, float *R) const
+    {
+        static_assert(nChannels == 2, "The L, R reads are stereo");
+        float *o[2]{L, R};
+        read4(xBack0, dxBack, o);
     }
 
     inline size_t inputsRequiredToGenerateOutputs(size_t desiredOutputs) const
@@ -202,15 +314,35 @@ template <int blockSize> struct LanczosResampler
         return (size_t)std::max(res + 1, 0.0); // Check this calculation
     }
 
-    size_t populateNext(float *fL, float *fR, size_t max);
+    // out is nChannels pointers to at least max floats
+    size_t populateNext(float *const *out, size_t max);
 
     /*
      * This is a dangerous but efficient function which more quickly
      * populates blockSize or blockSize << 1 worth of items, but assumes you have
      * checked the range.
      */
-    void populateNextBlockSize(float *fL, float *fR);
-    void populateNextBlockSizeOS(float *fL, float *fR);
+    void populateNextBlockSize(float *const *out);
+    void populateNextBlockSizeOS(float *const *out);
+
+    inline size_t populateNext(float *fL, float *fR, size_t max)
+    {
+        static_assert(nChannels == 2, "The L, R populates are stereo");
+        float *o[2]{fL, fR};
+        return populateNext(o, max);
+    }
+    inline void populateNextBlockSize(float *fL, float *fR)
+    {
+        static_assert(nChannels == 2, "The L, R populates are stereo");
+        float *o[2]{fL, fR};
+        populateNextBlockSize(o);
+    }
+    inline void populateNextBlockSizeOS(float *fL, float *fR)
+    {
+        static_assert(nChannels == 2, "The L, R populates are stereo");
+        float *o[2]{fL, fR};
+        populateNextBlockSizeOS(o);
+    }
 
     inline void advanceReadPointer(size_t n) { phaseO += n * dPhaseO; }
     inline void snapOutToIn()
@@ -224,46 +356,133 @@ template <int blockSize> struct LanczosResampler
         phaseI -= phaseO;
         phaseO = 0;
     }
-};
 
-template <int bs>
-float LanczosResampler<bs>::lanczosTable alignas(
-    16)[LanczosResampler<bs>::tableObs + 1][LanczosResampler<bs>::filterWidth];
-template <int bs>
-float LanczosResampler<bs>::lanczosTableDX alignas(
-    16)[LanczosResampler<bs>::tableObs + 1][LanczosResampler<bs>::filterWidth];
+  private:
+    template <Interpolation I> inline void readFrame(double xBack, float *out) const
+    {
+        if constexpr (I == LANCZOS)
+            read(xBack, out);
+        else if constexpr (I == LINEAR)
+            readLin(xBack, out);
+        else
+            readZOH(xBack, out);
+    }
+
+    template <Interpolation I>
+    inline void readFour(double xBack0, double dxBack, float *const *out) const
+    {
+        if constexpr (I == LANCZOS)
+        {
+            read4(xBack0, dxBack, out);
+        }
+        else
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                float f[nChannels];
+                readFrame<I>(xBack0 - k * dxBack, f);
+                for (int c = 0; c < nChannels; ++c)
+                    out[c][k] = f[c];
+            }
+        }
+    }
+
+    // groups of four followed by single reads for the tail
+    template <Interpolation I> inline void readRun(double r0, float *const *out, int n) const
+    {
+        float *o[nChannels];
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            for (int c = 0; c < nChannels; ++c)
+                o[c] = out[c] + i;
+            readFour<I>(r0 - i * dPhaseO, dPhaseO, o);
+        }
+        for (; i < n; ++i)
+        {
+            float f[nChannels];
+            readFrame<I>(r0 - i * dPhaseO, f);
+            for (int c = 0; c < nChannels; ++c)
+                out[c][i] = f[c];
+        }
+    }
+
+    inline void readRun(double r0, float *const *out, int n) const
+    {
+        switch (interpolation)
+        {
+        case ZERO_ORDER_HOLD:
+            readRun<ZERO_ORDER_HOLD>(r0, out, n);
+            break;
+        case LINEAR:
+            readRun<LINEAR>(r0, out, n);
+            break;
+        case LANCZOS:
+            readRun<LANCZOS>(r0, out, n);
+            break;
+        }
+    }
 
-template <int bs> bool LanczosResampler<bs>::tablesInitialized{false};
+    template <Interpolation I> inline size_t populateNextWith(float *const *out, size_t max);
+};
 
-template <int bs> inline size_t LanczosResampler<bs>::populateNext(float *fL, float *fR, size_t max)
+template <int bs, int nc, size_t bfs, size_t la, size_t lto>
+template <typename LanczosResampler<bs, nc, bfs, la, lto>::Interpolation I>
+inline size_t LanczosResampler<bs, nc, bfs, la, lto>::populateNextWith(float *const *out,
+                                                                      size_t max)
 {
     size_t populated = 0;
+    float *o[nc];
+    // four at a time while the last of the four is still far enough back
+    while (populated + 4 <= max && (phaseI - phaseO - 3 * dPhaseO) > A + 1)
+    {
+        for (int c = 0; c < nc; ++c)
+            o[c] = out[c] + populated;
+        readFour<I>((phaseI - phaseO), dPhaseO, o);
+        phaseO += 4 * dPhaseO;
+        populated += 4;
+    }
     while (populated < max && (phaseI - phaseO) > A + 1)
     {
-        read((phaseI - phaseO), fL[populated], fR[populated]);
+        float f[nc];
+        readFrame<I>((phaseI - phaseO), f);
+        for (int c = 0; c < nc; ++c)
+            out[c][populated] = f[c];
         phaseO += dPhaseO;
         populated++;
     }
     return populated;
 }
 
-template <int bs> void LanczosResampler<bs>::populateNextBlockSize(float *fL, float *fR)
+template <int bs, int nc, size_t bfs, size_t la, size_t lto>
+inline size_t LanczosResampler<bs, nc, bfs, la, lto>::populateNext(float *const *out, size_t max)
 {
-    double r0 = phaseI - phaseO;
-    for (int i = 0; i < bs; ++i)
+    SST_BASIC_BLOCKS_PROBE("LanczosResampler::populateNext");
+    switch (interpolation)
     {
-        read(r0 - i * dPhaseO, fL[i], fR[i]);
+    case ZERO_ORDER_HOLD:
+        return populateNextWith<ZERO_ORDER_HOLD>(out, max);
+    case LINEAR:
+        return populateNextWith<LINEAR>(out, max);
+    case LANCZOS:
+        break;
     }
+    return populateNextWith<LANCZOS>(out, max);
+}
+
+template <int bs, int nc, size_t bfs, size_t la, size_t lto>
+void LanczosResampler<bs, nc, bfs, la, lto>::populateNextBlockSize(float *const *out)
+{
+    SST_BASIC_BLOCKS_PROBE("LanczosResampler::populateNextBlockSize");
+    readRun(phaseI - phaseO, out, bs);
     phaseO += (bs << 1) * dPhaseO;
 }
 
-template <int bs> void LanczosResampler<bs>::populateNextBlockSizeOS(float *fL, float *fR)
+template <int bs, int nc, size_t bfs, size_t la, size_t lto>
+void LanczosResampler<bs, nc, bfs, la, lto>::populateNextBlockSizeOS(float *const *out)
 {
-    double r0 = phaseI - phaseO;
-    for (int i = 0; i < bs << 1; ++i)
-    {
-        read(r0 - i * dPhaseO, fL[i], fR[i]);
-    }
+    SST_BASIC_BLOCKS_PROBE("LanczosResampler::populateNextBlockSizeOS");
+    readRun(phaseI - phaseO, out, bs << 1);
     phaseO += (bs << 1) * dPhaseO;
 }
 } // namespace sst::basic_blocks::dsp
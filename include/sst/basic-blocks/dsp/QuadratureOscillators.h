@@ -100,6 +100,141 @@ template <typename T = float> struct SurgeQuadrOsc
   private:
     T dr, di;
 };
+/**
+ * N QuadratureOscillators stepped four lanes to a register, for additive and resonator banks.
+ * The recurrence is three shears which make an exact rotation, so only float rounding moves
+ * u^2 + v^2 off 1. At the end of each block the bank pulls every lane back with one Newton
+ * step towards 1/sqrt(u^2 + v^2), g = (3 - (u^2 + v^2)) / 2, which costs a few multiplies per
+ * partial per block and keeps long runs from drifting in amplitude.
+ */
+template <int N, int blockSize> struct QuadratureOscillatorBank
+{
+    static_assert(N % 4 == 0, "Lanes come in registers of four");
+
+    float u alignas(16)[N], v alignas(16)[N]; // cos and sin, as in QuadratureOscillator
+    float k1 alignas(16)[N]{}, k2 alignas(16)[N]{};
+    float amplitude alignas(16)[N];
+
+    QuadratureOscillatorBank()
+    {
+        for (int l = 0; l < N; ++l)
+        {
+            u[l] = 1;
+            v[l] = 0;
+            amplitude[l] = 1;
+        }
+    }
+
+    inline void setRate(int lane, float omega)
+    {
+        k1[lane] = tan(omega * 0.5);
+        k2[lane] = sin(omega);
+    }
+    inline void setPhase(int lane, float phase)
+    {
+        u[lane] = cos(phase);
+        v[lane] = sin(phase);
+    }
+    inline void setAmplitude(int lane, float a) { amplitude[lane] = a; }
+
+    // out[lane][sample] = amplitude * sin
+    void processBlock(float out[N][blockSize])
+    {
+        stepsSinceRenormalize = 0;
+        for (int g = 0; g < N; g += 4)
+        {
+            auto uu = _mm_load_ps(u + g), vv = _mm_load_ps(v + g);
+            auto a = _mm_load_ps(amplitude + g);
+            auto c1 = _mm_load_ps(k1 + g), c2 = _mm_load_ps(k2 + g);
+            float r alignas(16)[4];
+            for (int s = 0; s < blockSize; ++s)
+            {
+                _mm_store_ps(r, _mm_mul_ps(a, vv));
+                for (int l = 0; l < 4; ++l)
+                    out[g + l][s] = r[l];
+                step(uu, vv, c1, c2);
+            }
+            renormalize(uu, vv);
+            _mm_store_ps(u + g, uu);
+            _mm_store_ps(v + g, vv);
+        }
+    }
+
+    /*
+     * out[s] = sum over lanes of amplitude * sin, overwriting out. Each register of lanes is
+     * run for the whole block with its state held in registers, accumulating four partial sums
+     * per sample which are folded with a transpose at the end.
+     */
+    void processBlockSummed(float *out)
+    {
+        static_assert(blockSize % 4 == 0);
+        stepsSinceRenormalize = 0;
+        __m128 acc[blockSize];
+        for (int s = 0; s < blockSize; ++s)
+            acc[s] = _mm_setzero_ps();
+
+        for (int g = 0; g < N; g += 4)
+        {
+            auto uu = _mm_load_ps(u + g), vv = _mm_load_ps(v + g);
+            auto a = _mm_load_ps(amplitude + g);
+            auto c1 = _mm_load_ps(k1 + g), c2 = _mm_load_ps(k2 + g);
+            for (int s = 0; s < blockSize; ++s)
+            {
+                acc[s] = _mm_add_ps(acc[s], _mm_mul_ps(a, vv));
+                step(uu, vv, c1, c2);
+            }
+            renormalize(uu, vv);
+            _mm_store_ps(u + g, uu);
+            _mm_store_ps(v + g, vv);
+        }
+
+        for (int s = 0; s < blockSize; s += 4)
+        {
+            auto a0 = acc[s], a1 = acc[s + 1], a2 = acc[s + 2], a3 = acc[s + 3];
+            _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+            _mm_storeu_ps(out + s, _mm_add_ps(_mm_add_ps(a0, a2), _mm_add_ps(a1, a3)));
+        }
+    }
+
+    /*
+     * Advance every lane one sample without producing output. Like the block calls, this
+     * renormalizes once every blockSize samples, so a bank driven a sample at a time holds
+     * its amplitude too.
+     */
+    void step()
+    {
+        bool renorm = ++stepsSinceRenormalize == blockSize;
+        for (int g = 0; g < N; g += 4)
+        {
+            auto uu = _mm_load_ps(u + g), vv = _mm_load_ps(v + g);
+            step(uu, vv, _mm_load_ps(k1 + g), _mm_load_ps(k2 + g));
+            if (renorm)
+                renormalize(uu, vv);
+            _mm_store_ps(u + g, uu);
+            _mm_store_ps(v + g, vv);
+        }
+        if (renorm)
+            stepsSinceRenormalize = 0;
+    }
+
+  private:
+    int stepsSinceRenormalize{0};
+
+    static inline void step(__m128 &uu, __m128 &vv, __m128 c1, __m128 c2)
+    {
+        auto w = _mm_sub_ps(uu, _mm_mul_ps(c1, vv));
+        vv = _mm_add_ps(vv, _mm_mul_ps(c2, w));
+        uu = _mm_sub_ps(w, _mm_mul_ps(c1, vv));
+    }
+
+    static inline void renormalize(__m128 &uu, __m128 &vv)
+    {
+        auto m = _mm_add_ps(_mm_mul_ps(uu, uu), _mm_mul_ps(vv, vv));
+        auto g = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(3.f), m), _mm_set1_ps(0.5f));
+        uu = _mm_mul_ps(uu, g);
+        vv = _mm_mul_ps(vv, g);
+    }
+};
 } // namespace sst::basic_blocks::dsp
 
 #endif // SHORTCIRCUITXT_QUADRATUREOSCILLATORS_H
@@ -27,48 +27,141 @@
 #ifndef INCLUDE_SST_BASIC_BLOCKS_DSP_SSESINCDELAYLINE_H
 #define INCLUDE_SST_BASIC_BLOCKS_DSP_SSESINCDELAYLINE_H
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 #include "sst/basic-blocks/mechanics/simd-ops.h"
 #include "sst/basic-blocks/tables/SincTableProvider.h"
 
 namespace sst::basic_blocks::dsp
 {
 
-/*
- * This is a template class which encapsulates the SSE based SINC
- * interpolation in COMBquad_SSE2,just made available for other uses
- */
-template <int COMB_SIZE> // power of two
-struct SSESincDelayLine
+namespace detail
+{
+template <int COMB_SIZE> struct SSESincDelayLineInlineStorage
 {
     static_assert(!(COMB_SIZE & (COMB_SIZE - 1))); // make sure we are a power of 2
     static constexpr int comb_size = COMB_SIZE;
+    float buffer alignas(16)[COMB_SIZE + tables::SurgeSincTableProvider::FIRipol_N];
+};
+
+struct SSESincDelayLineExternalStorage
+{
+    int comb_size{0};
+    float *buffer{nullptr};
+};
+} // namespace detail
 
+/*
+ * The SSE based SINC interpolation in COMBquad_SSE2, made available for other uses. The
+ * algorithm is written once against a Storage which provides buffer and comb_size; the
+ * SSESincDelayLine and SSESincDelayLineRuntime structs below choose inline or external storage.
+ */
+template <typename Storage> struct SSESincDelayLineImpl : Storage
+{
     using stp = tables::SurgeSincTableProvider;
+    using Storage::buffer;
+    using Storage::comb_size;
 
-    float buffer alignas(16)[COMB_SIZE + stp::FIRipol_N];
     int wp = 0;
 
     const float *sinctable{nullptr}; // a pointer copy of the storage member
-    SSESincDelayLine(const float *st) : sinctable(st) { clear(); }
+    SSESincDelayLineImpl(const float *st) : sinctable(st) {}
 
-    /**
-     * If you ahve a long lived instance of a SurgeSincTableProvider you can initialize with that
-     * but please make sure that table has lifetime longer than this interpolator, since we take the
-     * pointer address of its table
+    inline void write(float f)
+    {
+        buffer[wp] = f;
+        buffer[wp + (wp < stp::FIRipol_N) * comb_size] = f;
+        wp = (wp + 1) & (comb_size - 1);
+    }
+
+    /*
+     * Write n samples at once. Runs are copied straight into the buffer and the mirrored
+     * guard region past comb_size is updated once per run rather than checked per sample.
      */
-    SSESincDelayLine(const tables::SurgeSincTableProvider &st) : sinctable(st.sinctable)
+    inline void writeBlock(const float *in, int n)
     {
-        clear();
+        int done = 0;
+        while (done < n)
+        {
+            auto chunk = std::min(n - done, comb_size - wp);
+            memcpy(&buffer[wp], in + done, chunk * sizeof(float));
+            if (wp < stp::FIRipol_N)
+            {
+                auto guard = std::min(chunk, stp::FIRipol_N - wp);
+                memcpy(&buffer[wp + comb_size], in + done, guard * sizeof(float));
+            }
+            wp = (wp + chunk) & (comb_size - 1);
+            done += chunk;
+        }
     }
 
-    inline void write(float f)
+    inline float read(float delay) { return readBehind(delay, 0); }
+
+    /*
+     * Read n modulated taps after a writeBlock of n samples, so that out[i] is what
+     * read(delays[i]) gives in the per sample loop { write(in[i]); out[i] = read(delays[i]); }.
+     * The index and table offset math is done for four taps at a time in SSE, and the four
+     * taps' products are transposed so a column add replaces the four horizontal sums.
+     * delays[i] + n must stay within comb_size - FIRipol_N.
+     */
+    inline void readBlock(const float *delays, float *out, int n)
     {
-        buffer[wp] = f;
-        buffer[wp + (wp < stp::FIRipol_N) * COMB_SIZE] = f;
-        wp = (wp + 1) & (COMB_SIZE - 1);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            // sample i + k was written n - 1 - i - k samples before the current wp
+            auto behind = _mm_sub_epi32(_mm_set1_epi32(n - 1 - i), _mm_setr_epi32(0, 1, 2, 3));
+            readFourBehind(delays + i, behind, out + i);
+        }
+        for (; i < n; ++i)
+            out[i] = readBehind(delays[i], n - 1 - i);
+    }
+
+    /*
+     * Read K independent taps from the current write position in one call; out[k] is
+     * read(delays[k]). Multitaps and reverbs can share one buffer and write pointer this way
+     * rather than keeping a delay line per tap.
+     */
+    inline void readTaps(const float *delays, float *out, int K)
+    {
+        auto none = _mm_setzero_si128();
+        int k = 0;
+        for (; k + 4 <= K; k += 4)
+            readFourBehind(delays + k, none, out + k);
+        for (; k < K; ++k)
+            out[k] = readBehind(delays[k], 0);
+    }
+
+    inline void readFourBehind(const float *delays, __m128i behind, float *out)
+    {
+        const auto mask = _mm_set1_epi32(comb_size - 1);
+        const auto firM = _mm_set1_ps((float)stp::FIRipol_M);
+
+        auto d = _mm_loadu_ps(delays);
+        auto id = _mm_cvttps_epi32(d);
+        auto frac = _mm_sub_ps(d, _mm_cvtepi32_ps(id));
+        auto sto = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), frac), firM));
+
+        auto rp = _mm_sub_epi32(_mm_set1_epi32(wp - (stp::FIRipol_N >> 1)),
+                                _mm_add_epi32(id, behind));
+        rp = _mm_and_si128(rp, mask);
+
+        int readPtr alignas(16)[4], sincOff alignas(16)[4];
+        _mm_store_si128((__m128i *)readPtr, rp);
+        _mm_store_si128((__m128i *)sincOff, sto);
+
+        __m128 o[4];
+        for (int k = 0; k < 4; ++k)
+            o[k] = tapProducts(readPtr[k], sincOff[k] * stp::FIRipol_N * 2);
+
+        _MM_TRANSPOSE4_PS(o[0], o[1], o[2], o[3]);
+        _mm_storeu_ps(out, _mm_add_ps(_mm_add_ps(o[0], o[2]), _mm_add_ps(o[1], o[3])));
     }
 
-    inline float read(float delay)
+    // read(delay) with an extra whole number of samples of delay
+    inline float readBehind(float delay, int extra)
     {
         auto iDelay = (int)delay;
         auto fracDelay = delay - iDelay;
@@ -77,9 +170,18 @@ struct SSESincDelayLine
         // So basically we interpolate around stp::FIRipol_N (the 12 sample sinc)
         // remembering that stp::FIRoffset is the offset to center your table at
         // a point ( it is stp::FIRipol_N >> 1)
-        int readPtr = (wp - iDelay - (stp::FIRipol_N >> 1)) & (COMB_SIZE - 1);
+        int readPtr = (wp - iDelay - extra - (stp::FIRipol_N >> 1)) & (comb_size - 1);
+
+        float res;
+        auto o = tapProducts(readPtr, sincTableOffset);
+        _mm_store_ss(&res, sst::basic_blocks::mechanics::sum_ps_to_ss(o));
+
+        return res;
+    }
 
-        // And so now do what we do in COMBSSE2Quad
+    // what we do in COMBSSE2Quad: the 12 tap products, folded to one quad
+    inline __m128 tapProducts(int readPtr, int sincTableOffset) const
+    {
         __m128 a = _mm_loadu_ps(&buffer[readPtr]);
         __m128 b = _mm_loadu_ps(&sinctable[sincTableOffset]);
         __m128 o = _mm_mul_ps(a, b);
@@ -91,35 +193,100 @@ struct SSESincDelayLine
         a = _mm_loadu_ps(&buffer[readPtr + 8]);
         b = _mm_loadu_ps(&sinctable[sincTableOffset + 8]);
         o = _mm_add_ps(o, _mm_mul_ps(a, b));
-
-        float res;
-        _mm_store_ss(&res, sst::basic_blocks::mechanics::sum_ps_to_ss(o));
-
-        return res;
+        return o;
     }
 
     inline float readLinear(float delay)
     {
         auto iDelay = (int)delay;
         auto frac = delay - iDelay;
-        int RP = (wp - iDelay) & (COMB_SIZE - 1);
-        int RPP = RP == 0 ? COMB_SIZE - 1 : RP - 1;
+        int RP = (wp - iDelay) & (comb_size - 1);
+        int RPP = RP == 0 ? comb_size - 1 : RP - 1;
         return buffer[RP] * (1 - frac) + buffer[RPP] * frac;
     }
 
     inline float readZOH(float delay)
     {
         auto iDelay = (int)delay;
-        int RP = (wp - iDelay) & (COMB_SIZE - 1);
-        int RPP = RP == 0 ? COMB_SIZE - 1 : RP - 1;
+        int RP = (wp - iDelay) & (comb_size - 1);
+        int RPP = RP == 0 ? comb_size - 1 : RP - 1;
         return buffer[RPP];
     }
 
     inline void clear()
     {
-        memset((void *)buffer, 0, (COMB_SIZE + stp::FIRipol_N) * sizeof(float));
+        memset((void *)buffer, 0, (comb_size + stp::FIRipol_N) * sizeof(float));
+        wp = 0;
+    }
+};
+
+/*
+ * This is a template class which encapsulates the SSE based SINC
+ * interpolation in COMBquad_SSE2,just made available for other uses
+ */
+template <int COMB_SIZE> // power of two
+struct SSESincDelayLine : SSESincDelayLineImpl<detail::SSESincDelayLineInlineStorage<COMB_SIZE>>
+{
+    using base_t = SSESincDelayLineImpl<detail::SSESincDelayLineInlineStorage<COMB_SIZE>>;
+
+    SSESincDelayLine(const float *st) : base_t(st) { this->clear(); }
+
+    /**
+     * If you ahve a long lived instance of a SurgeSincTableProvider you can initialize with that
+     * but please make sure that table has lifetime longer than this interpolator, since we take the
+     * pointer address of its table
+     */
+    SSESincDelayLine(const tables::SurgeSincTableProvider &st) : base_t(st.sinctable)
+    {
+        this->clear();
+    }
+};
+
+/*
+ * An SSESincDelayLine whose power of two size is picked at runtime and whose buffer lives in
+ * memory the caller owns, typically a mechanics::MemoryArena reserved for a whole effect chain
+ * at load time. Nothing here allocates, so lines can be attached and swapped on the audio
+ * thread. Until attach (or allocateFrom) succeeds the line has no buffer and must not be used.
+ */
+struct SSESincDelayLineRuntime : SSESincDelayLineImpl<detail::SSESincDelayLineExternalStorage>
+{
+    using base_t = SSESincDelayLineImpl<detail::SSESincDelayLineExternalStorage>;
+
+    SSESincDelayLineRuntime(const float *st) : base_t(st) {}
+    SSESincDelayLineRuntime(const tables::SurgeSincTableProvider &st) : base_t(st.sinctable) {}
+
+    static constexpr size_t bytesRequired(int size)
+    {
+        return (size + stp::FIRipol_N) * sizeof(float);
+    }
+
+    // mem needs 16 byte alignment and bytesRequired(size) bytes, and size a power of two
+    void attach(float *mem, int size)
+    {
+        assert(size > 0 && !(size & (size - 1)));
+        assert(((uintptr_t)mem & 15) == 0);
+        buffer = mem;
+        comb_size = size;
+        clear();
+    }
+
+    template <typename Arena> bool allocateFrom(Arena &arena, int size)
+    {
+        auto mem = arena.allocate(bytesRequired(size), 16);
+        if (!mem)
+            return false;
+        attach(static_cast<float *>(mem), size);
+        return true;
+    }
+
+    void detach()
+    {
+        buffer = nullptr;
+        comb_size = 0;
         wp = 0;
     }
+
+    bool isAttached() const { return buffer != nullptr; }
 };
 } // namespace sst::basic_blocks::dsp
 #endif // SURGE_SSESINCDELAYLINE_H
@@ -0,0 +1,154 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_DSP_SSESINCDELAYLINEINTERLEAVED_H
+#define INCLUDE_SST_BASIC_BLOCKS_DSP_SSESINCDELAYLINEINTERLEAVED_H
+
+#include <cstring>
+#include "sst/basic-blocks/tables/SincTableProvider.h"
+
+namespace sst::basic_blocks::dsp
+{
+
+/*
+ * A 2 or 4 channel SSESincDelayLine with the channels interleaved frame by frame, so one
+ * read fetches the sinc row once and applies it to every channel. Each channel gives the
+ * same result, bit for bit, as a mono SSESincDelayLine fed that channel.
+ */
+template <int COMB_SIZE, int nChannels = 2> // power of two
+struct SSESincDelayLineInterleaved
+{
+    static_assert(!(COMB_SIZE & (COMB_SIZE - 1))); // make sure we are a power of 2
+    static_assert(nChannels == 2 || nChannels == 4);
+    static constexpr int comb_size = COMB_SIZE;
+    static constexpr int channels = nChannels;
+
+    using stp = tables::SurgeSincTableProvider;
+
+    float buffer alignas(16)[(COMB_SIZE + stp::FIRipol_N) * nChannels];
+    int wp = 0;
+
+    const float *sinctable{nullptr}; // a pointer copy of the storage member
+    SSESincDelayLineInterleaved(const float *st) : sinctable(st) { clear(); }
+    SSESincDelayLineInterleaved(const tables::SurgeSincTableProvider &st)
+        : sinctable(st.sinctable)
+    {
+        clear();
+    }
+
+    inline void write(const float *frame)
+    {
+        memcpy(&buffer[wp * nChannels], frame, nChannels * sizeof(float));
+        if (wp < stp::FIRipol_N)
+            memcpy(&buffer[(wp + COMB_SIZE) * nChannels], frame, nChannels * sizeof(float));
+        wp = (wp + 1) & (COMB_SIZE - 1);
+    }
+
+    inline void write(float L, float R)
+    {
+        static_assert(nChannels == 2);
+        float f[2]{L, R};
+        write(f);
+    }
+
+    inline void read(float delay, float *out)
+    {
+        auto iDelay = (int)delay;
+        auto fracDelay = delay - iDelay;
+        auto sincTableOffset = (int)((1 - fracDelay) * stp::FIRipol_M) * stp::FIRipol_N * 2;
+        int readPtr = (wp - iDelay - (stp::FIRipol_N >> 1)) & (COMB_SIZE - 1);
+
+        const float *b = &buffer[readPtr * nChannels];
+        const float *s = &sinctable[sincTableOffset];
+
+        /*
+         * Accumulate in the same order as the mono line, o_j = (t_j + t_j+4) + t_j+8 then
+         * (o_0 + o_2) + (o_1 + o_3), only with every channel in a lane of its own.
+         */
+        __m128 q[3] = {_mm_loadu_ps(s), _mm_loadu_ps(s + 4), _mm_loadu_ps(s + 8)};
+        __m128 r;
+        if constexpr (nChannels == 4)
+        {
+            __m128 o[4];
+#define SPLAT(q, j) _mm_shuffle_ps(q, q, _MM_SHUFFLE(j, j, j, j))
+            o[0] = _mm_mul_ps(_mm_loadu_ps(b), SPLAT(q[0], 0));
+            o[1] = _mm_mul_ps(_mm_loadu_ps(b + 4), SPLAT(q[0], 1));
+            o[2] = _mm_mul_ps(_mm_loadu_ps(b + 8), SPLAT(q[0], 2));
+            o[3] = _mm_mul_ps(_mm_loadu_ps(b + 12), SPLAT(q[0], 3));
+            for (int h = 1; h < 3; ++h)
+            {
+                auto bh = b + 16 * h;
+                o[0] = _mm_add_ps(o[0], _mm_mul_ps(_mm_loadu_ps(bh), SPLAT(q[h], 0)));
+                o[1] = _mm_add_ps(o[1], _mm_mul_ps(_mm_loadu_ps(bh + 4), SPLAT(q[h], 1)));
+                o[2] = _mm_add_ps(o[2], _mm_mul_ps(_mm_loadu_ps(bh + 8), SPLAT(q[h], 2)));
+                o[3] = _mm_add_ps(o[3], _mm_mul_ps(_mm_loadu_ps(bh + 12), SPLAT(q[h], 3)));
+            }
+#undef SPLAT
+            r = _mm_add_ps(_mm_add_ps(o[0], o[2]), _mm_add_ps(o[1], o[3]));
+        }
+        else
+        {
+            // lo holds taps j = 0, 1 and hi taps j = 2, 3 as L R L R pairs
+            auto lo = _mm_mul_ps(_mm_loadu_ps(b), _mm_unpacklo_ps(q[0], q[0]));
+            auto hi = _mm_mul_ps(_mm_loadu_ps(b + 4), _mm_unpackhi_ps(q[0], q[0]));
+            for (int h = 1; h < 3; ++h)
+            {
+                auto bh = b + 8 * h;
+                lo = _mm_add_ps(lo, _mm_mul_ps(_mm_loadu_ps(bh), _mm_unpacklo_ps(q[h], q[h])));
+                hi = _mm_add_ps(hi,
+                                _mm_mul_ps(_mm_loadu_ps(bh + 4), _mm_unpackhi_ps(q[h], q[h])));
+            }
+            auto sm = _mm_add_ps(lo, hi);
+            r = _mm_add_ps(sm, _mm_movehl_ps(sm, sm));
+        }
+
+        if constexpr (nChannels == 4)
+        {
+            _mm_storeu_ps(out, r);
+        }
+        else
+        {
+            _mm_storel_pi((__m64 *)out, r);
+        }
+    }
+
+    inline void read(float delay, float &L, float &R)
+    {
+        static_assert(nChannels == 2);
+        float f[2];
+        read(delay, f);
+        L = f[0];
+        R = f[1];
+    }
+
+    inline void clear()
+    {
+        memset((void *)buffer, 0, (COMB_SIZE + stp::FIRipol_N) * nChannels * sizeof(float));
+        wp = 0;
+    }
+};
+} // namespace sst::basic_blocks::dsp
+#endif // INCLUDE_SST_BASIC_BLOCKS_DSP_SSESINCDELAYLINEINTERLEAVED_H
@@ -28,20 +28,79 @@
 #define INCLUDE_SST_BASIC_BLOCKS_DSP_VUPEAK_H
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
 
 namespace sst::basic_blocks::dsp
 {
-struct VUPeak
+/*
+ * A single writer, many reader snapshot of N meter values. The audio thread publishes; any
+ * number of UI threads poll with read or tryRead and always see one whole publish, never a
+ * mix of two. It is a seqlock: the sequence is odd while a publish is in flight and readers
+ * retry if it was odd or moved during their copy. The sequence and the values each sit on
+ * their own cache lines, apart from whatever the audio thread works on, so polling readers
+ * don't bounce the lines the writer is using between publishes.
+ */
+template <size_t N> struct VUPeakSnapshot
 {
+    static constexpr size_t cacheLine{64};
+
+    alignas(cacheLine) std::atomic<uint32_t> seq{0};
+    alignas(cacheLine) std::atomic<float> values[N];
+
+    VUPeakSnapshot()
+    {
+        for (auto &v : values)
+            v.store(0.f, std::memory_order_relaxed);
+    }
+
+    // audio thread only
+    void publish(const float *v)
+    {
+        auto s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < N; ++i)
+            values[i].store(v[i], std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // one attempt at a consistent copy; false if a publish got in the way
+    bool tryRead(float *out) const
+    {
+        auto s0 = seq.load(std::memory_order_acquire);
+        if (s0 & 1)
+            return false;
+        for (size_t i = 0; i < N; ++i)
+            out[i] = values[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return seq.load(std::memory_order_relaxed) == s0;
+    }
+
+    void read(float *out) const
+    {
+        while (!tryRead(out))
+        {
+        }
+    }
+};
+
+/*
+ * The VU ballistics of VUPeak for N channels. The per block peak of each channel comes from
+ * blockAbsMax and the falloff and clamp run across channels four at a time.
+ */
+template <size_t N> struct VUPeakN
+{
+    static constexpr size_t nChannels{N};
+
     float sampleRate{0};
     float falloff{1};
 
-    float vu_peak[2]{0, 0};
+    float vu_peak[N]{};
 
-    explicit VUPeak() {}
     void setSampleRate(float sr)
     {
         sampleRate = sr;
@@ -56,6 +115,51 @@ struct VUPeak
         falloff = (float)std::exp(-2 * M_PI * (60.f / sampleRate));
     }
 
+    // one frame, frame[c] being channel c
+    void processFrame(const float *frame) { update(frame, true); }
+
+    // one block, channels[c] being BLOCK_SIZE samples of channel c
+    template <int BLOCK_SIZE> void processBlock(const float *const *channels)
+    {
+        namespace mech = sst::basic_blocks::mechanics;
+        float peaks[N];
+        for (size_t c = 0; c < N; ++c)
+            peaks[c] = mech::blockAbsMax<BLOCK_SIZE>(channels[c]);
+        update(peaks, false);
+    }
+
+    template <typename Snapshot> void publish(Snapshot &to) const
+    {
+        static_assert(sizeof(to.values) / sizeof(to.values[0]) == N);
+        to.publish(vu_peak);
+    }
+
+  protected:
+    void update(const float *x, bool takeAbs)
+    {
+        const auto fo = _mm_set1_ps(falloff), two = _mm_set1_ps(2.f);
+        const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        size_t c = 0;
+        for (; c + 4 <= N; c += 4)
+        {
+            auto v = _mm_min_ps(two, _mm_mul_ps(fo, _mm_loadu_ps(vu_peak + c)));
+            auto in = _mm_loadu_ps(x + c);
+            if (takeAbs)
+                in = _mm_and_ps(in, absMask);
+            _mm_storeu_ps(vu_peak + c, _mm_max_ps(v, in));
+        }
+        for (; c < N; ++c)
+        {
+            vu_peak[c] = std::min(2.f, falloff * vu_peak[c]);
+            vu_peak[c] = std::max(vu_peak[c], takeAbs ? std::fabs(x[c]) : x[c]);
+        }
+    }
+};
+
+struct VUPeak : VUPeakN<2>
+{
+    explicit VUPeak() {}
+
     void process(float L, float R)
     {
         vu_peak[0] = std::min(2.f, falloff * vu_peak[0]);
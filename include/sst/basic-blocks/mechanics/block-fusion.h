@@ -0,0 +1,173 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MECHANICS_BLOCK_FUSION_H
+#define INCLUDE_SST_BASIC_BLOCKS_MECHANICS_BLOCK_FUSION_H
+
+/*
+ * Fused block operations. A chain like
+ *
+ *   fuse<blockSize>(in).mul(env).scale(gain).shape(dsp::softclip_shaper{}).accumulate_to(out);
+ *
+ * does the same arithmetic as mul_block, scale_by, softclip_block and accumulate_from_to
+ * called one after another, but in a single SIMD pass: each register is loaded once, run
+ * through every stage and stored once. The chain is built at compile time as a list of
+ * stage types and nothing happens until a terminal (store_to, accumulate_to) is called.
+ * shape() takes any functor on a register and on a float; dsp/Clippers.h has the clippers.
+ */
+
+#include <tuple>
+#include "block-ops.h"
+
+namespace sst::basic_blocks::mechanics
+{
+namespace detail
+{
+/*
+ * Each stage maps a register at block offset i, and a single float for the scalar tail of
+ * blocks which are not a whole number of registers.
+ */
+struct fuse_mul_stage
+{
+    const float *by;
+    block_simd::reg_t apply(block_simd::reg_t x, size_t i) const
+    {
+        return block_simd::mul(x, block_simd::load<false>(by + i));
+    }
+    float apply(float x, size_t i) const { return x * by[i]; }
+};
+
+struct fuse_add_stage
+{
+    const float *other;
+    block_simd::reg_t apply(block_simd::reg_t x, size_t i) const
+    {
+        return block_simd::add(x, block_simd::load<false>(other + i));
+    }
+    float apply(float x, size_t i) const { return x + other[i]; }
+};
+
+struct fuse_scale_stage
+{
+    float scale;
+    block_simd::reg_t apply(block_simd::reg_t x, size_t) const
+    {
+        return block_simd::mul(x, block_simd::set1(scale));
+    }
+    float apply(float x, size_t) const { return x * scale; }
+};
+
+struct fuse_hardclip_stage
+{
+    float limit;
+    block_simd::reg_t apply(block_simd::reg_t x, size_t) const
+    {
+        return block_simd::max(block_simd::min(x, block_simd::set1(limit)),
+                               block_simd::set1(-limit));
+    }
+    float apply(float x, size_t) const { return std::max(std::min(x, limit), -limit); }
+};
+
+template <typename F> struct fuse_shape_stage
+{
+    F shaper;
+    block_simd::reg_t apply(block_simd::reg_t x, size_t) const { return shaper(x); }
+    float apply(float x, size_t) const { return shaper(x); }
+};
+} // namespace detail
+
+template <size_t N, typename... Stages> struct fused_block
+{
+    const float *src;
+    std::tuple<Stages...> stages;
+
+    template <typename Stage> fused_block<N, Stages..., Stage> then(Stage s) const
+    {
+        return {src, std::tuple_cat(stages, std::make_tuple(s))};
+    }
+
+    // x * by[i]
+    auto mul(const float *by) const { return then(detail::fuse_mul_stage{by}); }
+    // x + other[i]
+    auto add(const float *other) const { return then(detail::fuse_add_stage{other}); }
+    // x * scale
+    auto scale(float s) const { return then(detail::fuse_scale_stage{s}); }
+    // clamp to +/- limit, as hardclip_block does for 1
+    auto hardclip(float limit = 1.f) const { return then(detail::fuse_hardclip_stage{limit}); }
+    // f(x), with f callable on a register and on a float, as dsp::softclip_shaper is
+    template <typename F> auto shape(F f) const { return then(detail::fuse_shape_stage<F>{f}); }
+
+    // out[i] = chain(in[i])
+    void store_to(float *out) const
+    {
+        run([out](size_t i, auto x) { storeAt(out, i, x); });
+    }
+
+    // out[i] += chain(in[i])
+    void accumulate_to(float *out) const
+    {
+        run([out](size_t i, auto x) { storeAt(out, i, sum(loadAt(out, i, x), x)); });
+    }
+
+  private:
+    template <typename T> T applyStages(T x, size_t i) const
+    {
+        std::apply([&](const auto &...s) { ((x = s.apply(x, i)), ...); }, stages);
+        return x;
+    }
+
+    template <typename Sink> void run(Sink &&sink) const
+    {
+        detail::for_each_register<N>([&](size_t i) {
+            sink(i, applyStages(detail::block_simd::load<false>(src + i), i));
+        });
+        for (auto i = detail::block_simd::tail<N>; i < N; ++i)
+            sink(i, applyStages(src[i], i));
+    }
+
+    // register and float forms so one sink lambda serves the loop and the tail
+    static detail::block_simd::reg_t loadAt(const float *p, size_t i, detail::block_simd::reg_t)
+    {
+        return detail::block_simd::load<false>(p + i);
+    }
+    static float loadAt(const float *p, size_t i, float) { return p[i]; }
+    static void storeAt(float *p, size_t i, detail::block_simd::reg_t x)
+    {
+        detail::block_simd::store<false>(p + i, x);
+    }
+    static void storeAt(float *p, size_t i, float x) { p[i] = x; }
+    static detail::block_simd::reg_t sum(detail::block_simd::reg_t a, detail::block_simd::reg_t b)
+    {
+        return detail::block_simd::add(a, b);
+    }
+    static float sum(float a, float b) { return a + b; }
+};
+
+template <size_t N> fused_block<N> fuse(const float *in) { return {in, {}}; }
+
+} // namespace sst::basic_blocks::mechanics
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MECHANICS_BLOCK_FUSION_H
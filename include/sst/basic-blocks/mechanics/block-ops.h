@@ -30,160 +30,362 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <utility>
 
 #include "simd-ops.h"
 
 namespace sst::basic_blocks::mechanics
 {
 
+/*
+ * A block of N values with the alignment the SIMD paths below want (32 bytes covers both
+ * SSE and AVX). It converts to a plain pointer so it works with every function here, and
+ * the overloads which take aligned_block directly use aligned loads and stores.
+ */
+template <typename T, size_t N> struct alignas(32) aligned_block
+{
+    static constexpr size_t size{N};
+    T data[N];
+
+    T &operator[](size_t i) { return data[i]; }
+    const T &operator[](size_t i) const { return data[i]; }
+    operator T *() { return data; }
+    operator const T *() const { return data; }
+};
+
+namespace detail
+{
+/*
+ * The register type the block functions are written against: __m256 when the target has AVX,
+ * __m128 otherwise. The explicit code keeps MSVC, which leaves the plain loops scalar, on
+ * the same footing as gcc and clang.
+ */
+struct block_simd
+{
+#if SST_BASIC_BLOCKS_AVX
+    using reg_t = __m256;
+    static constexpr size_t width{8};
+
+    template <bool aligned> static reg_t load(const float *p)
+    {
+        if constexpr (aligned)
+            return _mm256_load_ps(p);
+        else
+            return _mm256_loadu_ps(p);
+    }
+    template <bool aligned> static void store(float *p, reg_t v)
+    {
+        if constexpr (aligned)
+            _mm256_store_ps(p, v);
+        else
+            _mm256_storeu_ps(p, v);
+    }
+    static reg_t set1(float f) { return _mm256_set1_ps(f); }
+    static reg_t zero() { return _mm256_setzero_ps(); }
+    static reg_t add(reg_t a, reg_t b) { return _mm256_add_ps(a, b); }
+    static reg_t mul(reg_t a, reg_t b) { return _mm256_mul_ps(a, b); }
+    static reg_t max(reg_t a, reg_t b) { return _mm256_max_ps(a, b); }
+    static reg_t min(reg_t a, reg_t b) { return _mm256_min_ps(a, b); }
+    static reg_t abs(reg_t a) { return abs_ps(a); }
+    static float hmax(reg_t a)
+    {
+        auto m = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 0, 1)));
+        return _mm_cvtss_f32(m);
+    }
+#else
+    using reg_t = __m128;
+    static constexpr size_t width{4};
+
+    template <bool aligned> static reg_t load(const float *p)
+    {
+        if constexpr (aligned)
+            return _mm_load_ps(p);
+        else
+            return _mm_loadu_ps(p);
+    }
+    template <bool aligned> static void store(float *p, reg_t v)
+    {
+        if constexpr (aligned)
+            _mm_store_ps(p, v);
+        else
+            _mm_storeu_ps(p, v);
+    }
+    static reg_t set1(float f) { return _mm_set1_ps(f); }
+    static reg_t zero() { return _mm_setzero_ps(); }
+    static reg_t add(reg_t a, reg_t b) { return _mm_add_ps(a, b); }
+    static reg_t mul(reg_t a, reg_t b) { return _mm_mul_ps(a, b); }
+    static reg_t max(reg_t a, reg_t b) { return _mm_max_ps(a, b); }
+    static reg_t min(reg_t a, reg_t b) { return _mm_min_ps(a, b); }
+    static reg_t abs(reg_t a) { return abs_ps(a); }
+    static float hmax(reg_t m)
+    {
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 0, 1)));
+        return _mm_cvtss_f32(m);
+    }
+#endif
+
+    // where the scalar tail starts for a block of N
+    template <size_t N> static constexpr size_t tail{N - N % width};
+};
+
+template <typename F, size_t... I> inline void unroll_registers(F &&f, std::index_sequence<I...>)
+{
+    (f(I * block_simd::width), ...);
+}
+
+// Call f(offset) for each whole register in a block of N, fully unrolled for short blocks
+template <size_t N, typename F> inline void for_each_register(F &&f)
+{
+    constexpr auto nRegisters = N / block_simd::width;
+    if constexpr (nRegisters <= 16)
+    {
+        unroll_registers(f, std::make_index_sequence<nRegisters>());
+    }
+    else
+    {
+        for (size_t i = 0; i < nRegisters * block_simd::width; i += block_simd::width)
+            f(i);
+    }
+}
+
+template <size_t N, bool aligned>
+inline void accumulate_from_to(const float *__restrict src, float *__restrict dst)
+{
+    using V = block_simd;
+    for_each_register<N>([&](size_t i) {
+        V::store<aligned>(dst + i, V::add(V::load<aligned>(dst + i), V::load<aligned>(src + i)));
+    });
+    for (auto i = V::tail<N>; i < N; ++i)
+        dst[i] += src[i];
+}
+
+template <size_t N, bool aligned>
+inline void scale_accumulate_from_to(const float *__restrict src, float scale,
+                                     float *__restrict dst)
+{
+    using V = block_simd;
+    auto sc = V::set1(scale);
+    for_each_register<N>([&](size_t i) {
+        auto p = V::mul(V::load<aligned>(src + i), sc);
+        V::store<aligned>(dst + i, V::add(V::load<aligned>(dst + i), p));
+    });
+    for (auto i = V::tail<N>; i < N; ++i)
+        dst[i] += src[i] * scale;
+}
+
+template <size_t N, bool aligned>
+inline void add_block(const float *__restrict src1, const float *__restrict src2,
+                      float *__restrict dst)
+{
+    using V = block_simd;
+    for_each_register<N>([&](size_t i) {
+        V::store<aligned>(dst + i, V::add(V::load<aligned>(src1 + i), V::load<aligned>(src2 + i)));
+    });
+    for (auto i = V::tail<N>; i < N; ++i)
+        dst[i] = src1[i] + src2[i];
+}
+
+// dst may alias src1, which is how the in place forms use this
+template <size_t N, bool aligned>
+inline void mul_block(const float *src1, const float *__restrict src2, float *dst)
+{
+    using V = block_simd;
+    for_each_register<N>([&](size_t i) {
+        V::store<aligned>(dst + i, V::mul(V::load<aligned>(src1 + i), V::load<aligned>(src2 + i)));
+    });
+    for (auto i = V::tail<N>; i < N; ++i)
+        dst[i] = src1[i] * src2[i];
+}
+
+template <size_t N, bool aligned> inline void mul_block(const float *src, float scalar, float *dst)
+{
+    using V = block_simd;
+    auto sc = V::set1(scalar);
+    for_each_register<N>(
+        [&](size_t i) { V::store<aligned>(dst + i, V::mul(V::load<aligned>(src + i), sc)); });
+    for (auto i = V::tail<N>; i < N; ++i)
+        dst[i] = src[i] * scalar;
+}
+
+template <size_t N, bool aligned> inline float blockAbsMax(const float *__restrict d)
+{
+    using V = block_simd;
+    auto mx = V::zero();
+    for_each_register<N>([&](size_t i) { mx = V::max(mx, V::abs(V::load<aligned>(d + i))); });
+    auto r = V::hmax(mx);
+    for (auto i = V::tail<N>; i < N; ++i)
+        r = std::max(r, std::fabs(d[i]));
+    return r;
+}
+} // namespace detail
+
 template <size_t blocksize> inline void clear_block(float *__restrict f)
 {
     memset(f, 0, blocksize * sizeof(float));
 }
-// I checked these with clang / godbolt and they output the same SIMD I would code by hand
-// once you add the __restrict keyword
+
 template <size_t blocksize>
 inline void accumulate_from_to(const float *__restrict src, float *__restrict dst)
 {
-    for (auto i = 0U; i < blocksize; ++i)
-        dst[i] += src[i];
+    detail::accumulate_from_to<blocksize, false>(src, dst);
 }
 
 template <size_t blocksize>
 inline void scale_accumulate_from_to(const float *__restrict src, float scale,
                                      float *__restrict dst)
 {
-    for (auto i = 0U; i < blocksize; ++i)
-        dst[i] += src[i] * scale;
+    detail::scale_accumulate_from_to<blocksize, false>(src, scale, dst);
 }
 
 template <size_t blocksize>
 inline void scale_accumulate_from_to(const float *__restrict srcL, float *__restrict srcR,
                                      float scale, float *__restrict dstL, float *__restrict dstR)
 {
-    for (auto i = 0U; i < blocksize; ++i)
-    {
-        dstR[i] += srcR[i] * scale;
-        dstL[i] += srcL[i] * scale;
-    }
+    detail::scale_accumulate_from_to<blocksize, false>(srcL, scale, dstL);
+    detail::scale_accumulate_from_to<blocksize, false>(srcR, scale, dstR);
 }
 
 template <size_t blocksize>
 inline void copy_from_to(const float *__restrict src, float *__restrict dst)
 {
-    for (auto i = 0U; i < blocksize; ++i)
-        dst[i] = src[i];
+    memcpy(dst, src, blocksize * sizeof(float));
 }
 
 template <size_t blocksize>
 inline void add_block(const float *__restrict src1, const float *__restrict src2,
                       float *__restrict dst)
 {
-    for (auto i = 0U; i < blocksize; ++i)
-    {
-        dst[i] = src1[i] + src2[i];
-    }
+    detail::add_block<blocksize, false>(src1, src2, dst);
 }
 
 template <size_t blocksize>
 inline void add_block(float *__restrict srcdst, const float *__restrict src2)
 {
-    for (auto i = 0U; i < blocksize; ++i)
-    {
-        srcdst[i] = srcdst[i] + src2[i];
-    }
+    detail::accumulate_from_to<blocksize, false>(src2, srcdst);
 }
 
 template <size_t blockSize>
 inline void mul_block(float *__restrict src1, float *src2, float *__restrict dst)
 {
-    for (auto i = 0U; i < blockSize; ++i)
-    {
-        dst[i] = src1[i] * src2[i];
-    }
+    detail::mul_block<blockSize, false>(src1, src2, dst);
 }
 
 template <size_t blockSize>
 inline void mul_block(float *__restrict src1, float scalar, float *__restrict dst)
 {
-    for (auto i = 0U; i < blockSize; ++i)
-    {
-        dst[i] = src1[i] * scalar;
-    }
+    detail::mul_block<blockSize, false>(src1, scalar, dst);
 }
 
 template <size_t blockSize> inline void mul_block(float *__restrict srcDst, float *__restrict by)
 {
-    for (auto i = 0U; i < blockSize; ++i)
-    {
-        srcDst[i] = srcDst[i] * by[i];
-    }
+    detail::mul_block<blockSize, false>(srcDst, by, srcDst);
 }
 
 template <size_t blockSize> inline void mul_block(float *__restrict srcDst, float by)
 {
-    for (auto i = 0U; i < blockSize; ++i)
-    {
-        srcDst[i] = srcDst[i] * by;
-    }
+    detail::mul_block<blockSize, false>(srcDst, by, srcDst);
 }
 
 template <size_t blockSize>
 inline void scale_by(const float *__restrict scale, float *__restrict target)
 {
-    for (auto i = 0U; i < blockSize; ++i)
-        target[i] *= scale[i];
+    detail::mul_block<blockSize, false>(target, scale, target);
 }
 
 template <size_t blockSize>
 inline void scale_by(const float *__restrict scale, float *__restrict targetL,
                      float *__restrict targetR)
 {
-    for (auto i = 0U; i < blockSize; ++i)
-    {
-        targetL[i] *= scale[i];
-        targetR[i] *= scale[i];
-    }
+    detail::mul_block<blockSize, false>(targetL, scale, targetL);
+    detail::mul_block<blockSize, false>(targetR, scale, targetR);
 }
 
 template <size_t blockSize> inline void scale_by(const float scale, float *__restrict target)
 {
-    for (auto i = 0U; i < blockSize; ++i)
-    {
-        target[i] *= scale;
-    }
+    detail::mul_block<blockSize, false>(target, scale, target);
 }
 
 template <size_t blockSize>
 inline void scale_by(const float scale, float *__restrict targetL, float *__restrict targetR)
 {
-    for (auto i = 0U; i < blockSize; ++i)
-    {
-        targetL[i] *= scale;
-        targetR[i] *= scale;
-    }
+    detail::mul_block<blockSize, false>(targetL, scale, targetL);
+    detail::mul_block<blockSize, false>(targetR, scale, targetR);
 }
 
 template <size_t blockSize> inline float blockAbsMax(const float *__restrict d)
 {
-#if 0
-    // Note there used to be a SIMD version of this
-    auto r = 0.f;
-    for (auto i=0U; i<blockSize; ++i)
-        r = std::max(r, std::fabs(d[i]));
-#else
-    __m128 mx = _mm_setzero_ps();
+    return detail::blockAbsMax<blockSize, false>(d);
+}
 
-    for (unsigned int i = 0; i < blockSize >> 2; i++)
-    {
-        mx = _mm_max_ps(mx, _mm_and_ps(((__m128 *)d)[i], m128_mask_absval));
-    }
+/*
+ * The aligned_block forms. The block size is deduced from the type and the loads and stores
+ * are the aligned kind, which is the contract the type carries.
+ */
+template <size_t N> inline void clear_block(aligned_block<float, N> &f) { clear_block<N>(f.data); }
 
-    float r alignas(16)[4];
-    _mm_store_ps(r, mx);
+template <size_t N>
+inline void accumulate_from_to(const aligned_block<float, N> &src, aligned_block<float, N> &dst)
+{
+    detail::accumulate_from_to<N, true>(src.data, dst.data);
+}
 
-    return std::max({r[0], r[1], r[2], r[3]});
-#endif
+template <size_t N>
+inline void scale_accumulate_from_to(const aligned_block<float, N> &src, float scale,
+                                     aligned_block<float, N> &dst)
+{
+    detail::scale_accumulate_from_to<N, true>(src.data, scale, dst.data);
+}
+
+template <size_t N>
+inline void copy_from_to(const aligned_block<float, N> &src, aligned_block<float, N> &dst)
+{
+    copy_from_to<N>(src.data, dst.data);
+}
+
+template <size_t N>
+inline void add_block(const aligned_block<float, N> &src1, const aligned_block<float, N> &src2,
+                      aligned_block<float, N> &dst)
+{
+    detail::add_block<N, true>(src1.data, src2.data, dst.data);
+}
+
+template <size_t N>
+inline void add_block(aligned_block<float, N> &srcdst, const aligned_block<float, N> &src2)
+{
+    detail::accumulate_from_to<N, true>(src2.data, srcdst.data);
+}
+
+template <size_t N>
+inline void mul_block(const aligned_block<float, N> &src1, const aligned_block<float, N> &src2,
+                      aligned_block<float, N> &dst)
+{
+    detail::mul_block<N, true>(src1.data, src2.data, dst.data);
+}
+
+template <size_t N>
+inline void mul_block(const aligned_block<float, N> &src1, float scalar,
+                      aligned_block<float, N> &dst)
+{
+    detail::mul_block<N, true>(src1.data, scalar, dst.data);
+}
+
+template <size_t N>
+inline void scale_by(const aligned_block<float, N> &scale, aligned_block<float, N> &target)
+{
+    detail::mul_block<N, true>(target.data, scale.data, target.data);
+}
+
+template <size_t N> inline void scale_by(const float scale, aligned_block<float, N> &target)
+{
+    detail::mul_block<N, true>(target.data, scale, target.data);
+}
+
+template <size_t N> inline float blockAbsMax(const aligned_block<float, N> &d)
+{
+    return detail::blockAbsMax<N, true>(d.data);
 }
 } // namespace sst::basic_blocks::mechanics
 
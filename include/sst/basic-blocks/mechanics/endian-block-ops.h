@@ -0,0 +1,405 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MECHANICS_ENDIAN_BLOCK_OPS_H
+#define INCLUDE_SST_BASIC_BLOCKS_MECHANICS_ENDIAN_BLOCK_OPS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#include "endian-ops.h"
+#include "simd-ops.h"
+
+/*
+ * Block versions of the endian helpers for sample data. The reads turn int16, packed
+ * int24, int32 or float32 samples stored little or big endian into floats, normalizing
+ * the integers to [-1, 1), and the writes go the other way, scaling, clamping and
+ * rounding to nearest. Each call handles a whole buffer eight or four samples at a time
+ * with the byte swap folded into the conversion, and src and dst need no alignment.
+ *
+ * The swaps use pshufb where the target has SSSE3 (or AVX) and the consumer has included
+ * tmmintrin.h or immintrin.h, and SSE2 shifts otherwise. With AVX2 and immintrin.h the reads
+ * and 32 bit swaps go eight samples at a time. Packed int24 is SIMD only with SSSE3 and
+ * falls back to scalar code without it. This header includes no intrinsics headers itself;
+ * like the rest of the SIMD code it assumes a little endian host and wants your SSE (or
+ * SIMDE) headers included first.
+ */
+#if defined(_TMMINTRIN_H_INCLUDED) || defined(__TMMINTRIN_H) || defined(_INCLUDED_TMM) ||        \
+    SST_BASIC_BLOCKS_HAS_IMMINTRIN
+#define SST_BASIC_BLOCKS_HAS_TMMINTRIN 1
+#else
+#define SST_BASIC_BLOCKS_HAS_TMMINTRIN 0
+#endif
+
+#if !defined(SST_BASIC_BLOCKS_SSSE3)
+#if (defined(__SSSE3__) || defined(__AVX__)) && SST_BASIC_BLOCKS_HAS_TMMINTRIN
+#define SST_BASIC_BLOCKS_SSSE3 1
+#else
+#define SST_BASIC_BLOCKS_SSSE3 0
+#endif
+#endif
+
+#if defined(__AVX2__) && SST_BASIC_BLOCKS_HAS_IMMINTRIN && !defined(SST_BASIC_BLOCKS_NO_AVX)
+#define SST_BASIC_BLOCKS_ENDIAN_AVX2 1
+#else
+#define SST_BASIC_BLOCKS_ENDIAN_AVX2 0
+#endif
+
+namespace sst::basic_blocks::mechanics
+{
+namespace details
+{
+inline __m128i bswap_epi16(__m128i x)
+{
+#if SST_BASIC_BLOCKS_SSSE3
+    return _mm_shuffle_epi8(x, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+#else
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+#endif
+}
+
+inline __m128i bswap_epi32(__m128i x)
+{
+#if SST_BASIC_BLOCKS_SSSE3
+    return _mm_shuffle_epi8(x, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+#else
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+    x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+    return bswap_epi16(x);
+#endif
+}
+
+#if SST_BASIC_BLOCKS_ENDIAN_AVX2
+inline __m256i bswap_epi32(__m256i x)
+{
+    return _mm256_shuffle_epi8(x, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14,
+                                                   13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                                                   15, 14, 13, 12));
+}
+#endif
+
+// scale, clamp and round one sample exactly as the four wide loops do
+inline int32_t floatToInt(float f, float scale, float lo, float hi)
+{
+    auto v = _mm_mul_ss(_mm_set_ss(f), _mm_set_ss(scale));
+    return _mm_cvtss_si32(_mm_min_ss(_mm_max_ss(v, _mm_set_ss(lo)), _mm_set_ss(hi)));
+}
+inline __m128i floatToInt(__m128 f, __m128 scale, __m128 lo, __m128 hi)
+{
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(f, scale), lo), hi));
+}
+
+// every integer format is read into the top bits of an int32, so one scale normalizes all
+static constexpr float int32ToFloatScale{1.f / 2147483648.f};
+
+template <bool bigEndian> inline void readInt16(float *dst, const uint8_t *src, size_t n)
+{
+    const auto sc = _mm_set1_ps(int32ToFloatScale);
+    const auto zero = _mm_setzero_si128();
+    size_t i = 0;
+#if SST_BASIC_BLOCKS_ENDIAN_AVX2
+    const auto sc8 = _mm256_set1_ps(1.f / 32768.f);
+    for (; i + 8 <= n; i += 8)
+    {
+        auto x = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        if constexpr (bigEndian)
+            x = bswap_epi16(x);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x)), sc8));
+    }
+#endif
+    for (; i + 8 <= n; i += 8)
+    {
+        auto x = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+        if constexpr (bigEndian)
+            x = bswap_epi16(x);
+        auto lo = _mm_unpacklo_epi16(zero, x);
+        auto hi = _mm_unpackhi_epi16(zero, x);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), sc));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), sc));
+    }
+    for (; i < n; ++i)
+    {
+        auto b = src + 2 * i;
+        auto v = bigEndian ? (b[0] << 8) | b[1] : (b[1] << 8) | b[0];
+        dst[i] = (float)(int16_t)v * (1.f / 32768.f);
+    }
+}
+
+template <bool bigEndian> inline void readInt24(float *dst, const uint8_t *src, size_t n)
+{
+    size_t i = 0;
+#if SST_BASIC_BLOCKS_SSSE3
+    const auto sc = _mm_set1_ps(int32ToFloatScale);
+    const auto mask = bigEndian ? _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11,
+                                                10, 9)
+                                : _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9,
+                                                10, 11);
+    // four samples are 12 bytes but the load reads 16, so stop while that stays in bounds
+    for (; i + 6 <= n; i += 4)
+    {
+        auto x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 3 * i)), mask);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(x), sc));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        auto b = src + 3 * i;
+        auto v = bigEndian ? ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | (b[2] << 8)
+                           : ((uint32_t)b[2] << 24) | ((uint32_t)b[1] << 16) | (b[0] << 8);
+        dst[i] = (float)(int32_t)v * int32ToFloatScale;
+    }
+}
+
+template <bool bigEndian> inline void readInt32(float *dst, const uint8_t *src, size_t n)
+{
+    const auto sc = _mm_set1_ps(int32ToFloatScale);
+    size_t i = 0;
+#if SST_BASIC_BLOCKS_ENDIAN_AVX2
+    const auto sc8 = _mm256_set1_ps(int32ToFloatScale);
+    for (; i + 8 <= n; i += 8)
+    {
+        auto x = _mm256_loadu_si256((const __m256i *)(src + 4 * i));
+        if constexpr (bigEndian)
+            x = bswap_epi32(x);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), sc8));
+    }
+#endif
+    for (; i + 4 <= n; i += 4)
+    {
+        auto x = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+        if constexpr (bigEndian)
+            x = bswap_epi32(x);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(x), sc));
+    }
+    for (; i < n; ++i)
+    {
+        uint32_t v;
+        memcpy(&v, src + 4 * i, sizeof(v));
+        if constexpr (bigEndian)
+            v = swap_endian_32(v);
+        dst[i] = (float)(int32_t)v * int32ToFloatScale;
+    }
+}
+
+template <bool bigEndian> inline void readFloat32(float *dst, const uint8_t *src, size_t n)
+{
+    size_t i = 0;
+#if SST_BASIC_BLOCKS_ENDIAN_AVX2
+    for (; i + 8 <= n; i += 8)
+    {
+        auto x = _mm256_loadu_si256((const __m256i *)(src + 4 * i));
+        if constexpr (bigEndian)
+            x = bswap_epi32(x);
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(x));
+    }
+#endif
+    for (; i + 4 <= n; i += 4)
+    {
+        auto x = _mm_loadu_si128((const __m128i *)(src + 4 * i));
+        if constexpr (bigEndian)
+            x = bswap_epi32(x);
+        _mm_storeu_ps(dst + i, _mm_castsi128_ps(x));
+    }
+    for (; i < n; ++i)
+    {
+        uint32_t v;
+        memcpy(&v, src + 4 * i, sizeof(v));
+        if constexpr (bigEndian)
+            v = swap_endian_32(v);
+        memcpy(dst + i, &v, sizeof(v));
+    }
+}
+
+template <bool bigEndian> inline void writeInt16(uint8_t *dst, const float *src, size_t n)
+{
+    const auto sc = _mm_set1_ps(32768.f), lo = _mm_set1_ps(-32768.f), hi = _mm_set1_ps(32767.f);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        auto a = floatToInt(_mm_loadu_ps(src + i), sc, lo, hi);
+        auto b = floatToInt(_mm_loadu_ps(src + i + 4), sc, lo, hi);
+        auto x = _mm_packs_epi32(a, b);
+        if constexpr (bigEndian)
+            x = bswap_epi16(x);
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), x);
+    }
+    for (; i < n; ++i)
+    {
+        auto v = (uint16_t)floatToInt(src[i], 32768.f, -32768.f, 32767.f);
+        auto b = dst + 2 * i;
+        b[bigEndian ? 1 : 0] = (uint8_t)v;
+        b[bigEndian ? 0 : 1] = (uint8_t)(v >> 8);
+    }
+}
+
+template <bool bigEndian> inline void writeInt24(uint8_t *dst, const float *src, size_t n)
+{
+    static constexpr float sc1{8388608.f}, lo1{-8388608.f}, hi1{8388607.f};
+    size_t i = 0;
+#if SST_BASIC_BLOCKS_SSSE3
+    const auto sc = _mm_set1_ps(sc1), lo = _mm_set1_ps(lo1), hi = _mm_set1_ps(hi1);
+    const auto mask = bigEndian ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                                                -1, -1)
+                                : _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1,
+                                                -1, -1);
+    for (; i + 4 <= n; i += 4)
+    {
+        auto x = _mm_shuffle_epi8(floatToInt(_mm_loadu_ps(src + i), sc, lo, hi), mask);
+        auto b = dst + 3 * i;
+        _mm_storel_epi64((__m128i *)b, x);
+        auto t = _mm_cvtsi128_si32(_mm_srli_si128(x, 8));
+        memcpy(b + 8, &t, 4);
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        auto v = (uint32_t)floatToInt(src[i], sc1, lo1, hi1);
+        auto b = dst + 3 * i;
+        b[bigEndian ? 2 : 0] = (uint8_t)v;
+        b[1] = (uint8_t)(v >> 8);
+        b[bigEndian ? 0 : 2] = (uint8_t)(v >> 16);
+    }
+}
+
+template <bool bigEndian> inline void writeInt32(uint8_t *dst, const float *src, size_t n)
+{
+    // 2^31 itself would overflow, so clamp to the largest float below it
+    static constexpr float sc1{2147483648.f}, lo1{-2147483648.f}, hi1{2147483520.f};
+    const auto sc = _mm_set1_ps(sc1), lo = _mm_set1_ps(lo1), hi = _mm_set1_ps(hi1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto x = floatToInt(_mm_loadu_ps(src + i), sc, lo, hi);
+        if constexpr (bigEndian)
+            x = bswap_epi32(x);
+        _mm_storeu_si128((__m128i *)(dst + 4 * i), x);
+    }
+    for (; i < n; ++i)
+    {
+        auto v = (uint32_t)floatToInt(src[i], sc1, lo1, hi1);
+        if constexpr (bigEndian)
+            v = swap_endian_32(v);
+        memcpy(dst + 4 * i, &v, sizeof(v));
+    }
+}
+
+template <bool bigEndian> inline void writeFloat32(uint8_t *dst, const float *src, size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        auto x = _mm_castps_si128(_mm_loadu_ps(src + i));
+        if constexpr (bigEndian)
+            x = bswap_epi32(x);
+        _mm_storeu_si128((__m128i *)(dst + 4 * i), x);
+    }
+    for (; i < n; ++i)
+    {
+        uint32_t v;
+        memcpy(&v, src + i, sizeof(v));
+        if constexpr (bigEndian)
+            v = swap_endian_32(v);
+        memcpy(dst + 4 * i, &v, sizeof(v));
+    }
+}
+} // namespace details
+
+// Byte swap count 16 or 32 bit values. dst may be src.
+inline void swap_endian_block16(void *dst, const void *src, size_t count)
+{
+    auto d = static_cast<uint8_t *>(dst);
+    auto s = static_cast<const uint8_t *>(src);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128((__m128i *)(d + 2 * i),
+                         details::bswap_epi16(_mm_loadu_si128((const __m128i *)(s + 2 * i))));
+    for (; i < count; ++i)
+    {
+        uint16_t v;
+        memcpy(&v, s + 2 * i, sizeof(v));
+        v = swap_endian_16(v);
+        memcpy(d + 2 * i, &v, sizeof(v));
+    }
+}
+
+inline void swap_endian_block32(void *dst, const void *src, size_t count)
+{
+    auto d = static_cast<uint8_t *>(dst);
+    auto s = static_cast<const uint8_t *>(src);
+    size_t i = 0;
+#if SST_BASIC_BLOCKS_ENDIAN_AVX2
+    for (; i + 8 <= count; i += 8)
+    {
+        auto x = _mm256_loadu_si256((const __m256i *)(s + 4 * i));
+        _mm256_storeu_si256((__m256i *)(d + 4 * i), details::bswap_epi32(x));
+    }
+#endif
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i *)(d + 4 * i),
+                         details::bswap_epi32(_mm_loadu_si128((const __m128i *)(s + 4 * i))));
+    for (; i < count; ++i)
+    {
+        uint32_t v;
+        memcpy(&v, s + 4 * i, sizeof(v));
+        v = swap_endian_32(v);
+        memcpy(d + 4 * i, &v, sizeof(v));
+    }
+}
+
+/*
+ * endian_read_block_<fmt><LE|BE>(dst, src, count) reads count samples in that format and
+ * byte order from src into dst, with integers mapped to [-1, 1) so int16 s becomes
+ * s / 32768. endian_write_block_<fmt><LE|BE>(dst, src, count) is the inverse, clamping
+ * out of range floats. fmt is int16, int24 (three packed bytes), int32 or float32.
+ */
+#define SST_BASIC_BLOCKS_ENDIAN_BLOCK_OPS(fmt, impl)                                              \
+    inline void endian_read_block_##fmt##LE(float *dst, const void *src, size_t count)            \
+    {                                                                                              \
+        details::read##impl<false>(dst, static_cast<const uint8_t *>(src), count);                 \
+    }                                                                                              \
+    inline void endian_read_block_##fmt##BE(float *dst, const void *src, size_t count)            \
+    {                                                                                              \
+        details::read##impl<true>(dst, static_cast<const uint8_t *>(src), count);                  \
+    }                                                                                              \
+    inline void endian_write_block_##fmt##LE(void *dst, const float *src, size_t count)           \
+    {                                                                                              \
+        details::write##impl<false>(static_cast<uint8_t *>(dst), src, count);                      \
+    }                                                                                              \
+    inline void endian_write_block_##fmt##BE(void *dst, const float *src, size_t count)           \
+    {                                                                                              \
+        details::write##impl<true>(static_cast<uint8_t *>(dst), src, count);                       \
+    }
+
+SST_BASIC_BLOCKS_ENDIAN_BLOCK_OPS(int16, Int16)
+SST_BASIC_BLOCKS_ENDIAN_BLOCK_OPS(int24, Int24)
+SST_BASIC_BLOCKS_ENDIAN_BLOCK_OPS(int32, Int32)
+SST_BASIC_BLOCKS_ENDIAN_BLOCK_OPS(float32, Float32)
+#undef SST_BASIC_BLOCKS_ENDIAN_BLOCK_OPS
+
+} // namespace sst::basic_blocks::mechanics
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MECHANICS_ENDIAN_BLOCK_OPS_H
@@ -26,6 +26,10 @@
 #ifndef INCLUDE_SST_BASIC_BLOCKS_MECHANICS_ENDIAN_OPS_H
 #define INCLUDE_SST_BASIC_BLOCKS_MECHANICS_ENDIAN_OPS_H
 
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
 namespace sst::basic_blocks::mechanics
 {
 
@@ -59,6 +63,7 @@ inline float endian_write_float32LE(float f)
     return f;
 #endif
 }
+inline auto endian_read_float32LE(float a) { return endian_write_float32LE(a); }
 
 inline int endian_write_int32BE(uint32_t t)
 {
@@ -0,0 +1,95 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MECHANICS_INSTRUMENTATION_H
+#define INCLUDE_SST_BASIC_BLOCKS_MECHANICS_INSTRUMENTATION_H
+
+/*
+ * Optional probes around the hot entry points: FixedMatrix::process, the LanczosResampler
+ * populates, the envelope block functions and SimpleLFO::process_block. By default
+ * SST_BASIC_BLOCKS_PROBE expands to nothing. To turn the probes on, define
+ * SST_BASIC_BLOCKS_PROBE_SINK to a type with
+ *
+ *   static void begin(const char *name, uint64_t cycles);
+ *   static void end(const char *name, uint64_t cycles);
+ *
+ * before including any sst-basic-blocks header. Each probe then calls begin on entry and end
+ * on scope exit, stamped with cycleCount(). Forward those to Tracy, perfetto or your own
+ * counters. The name is a string literal, so it can be used as a key. Define the sink the
+ * same way in every translation unit, since it changes inline function bodies.
+ */
+
+#ifdef SST_BASIC_BLOCKS_PROBE_SINK
+
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define SST_BASIC_BLOCKS_PROBE_HAS_RDTSC 1
+#else
+#include <chrono>
+#define SST_BASIC_BLOCKS_PROBE_HAS_RDTSC 0
+#endif
+
+namespace sst::basic_blocks::mechanics::instrumentation
+{
+// the time stamp counter where there is one, otherwise steady clock nanoseconds
+inline uint64_t cycleCount()
+{
+#if SST_BASIC_BLOCKS_PROBE_HAS_RDTSC
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+template <typename Sink> struct ScopedProbe
+{
+    const char *name;
+    explicit ScopedProbe(const char *n) : name(n) { Sink::begin(name, cycleCount()); }
+    ~ScopedProbe() { Sink::end(name, cycleCount()); }
+
+    ScopedProbe(const ScopedProbe &) = delete;
+    ScopedProbe &operator=(const ScopedProbe &) = delete;
+};
+} // namespace sst::basic_blocks::mechanics::instrumentation
+
+#define SST_BASIC_BLOCKS_PROBE(name)                                                               \
+    ::sst::basic_blocks::mechanics::instrumentation::ScopedProbe<SST_BASIC_BLOCKS_PROBE_SINK>      \
+        sstBasicBlocksProbe(name)
+
+#else
+
+#define SST_BASIC_BLOCKS_PROBE(name)
+
+#endif
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MECHANICS_INSTRUMENTATION_H
@@ -0,0 +1,84 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MECHANICS_MEMORY_ARENA_H
+#define INCLUDE_SST_BASIC_BLOCKS_MECHANICS_MEMORY_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sst::basic_blocks::mechanics
+{
+
+/*
+ * A bump allocator over one contiguous block. Reserve (or hand in) the memory for a whole
+ * effect chain at load time, then allocate from it without touching the heap. Individual
+ * allocations are never freed; reset() recycles the whole arena at once, for instance when
+ * a chain is rebuilt. allocate returns nullptr rather than growing when the arena is full.
+ */
+struct MemoryArena
+{
+    MemoryArena() = default;
+    explicit MemoryArena(size_t bytes) { reserve(bytes); }
+    // Use caller owned memory, which must outlive the arena and everything allocated from it
+    MemoryArena(void *mem, size_t bytes) : base(static_cast<uint8_t *>(mem)), capacity(bytes) {}
+
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena &operator=(const MemoryArena &) = delete;
+
+    // Allocates, so call this off the audio thread. Invalidates earlier allocations.
+    void reserve(size_t bytes)
+    {
+        owned = std::make_unique<uint8_t[]>(bytes);
+        base = owned.get();
+        capacity = bytes;
+        used = 0;
+    }
+
+    void *allocate(size_t bytes, size_t alignment = 16)
+    {
+        auto at = reinterpret_cast<uintptr_t>(base) + used;
+        auto pad = (alignment - (at & (alignment - 1))) & (alignment - 1);
+        if (!base || used + pad + bytes > capacity)
+            return nullptr;
+        used += pad + bytes;
+        return base + (used - bytes);
+    }
+
+    void reset() { used = 0; }
+
+    size_t bytesUsed() const { return used; }
+    size_t bytesCapacity() const { return capacity; }
+
+  private:
+    std::unique_ptr<uint8_t[]> owned;
+    uint8_t *base{nullptr};
+    size_t capacity{0}, used{0};
+};
+} // namespace sst::basic_blocks::mechanics
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MECHANICS_MEMORY_ARENA_H
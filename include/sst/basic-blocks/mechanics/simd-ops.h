@@ -26,6 +26,24 @@
 #ifndef INCLUDE_SST_BASIC_BLOCKS_MECHANICS_SIMD_OPS_H
 #define INCLUDE_SST_BASIC_BLOCKS_MECHANICS_SIMD_OPS_H
 
+/*
+ * The 256 bit kernels are compiled when the consumer builds with AVX (-mavx2, /arch:AVX2) and
+ * includes immintrin.h before these headers; they use FMA where __FMA__ is also set. A
+ * consumer which only includes its SSE header keeps the 128 bit kernels even with AVX
+ * target flags, and SST_BASIC_BLOCKS_NO_AVX forces them regardless.
+ */
+#if defined(_IMMINTRIN_H_INCLUDED) || defined(__IMMINTRIN_H) || defined(_INCLUDED_IMM)
+#define SST_BASIC_BLOCKS_HAS_IMMINTRIN 1
+#else
+#define SST_BASIC_BLOCKS_HAS_IMMINTRIN 0
+#endif
+
+#if defined(__AVX__) && SST_BASIC_BLOCKS_HAS_IMMINTRIN && !defined(SST_BASIC_BLOCKS_NO_AVX)
+#define SST_BASIC_BLOCKS_AVX 1
+#else
+#define SST_BASIC_BLOCKS_AVX 0
+#endif
+
 namespace sst::basic_blocks::mechanics
 {
 inline __m128 sum_ps_to_ss(__m128 x)
@@ -58,6 +76,28 @@ const __m128 m128_mask_absval = _mm_set1_ps(detail::i2f_binary_cast(0x7fffffff))
 
 inline __m128 abs_ps(__m128 x) { return _mm_and_ps(x, m128_mask_absval); }
 
+#if SST_BASIC_BLOCKS_AVX
+inline float sum_ps_to_float(__m256 x)
+{
+    return sum_ps_to_float(_mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1)));
+}
+
+inline __m256 abs_ps(__m256 x)
+{
+    return _mm256_and_ps(x, _mm256_set1_ps(detail::i2f_binary_cast(0x7fffffff)));
+}
+
+// a * b + c, fused when the target has FMA
+inline __m256 fmadd_ps(__m256 a, __m256 b, __m256 c)
+{
+#if defined(__FMA__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+#endif
+
 inline float rcp(float x)
 {
     _mm_store_ss(&x, _mm_rcp_ss(_mm_load_ss(&x)));
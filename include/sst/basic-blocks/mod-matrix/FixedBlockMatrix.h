@@ -0,0 +1,282 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_FIXEDBLOCKMATRIX_H
+#define INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_FIXEDBLOCKMATRIX_H
+
+#include <cstring>
+#include <functional>
+#include <unordered_set>
+
+#include "ModMatrix.h"
+#include "ModMatrixSIMDDetails.h"
+#include "sst/basic-blocks/mechanics/simd-ops.h"
+#include "sst/basic-blocks/dsp/BlockInterpolators.h"
+
+/*
+ * A block rate version of the FixedMatrix. Sources can be bound to a float[blockSize]
+ * buffer (like the outputBlock of a SimpleLFO or the outputCache of an envelope) and each
+ * mapped target gets a float[blockSize] output which is the linearly interpolated base
+ * value plus the per-sample modulation. Sources bound with the scalar bindSourceValue still
+ * work and are held constant across the block.
+ *
+ * The routing machinery is the FixedMatrix one, so the scalar API (process,
+ * getTargetValue) keeps working; after processBlock the scalar outputs hold the last
+ * sample of each target block.
+ *
+ * Like the rest of the SIMD code here, this requires you to include your SSE (or SIMDE)
+ * headers before this one.
+ */
+namespace sst::basic_blocks::mod_matrix
+{
+template <typename ModMatrixTraits, int blockSize>
+struct FixedBlockMatrix : FixedMatrix<ModMatrixTraits>
+{
+    using TR = ModMatrixTraits;
+    using FM = FixedMatrix<ModMatrixTraits>;
+    using RT = typename FM::RT;
+    using RVP = typename FM::RoutingValuePointers;
+
+    static_assert(!(blockSize & (blockSize - 1)) && blockSize >= 4,
+                  "Block size must be a power of 2 4 or above.");
+    static constexpr int numRegisters{blockSize >> 2};
+
+    float outputBlocks alignas(16)[TR::FixedMatrixSize][blockSize];
+
+    FixedBlockMatrix() { memset(outputBlocks, 0, sizeof(outputBlocks)); }
+
+    /*
+     * Bind a source to a block. The block needs to live longer than the matrix, does not
+     * need to be aligned, and is read as blockSize floats on each processBlock.
+     */
+    void bindSourceBlock(const typename TR::SourceIdentifier &s, float *block)
+    {
+        this->bindSourceValue(s, *block);
+        blockSources.insert(block);
+    }
+
+    void prepare(RT &rt)
+    {
+        FM::prepare(rt);
+
+        for (size_t i = 0; i < this->numProgramBaseValues; ++i)
+        {
+            const auto &b = this->programBaseValues[i];
+            baseLerps[this->outputIndexOf(b.output)].set_target_instant(*b.baseValue);
+        }
+
+        compileBlockRoutes();
+    }
+
+    // See FixedMatrix::compactProgram
+    void compactProgram()
+    {
+        this->compileProgram(true);
+        compileBlockRoutes();
+    }
+
+    // See FixedMatrix::updateRoute
+    bool updateRoute(RT &rt, size_t position)
+    {
+        if (!this->canUpdateRouteInPlace(rt, position))
+        {
+            prepare(rt);
+            return false;
+        }
+        this->patchRoute(rt, position);
+        this->compileProgram();
+        compileBlockRoutes();
+        return true;
+    }
+
+    void processBlock()
+    {
+        for (size_t i = 0; i < this->numProgramBaseValues; ++i)
+        {
+            const auto &b = this->programBaseValues[i];
+            auto oi = this->outputIndexOf(b.output);
+            baseLerps[oi].set_target(*b.baseValue);
+            baseLerps[oi].store_block(outputBlocks[oi]);
+        }
+
+        float offs alignas(16)[blockSize];
+        for (size_t i = 0; i < numBlockRoutes; ++i)
+        {
+            const auto &b = blockRoutes[i];
+            const auto &r = *b.route;
+            if (!(*r.active))
+                continue;
+
+            fillOffsets(b, offs);
+            switch (r.applicationMode)
+            {
+            case RVP::ApplicationMode::ADDITIVE:
+                accumulateAdditive(b, offs);
+                break;
+            case RVP::ApplicationMode::MULTIPLICATIVE:
+                accumulateMultiplicative(b, offs);
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < this->numProgramBaseValues; ++i)
+        {
+            auto oi = this->outputIndexOf(this->programBaseValues[i].output);
+            this->matrixOutputs[oi] = outputBlocks[oi][blockSize - 1];
+        }
+    }
+
+    /*
+     * Returns the output block for a mapped target or nullptr if the target has no
+     * routings, in which case the base value is the value for the whole block.
+     */
+    const float *getTargetBlockPointer(const typename TR::TargetIdentifier &s) const
+    {
+        if constexpr (ModMatrix<TR>::hasDenseTargets)
+        {
+            auto o = this->denseTargetOutputs[TR::targetToIndex(s)];
+            return o ? outputBlocks[this->outputIndexOf(o)] : nullptr;
+        }
+        else
+        {
+            auto f = this->isOutputMapped.find(s);
+            if (f == this->isOutputMapped.end() || !f->second)
+                return nullptr;
+            return outputBlocks[this->targetToOutputIndex.at(s)];
+        }
+    }
+
+  protected:
+    struct BlockRoute
+    {
+        const typename FM::ProgramRoute *route{nullptr};
+        bool sourceIsBlock{false}, viaIsBlock{false};
+        const float *depthBlock{nullptr};
+        float *output{nullptr};
+    };
+    std::array<BlockRoute, TR::FixedMatrixSize> blockRoutes{};
+    size_t numBlockRoutes{0};
+
+    std::array<dsp::lipol_sse<blockSize, true>, TR::FixedMatrixSize> baseLerps;
+    std::unordered_set<const float *> blockSources;
+
+    void compileBlockRoutes()
+    {
+        numBlockRoutes = 0;
+        for (size_t i = 0; i < this->numProgramRoutes; ++i)
+        {
+            const auto &p = this->programRoutes[i];
+            auto &b = blockRoutes[numBlockRoutes];
+            b = BlockRoute();
+            b.route = &p;
+            b.sourceIsBlock = isBlockSource(p.source);
+            b.viaIsBlock = p.sourceVia && isBlockSource(p.sourceVia);
+            b.output = outputBlocks[this->outputIndexOf(p.target)];
+            if (this->outputIndexOf(p.depth) >= 0)
+            {
+                // Self modulated depth reads the depth target's block per sample
+                b.depthBlock = outputBlocks[this->outputIndexOf(p.depth)];
+            }
+            numBlockRoutes++;
+        }
+    }
+
+    bool isBlockSource(const float *f) const { return blockSources.find(f) != blockSources.end(); }
+
+    static __m128 loadSource(const float *f, bool isBlock, int reg)
+    {
+        if (isBlock)
+            return _mm_loadu_ps(f + (reg << 2));
+        return _mm_set1_ps(*f);
+    }
+
+    // offs = curve(source * sourceVia)
+    void fillOffsets(const BlockRoute &b, float *__restrict offs) const
+    {
+        const auto &r = *b.route;
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            auto s = loadSource(r.source, b.sourceIsBlock, i);
+            if (r.sourceVia)
+                s = _mm_mul_ps(s, loadSource(r.sourceVia, b.viaIsBlock, i));
+            _mm_store_ps(offs + (i << 2), s);
+        }
+
+        if constexpr (ModMatrix<TR>::supportsCurves)
+        {
+            if (r.curveMode != FM::ProgramRoute::NO_CURVE)
+            {
+                for (int i = 0; i < numRegisters; ++i)
+                {
+                    auto o = _mm_load_ps(offs + (i << 2));
+                    o = details::applyCurveSSE<typename FM::ProgramRoute, FM::curveLUTSize>(r, o);
+                    _mm_store_ps(offs + (i << 2), o);
+                }
+            }
+        }
+    }
+
+    // out += depth * depthScale * offs
+    void accumulateAdditive(const BlockRoute &b, const float *__restrict offs) const
+    {
+        const auto &r = *b.route;
+        auto ds = _mm_set1_ps(r.depthScale);
+        auto dep = _mm_mul_ps(ds, _mm_set1_ps(*r.depth));
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            if (b.depthBlock)
+                dep = _mm_mul_ps(ds, _mm_load_ps(b.depthBlock + (i << 2)));
+            auto o = _mm_load_ps(b.output + (i << 2));
+            o = _mm_add_ps(o, _mm_mul_ps(dep, _mm_load_ps(offs + (i << 2))));
+            _mm_store_ps(b.output + (i << 2), o);
+        }
+    }
+
+    /*
+     * out *= mulfac with the same |offs| clamp as the scalar matrix. mulfac is
+     * dep * offs + (1 - dep) for positive depth and 1 + dep * offs otherwise, which is
+     * 1 - max(dep, 0) + dep * offs for either sign.
+     */
+    void accumulateMultiplicative(const BlockRoute &b, const float *__restrict offs) const
+    {
+        const auto &r = *b.route;
+        const auto one = _mm_set1_ps(1.f);
+        const auto zero = _mm_setzero_ps();
+        auto dep = _mm_set1_ps(*r.depth);
+        for (int i = 0; i < numRegisters; ++i)
+        {
+            if (b.depthBlock)
+                dep = _mm_load_ps(b.depthBlock + (i << 2));
+            auto of = _mm_min_ps(mechanics::abs_ps(_mm_load_ps(offs + (i << 2))), one);
+            auto mf = _mm_add_ps(_mm_sub_ps(one, _mm_max_ps(dep, zero)), _mm_mul_ps(dep, of));
+            auto o = _mm_load_ps(b.output + (i << 2));
+            _mm_store_ps(b.output + (i << 2), _mm_mul_ps(o, mf));
+        }
+    }
+};
+} // namespace sst::basic_blocks::mod_matrix
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_FIXEDBLOCKMATRIX_H
@@ -0,0 +1,253 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_FIXEDLANEMATRIX_H
+#define INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_FIXEDLANEMATRIX_H
+
+#include <functional>
+#include <unordered_set>
+
+#include "ModMatrix.h"
+#include "ModMatrixSIMDDetails.h"
+#include "sst/basic-blocks/mechanics/simd-ops.h"
+
+/*
+ * A voice-lane version of the FixedMatrix which evaluates four voices sharing one
+ * routing table at once. Sources and target base values are bound to float[4] arrays,
+ * one value per voice, and the outputs are stored the same way, so a polyphonic engine
+ * keeps its modulator and parameter values structure-of-arrays across a voice group.
+ * Sources and base values bound with the scalar bind calls are shared by all four lanes
+ * (this is handy for macros or patch level parameters). Routing depth and activation
+ * come from the routing table and so are also shared.
+ *
+ * The lane arrays you bind need to live longer than the matrix. Include your SSE (or
+ * SIMDE) headers before this one.
+ */
+namespace sst::basic_blocks::mod_matrix
+{
+template <typename ModMatrixTraits> struct FixedLaneMatrix : FixedMatrix<ModMatrixTraits>
+{
+    using TR = ModMatrixTraits;
+    using FM = FixedMatrix<ModMatrixTraits>;
+    using RT = typename FM::RT;
+    using RVP = typename FM::RoutingValuePointers;
+
+    static constexpr int numLanes{4};
+
+    float laneOutputs alignas(16)[TR::FixedMatrixSize][numLanes]{};
+
+    void bindSourceLanes(const typename TR::SourceIdentifier &s, float *lanes)
+    {
+        this->bindSourceValue(s, *lanes);
+        laneValues.insert(lanes);
+    }
+
+    void bindTargetBaseLanes(const typename TR::TargetIdentifier &t, float *lanes)
+    {
+        this->bindTargetBaseValue(t, *lanes);
+        laneValues.insert(lanes);
+    }
+
+    void prepare(RT &rt)
+    {
+        FM::prepare(rt);
+
+        compileLaneProgram();
+    }
+
+    // See FixedMatrix::compactProgram
+    void compactProgram()
+    {
+        this->compileProgram(true);
+        compileLaneProgram();
+    }
+
+    // See FixedMatrix::updateRoute
+    bool updateRoute(RT &rt, size_t position)
+    {
+        if (!this->canUpdateRouteInPlace(rt, position))
+        {
+            prepare(rt);
+            return false;
+        }
+        this->patchRoute(rt, position);
+        this->compileProgram();
+        compileLaneProgram();
+        return true;
+    }
+
+    void process()
+    {
+        for (size_t i = 0; i < numLaneBaseValues; ++i)
+        {
+            const auto &b = laneBaseValues[i];
+            _mm_store_ps(b.output, load(b.baseValue, b.isLanes));
+        }
+
+        const auto one = _mm_set1_ps(1.f);
+        const auto zero = _mm_setzero_ps();
+        for (size_t i = 0; i < numLaneRoutes; ++i)
+        {
+            const auto &b = laneRoutes[i];
+            const auto &r = *b.route;
+            if (!(*r.active))
+                continue;
+
+            auto offs = load(r.source, b.sourceIsLanes);
+            if (r.sourceVia)
+                offs = _mm_mul_ps(offs, load(r.sourceVia, b.viaIsLanes));
+
+            if constexpr (ModMatrix<TR>::supportsCurves)
+            {
+                offs = details::applyCurveSSE<typename FM::ProgramRoute, FM::curveLUTSize>(r, offs);
+            }
+
+            auto dep = b.depthLanes ? _mm_load_ps(b.depthLanes) : _mm_set1_ps(*r.depth);
+            auto out = _mm_load_ps(b.output);
+            switch (r.applicationMode)
+            {
+            case RVP::ApplicationMode::ADDITIVE:
+                out = _mm_add_ps(out, _mm_mul_ps(_mm_mul_ps(dep, _mm_set1_ps(r.depthScale)), offs));
+                break;
+            case RVP::ApplicationMode::MULTIPLICATIVE:
+            {
+                // See FixedBlockMatrix for this branch free form of the scalar mulfac
+                offs = _mm_min_ps(mechanics::abs_ps(offs), one);
+                auto mf = _mm_add_ps(_mm_sub_ps(one, _mm_max_ps(dep, zero)), _mm_mul_ps(dep, offs));
+                out = _mm_mul_ps(out, mf);
+            }
+            break;
+            }
+            _mm_store_ps(b.output, out);
+        }
+
+        for (size_t i = 0; i < this->numProgramBaseValues; ++i)
+        {
+            auto oi = this->outputIndexOf(this->programBaseValues[i].output);
+            this->matrixOutputs[oi] = laneOutputs[oi][0];
+        }
+    }
+
+    /*
+     * Returns the four voice values for a mapped target or nullptr if the target has no
+     * routings, in which case the bound base value is the result.
+     */
+    const float *getTargetLanesPointer(const typename TR::TargetIdentifier &s) const
+    {
+        if constexpr (ModMatrix<TR>::hasDenseTargets)
+        {
+            auto o = this->denseTargetOutputs[TR::targetToIndex(s)];
+            return o ? laneOutputs[this->outputIndexOf(o)] : nullptr;
+        }
+        else
+        {
+            auto f = this->isOutputMapped.find(s);
+            if (f == this->isOutputMapped.end() || !f->second)
+                return nullptr;
+            return laneOutputs[this->targetToOutputIndex.at(s)];
+        }
+    }
+
+    float getTargetValue(const typename TR::TargetIdentifier &s, int lane) const
+    {
+        assert(lane >= 0 && lane < numLanes);
+        auto p = getTargetLanesPointer(s);
+        if (p)
+            return p[lane];
+
+        auto bv = this->baseValues.find(s);
+        if (bv == this->baseValues.end())
+            return 0;
+        const auto *f = &(bv->second);
+        return isLanes(f) ? f[lane] : *f;
+    }
+
+  protected:
+    struct LaneBaseValue
+    {
+        const float *baseValue{nullptr};
+        bool isLanes{false};
+        float *output{nullptr};
+    };
+    std::array<LaneBaseValue, TR::FixedMatrixSize> laneBaseValues{};
+    size_t numLaneBaseValues{0};
+
+    struct LaneRoute
+    {
+        const typename FM::ProgramRoute *route{nullptr};
+        bool sourceIsLanes{false}, viaIsLanes{false};
+        const float *depthLanes{nullptr};
+        float *output{nullptr};
+    };
+    std::array<LaneRoute, TR::FixedMatrixSize> laneRoutes{};
+    size_t numLaneRoutes{0};
+
+    std::unordered_set<const float *> laneValues;
+
+    void compileLaneProgram()
+    {
+        numLaneBaseValues = 0;
+        for (size_t i = 0; i < this->numProgramBaseValues; ++i)
+        {
+            const auto &p = this->programBaseValues[i];
+            auto &b = laneBaseValues[numLaneBaseValues];
+            b.baseValue = p.baseValue;
+            b.isLanes = isLanes(p.baseValue);
+            b.output = laneOutputs[this->outputIndexOf(p.output)];
+            numLaneBaseValues++;
+        }
+
+        numLaneRoutes = 0;
+        for (size_t i = 0; i < this->numProgramRoutes; ++i)
+        {
+            const auto &p = this->programRoutes[i];
+            auto &b = laneRoutes[numLaneRoutes];
+            b = LaneRoute();
+            b.route = &p;
+            b.sourceIsLanes = isLanes(p.source);
+            b.viaIsLanes = p.sourceVia && isLanes(p.sourceVia);
+            b.output = laneOutputs[this->outputIndexOf(p.target)];
+            if (this->outputIndexOf(p.depth) >= 0)
+            {
+                // Self modulated depth is per voice, so read the depth target's lanes
+                b.depthLanes = laneOutputs[this->outputIndexOf(p.depth)];
+            }
+            numLaneRoutes++;
+        }
+    }
+
+    bool isLanes(const float *f) const { return laneValues.find(f) != laneValues.end(); }
+
+    static __m128 load(const float *f, bool lanes)
+    {
+        if (lanes)
+            return _mm_loadu_ps(f);
+        return _mm_set1_ps(*f);
+    }
+};
+} // namespace sst::basic_blocks::mod_matrix
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_FIXEDLANEMATRIX_H
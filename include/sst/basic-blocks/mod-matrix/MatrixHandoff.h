@@ -0,0 +1,103 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_MATRIXHANDOFF_H
+#define INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_MATRIXHANDOFF_H
+
+#include <array>
+#include <atomic>
+#include <cassert>
+
+/*
+ * A wait-free hand-off of prepared matrices from an editing (UI) thread to the audio
+ * thread. The UI thread copies a routing table into a free slot and prepares the slot's
+ * matrix there, so all the hashing and allocation of prepare() happens off the audio
+ * thread. The audio thread calls acquire() at a block boundary, which swaps in the most
+ * recently published matrix with a single atomic exchange.
+ *
+ * This is a triple buffer: one slot is owned by each thread and the third sits in the
+ * middle. Publishing swaps the writer's slot with the middle one and acquiring swaps the
+ * reader's slot with it, so neither side ever waits, publishing twice before the audio
+ * thread acquires just drops the older program, and a retired slot is reused by a later
+ * publish rather than freed. Each slot holds both the matrix and the table it was
+ * prepared from, since the prepared program points into its table.
+ *
+ * The matrices in different slots are different objects, so bind your sources and
+ * targets into all of them with forEachMatrix at setup and re-fetch any target pointers
+ * after acquire returns true.
+ */
+namespace sst::basic_blocks::mod_matrix
+{
+template <typename MatrixT> struct MatrixHandoff
+{
+    using RoutingTable = typename MatrixT::RoutingTable;
+
+    struct Slot
+    {
+        RoutingTable table{};
+        MatrixT matrix{};
+    };
+
+    // Setup only; not safe once the audio thread is running
+    template <typename F> void forEachMatrix(F &&f)
+    {
+        for (auto &s : slots)
+            f(s.matrix);
+    }
+
+    // UI thread. Prepares a copy of rt and publishes it for the next acquire.
+    void publish(const RoutingTable &rt)
+    {
+        auto &s = slots[writeIndex];
+        s.table = rt;
+        s.matrix.prepare(s.table);
+        writeIndex = middle.exchange(writeIndex | dirtyBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Audio thread, at a block boundary. Returns true if a new matrix was swapped in.
+    bool acquire()
+    {
+        if (!(middle.load(std::memory_order_acquire) & dirtyBit))
+            return false;
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    // Audio thread
+    MatrixT &matrix() { return slots[readIndex].matrix; }
+    const RoutingTable &table() const { return slots[readIndex].table; }
+
+  private:
+    static constexpr int dirtyBit{4}, indexMask{3};
+
+    std::array<Slot, 3> slots{};
+    int writeIndex{0}, readIndex{2};
+    std::atomic<int> middle{1};
+    static_assert(std::atomic<int>::is_always_lock_free);
+};
+} // namespace sst::basic_blocks::mod_matrix
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_MATRIXHANDOFF_H
@@ -32,12 +32,15 @@
 #include <cassert>
 #include <unordered_map>
 #include <unordered_set>
+#include <bitset>
 #include <functional>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
 
 #include <iostream>
 #include "ModMatrixDetails.h"
+#include "sst/basic-blocks/mechanics/instrumentation.h"
 
 /*
  * This is an implementation of a relatively genericised mod matrix which
@@ -75,18 +78,41 @@ struct ModMatrix : details::CheckModMatrixConstraints<ModMatrixTraits>
 {
     using TR = ModMatrixTraits;
 
+    /*
+     * A trait can opt into dense indices by providing static constexpr size_t
+     * DenseSourceCount and static size_t sourceToIndex(const SourceIdentifier &) (and the
+     * same with Target), with indices below the count. Bindings are then also kept in
+     * flat arrays so lookups by identifier are array reads rather than hashes.
+     */
+    static constexpr bool hasDenseSources{details::has_sourceToIndex<TR>::value};
+    static constexpr bool hasDenseTargets{details::has_targetToIndex<TR>::value};
+    static constexpr size_t denseSourceCount{details::DenseSourceCount<TR>::value};
+    static constexpr size_t denseTargetCount{details::DenseTargetCount<TR>::value};
+
     std::unordered_map<typename TR::TargetIdentifier, float &> baseValues;
+    std::array<float *, denseTargetCount> denseBaseValues{};
     void bindTargetBaseValue(const typename TR::TargetIdentifier &t, float &f)
     {
         baseValues.erase(t);
         baseValues.insert_or_assign(t, f);
+        if constexpr (hasDenseTargets)
+        {
+            assert(TR::targetToIndex(t) < denseTargetCount);
+            denseBaseValues[TR::targetToIndex(t)] = &f;
+        }
     }
 
     std::unordered_map<typename TR::SourceIdentifier, float &> sourceValues;
+    std::array<float *, denseSourceCount> denseSourceValues{};
     void bindSourceValue(const typename TR::SourceIdentifier &s, float &f)
     {
         sourceValues.erase(s);
         sourceValues.insert_or_assign(s, f);
+        if constexpr (hasDenseSources)
+        {
+            assert(TR::sourceToIndex(s) < denseSourceCount);
+            denseSourceValues[TR::sourceToIndex(s)] = &f;
+        }
     }
 
     static constexpr bool canSelfModulate{details::has_isTargetModMatrixDepth<TR>::value};
@@ -102,7 +128,20 @@ struct ModMatrix : details::CheckModMatrixConstraints<ModMatrixTraits>
         }
     }
 
-    static constexpr bool supportsCurves{details::has_getCurveOperator<TR>::value};
+    /*
+     * Curves come from one of two trait hooks. getCurveOperator returns a
+     * std::function<float(float)>; getCurveFunction returns a plain float (*)(float) which
+     * avoids the std::function call and is preferred if both exist. A trait can also
+     * provide std::optional<std::pair<float, float>> getCurveDomain(CurveIdentifier) and
+     * if that returns a domain the curve is sampled into a lookup table at prepare time,
+     * with inputs clamped to the domain, which the SIMD matrices evaluate in registers.
+     */
+    static constexpr bool supportsCurveFunctions{details::has_getCurveFunction<TR>::value};
+    static constexpr bool supportsCurves{details::has_getCurveOperator<TR>::value ||
+                                         supportsCurveFunctions};
+    static constexpr bool supportsCurveLUTs{supportsCurves &&
+                                            details::has_getCurveDomain<TR>::value};
+    using curveFunction_t = float (*)(float);
     static constexpr bool supportsMultiplicative{details::has_getIsMultiplicative<TR>::value};
 };
 
@@ -164,6 +203,9 @@ template <typename ModMatrixTraits> struct FixedMatrix : ModMatrix<ModMatrixTrai
         float *source{nullptr}, *sourceVia{nullptr}, *depth{nullptr}, *target{nullptr};
         float depthScale{1.f};
         std::function<float(float)> curveFn;
+        typename PT::curveFunction_t curveFnPtr{nullptr};
+        const float *curveLUT{nullptr};
+        float curveLUTMin{0.f}, curveLUTScale{0.f};
         enum ApplicationMode
         {
             ADDITIVE,
@@ -172,6 +214,78 @@ template <typename ModMatrixTraits> struct FixedMatrix : ModMatrix<ModMatrixTrai
     };
     std::array<RoutingValuePointers, TR::FixedMatrixSize> routingValuePointers{};
 
+    /*
+     * prepare() compiles the routing state into a flat program which process() runs
+     * without touching any of the hash maps. The base value section copies each mapped
+     * target into its output slot and the route section is the packed set of routes with
+     * both a bound source and target, in table order (so depth modulation which feeds a
+     * later route still works). Active and depth are still read through pointers into the
+     * routing table so changing those doesn't require a re-prepare.
+     */
+    static constexpr size_t curveLUTSize{257};
+
+    struct ProgramBaseValue
+    {
+        const float *baseValue{nullptr};
+        float *output{nullptr};
+    };
+    struct ProgramRoute
+    {
+        const bool *active{nullptr};
+        const float *source{nullptr}, *sourceVia{nullptr}, *depth{nullptr};
+        float *target{nullptr};
+        float depthScale{1.f};
+        enum CurveMode
+        {
+            NO_CURVE,
+            CURVE_FUNCTION,
+            CURVE_OPERATOR,
+            CURVE_LUT
+        } curveMode{NO_CURVE};
+        typename PT::curveFunction_t curveFnPtr{nullptr};
+        const std::function<float(float)> *curveFn{nullptr};
+        const float *curveLUT{nullptr};
+        float curveLUTMin{0.f}, curveLUTScale{0.f};
+        typename RoutingValuePointers::ApplicationMode applicationMode{
+            RoutingValuePointers::ADDITIVE};
+
+        float applyCurve(float x) const
+        {
+            switch (curveMode)
+            {
+            case NO_CURVE:
+                break;
+            case CURVE_FUNCTION:
+                return curveFnPtr(x);
+            case CURVE_OPERATOR:
+                return (*curveFn)(x);
+            case CURVE_LUT:
+            {
+                auto p = std::clamp((x - curveLUTMin) * curveLUTScale, 0.f,
+                                    (float)(curveLUTSize - 1));
+                auto i = std::min((int)p, (int)curveLUTSize - 2);
+                auto f = p - i;
+                return curveLUT[i] * (1 - f) + curveLUT[i + 1] * f;
+            }
+            }
+            return x;
+        }
+    };
+    std::array<ProgramBaseValue, TR::FixedMatrixSize> programBaseValues{};
+    size_t numProgramBaseValues{0};
+    std::array<ProgramRoute, TR::FixedMatrixSize> programRoutes{};
+    size_t numProgramRoutes{0};
+
+    /*
+     * The distinct sources (including vias) read by the current program, so a host can
+     * skip computing modulators which feed nothing. After compactProgram this excludes
+     * sources which only feed inactive or zero depth routes.
+     */
+    std::array<typename TR::SourceIdentifier, 2 * TR::FixedMatrixSize> usedSources{};
+    size_t numUsedSources{0};
+    // With dense source indices the same set is also available as a mask by index
+    std::bitset<PT::denseSourceCount> usedSourceMask{};
+
     std::unordered_map<typename TR::TargetIdentifier, bool> isOutputMapped;
     std::unordered_map<typename TR::TargetIdentifier, size_t> targetToOutputIndex;
     std::unordered_map<typename TR::SourceIdentifier, bool> isSourceUsed;
@@ -181,6 +295,13 @@ template <typename ModMatrixTraits> struct FixedMatrix : ModMatrix<ModMatrixTrai
         isOutputMapped.clear();
         isSourceUsed.clear();
         targetToOutputIndex.clear();
+
+        // Bound values start unused so updateRoute can flip them without allocating
+        for (const auto &[tgt, v] : this->baseValues)
+            isOutputMapped[tgt] = false;
+        for (const auto &[src, v] : this->sourceValues)
+            isSourceUsed[src] = false;
+
         size_t outIdx{0};
         for (auto &r : rt.routes)
         {
@@ -204,59 +325,23 @@ template <typename ModMatrixTraits> struct FixedMatrix : ModMatrix<ModMatrixTrai
     {
         updateRoutingState(rt);
 
-        int idx{0};
+        std::fill(routingValuePointers.begin(), routingValuePointers.end(),
+                  RoutingValuePointers());
+        std::fill(depthOutputAt.begin(), depthOutputAt.end(), nullptr);
+
         std::unordered_set<typename TR::TargetIdentifier> depthMaps;
-        for (auto &r : rt.routes)
+        for (size_t i = 0; i < TR::FixedMatrixSize; ++i)
         {
-            if (!r.source.has_value() && !r.target.has_value())
-                continue;
-
-            auto &rv = routingValuePointers[idx];
-            rv = RoutingValuePointers();
-            idx++;
-            if (this->sourceValues.find(*r.source) == this->sourceValues.end())
-            {
-                continue;
-            }
-            if (this->targetToOutputIndex.find(*r.target) == this->targetToOutputIndex.end())
-            {
-                continue;
-            }
-
-            rv.source = &this->sourceValues.at(*r.source);
-            if (r.sourceVia.has_value())
-                rv.sourceVia = &this->sourceValues.at(*(r.sourceVia));
+            prepareRoute(rt, i);
 
             if constexpr (ModMatrix<TR>::canSelfModulate)
             {
-                if (TR::isTargetModMatrixDepth(*(r.target)))
+                const auto &r = rt.routes[i];
+                if (routingValuePointers[i].source && TR::isTargetModMatrixDepth(*(r.target)))
                 {
                     depthMaps.insert(*(r.target));
                 }
             }
-
-            rv.depthScale = 1.f;
-            rv.depth = &r.depth;
-            rv.active = &r.active;
-
-            if constexpr (ModMatrix<TR>::supportsCurves)
-            {
-                if (r.curve.has_value())
-                    rv.curveFn = TR::getCurveOperator(*(r.curve));
-                else
-                    rv.curveFn = nullptr;
-            }
-
-            rv.applicationMode = RoutingValuePointers::ADDITIVE;
-            if constexpr (ModMatrix<TR>::supportsMultiplicative)
-            {
-                if (TR::getIsMultiplicative(*(r.target)))
-                {
-                    rv.applicationMode = RoutingValuePointers::MULTIPLICATIVE;
-                }
-            }
-
-            rv.target = &matrixOutputs[targetToOutputIndex.at(*r.target)];
         }
 
         if constexpr (ModMatrix<TR>::canSelfModulate)
@@ -265,26 +350,56 @@ template <typename ModMatrixTraits> struct FixedMatrix : ModMatrix<ModMatrixTrai
             {
                 auto depthIndex = TR::getTargetModMatrixElement(m);
                 assert(depthIndex < routingValuePointers.size());
-                routingValuePointers[depthIndex].depth = &matrixOutputs[targetToOutputIndex.at(m)];
-                this->baseValues.insert_or_assign(m, rt.routes[depthIndex].depth);
+                depthOutputAt[depthIndex] = &matrixOutputs[targetToOutputIndex.at(m)];
+                routingValuePointers[depthIndex].depth = depthOutputAt[depthIndex];
+                this->bindTargetBaseValue(m, rt.routes[depthIndex].depth);
             }
         }
+
+        compileProgram();
     }
 
-    void process()
+    /*
+     * Recompile the program keeping only routes which are currently active and have a
+     * non-zero (or modulated) depth, and refresh usedSources to match. This doesn't
+     * allocate so it can run on the audio thread after the UI changes depth or activation,
+     * but unlike the full program from prepare, a dropped route stays silent until the
+     * next compactProgram or prepare, even if it is re-activated in the table.
+     */
+    void compactProgram() { compileProgram(true); }
+
+    /*
+     * Call this after changing the single route at position in a table which was
+     * previously prepared. If the change keeps the output slot assignment (the set of
+     * routed targets) and doesn't involve a depth target, the route is patched in place
+     * without allocating and the program is recompiled; otherwise this falls back to a full
+     * prepare. Returns whether the in-place path was taken.
+     */
+    bool updateRoute(RT &rt, size_t position)
     {
-        std::fill(matrixOutputs.begin(), matrixOutputs.end(), 0.f);
-
-        for (const auto &[tgt, outIdx] : targetToOutputIndex)
+        if (!canUpdateRouteInPlace(rt, position))
         {
-            matrixOutputs[outIdx] = this->baseValues.at(tgt);
+            prepare(rt);
+            return false;
         }
-        for (auto r : routingValuePointers)
+        patchRoute(rt, position);
+        compileProgram();
+        return true;
+    }
+
+    void process()
+    {
+        SST_BASIC_BLOCKS_PROBE("FixedMatrix::process");
+        for (size_t i = 0; i < numProgramBaseValues; ++i)
         {
-            if (r.active && !(*r.active))
-                continue;
+            const auto &b = programBaseValues[i];
+            *(b.output) = *(b.baseValue);
+        }
 
-            if (!r.source || !r.target)
+        for (size_t i = 0; i < numProgramRoutes; ++i)
+        {
+            const auto &r = programRoutes[i];
+            if (!(*r.active))
                 continue;
 
             float sourceViaVal{1.f};
@@ -295,10 +410,7 @@ template <typename ModMatrixTraits> struct FixedMatrix : ModMatrix<ModMatrixTrai
 
             if constexpr (ModMatrix<TR>::supportsCurves)
             {
-                if (r.curveFn)
-                {
-                    offs = r.curveFn(offs);
-                }
+                offs = r.applyCurve(offs);
             }
             switch (r.applicationMode)
             {
@@ -329,14 +441,24 @@ template <typename ModMatrixTraits> struct FixedMatrix : ModMatrix<ModMatrixTrai
 
     const float *getTargetValuePointer(const typename TR::TargetIdentifier &s) const
     {
-        auto f = isOutputMapped.find(s);
-        if (f == isOutputMapped.end() || !f->second)
+        if constexpr (PT::hasDenseTargets)
         {
-            return &this->baseValues.at(s);
+            auto idx = TR::targetToIndex(s);
+            assert(idx < PT::denseTargetCount);
+            auto o = denseTargetOutputs[idx];
+            return o ? o : this->denseBaseValues[idx];
         }
         else
         {
-            return &matrixOutputs[targetToOutputIndex.at(s)];
+            auto f = isOutputMapped.find(s);
+            if (f == isOutputMapped.end() || !f->second)
+            {
+                return &this->baseValues.at(s);
+            }
+            else
+            {
+                return &matrixOutputs[targetToOutputIndex.at(s)];
+            }
         }
     }
     float getTargetValue(const typename TR::TargetIdentifier &s) const
@@ -346,6 +468,244 @@ template <typename ModMatrixTraits> struct FixedMatrix : ModMatrix<ModMatrixTrai
             return *p;
         return 0;
     }
+
+  protected:
+    // Targets which are routed but have no bound base value start each block from zero
+    float unboundBaseValue{0.f};
+
+    // For dense targets, the output for each routed target index or nullptr if unrouted
+    std::array<float *, PT::denseTargetCount> denseTargetOutputs{};
+
+    // What each position was prepared with, so updateRoute can tell what changed
+    std::array<std::optional<typename TR::SourceIdentifier>, TR::FixedMatrixSize>
+        preparedSources{}, preparedSourceVias{};
+    std::array<std::optional<typename TR::TargetIdentifier>, TR::FixedMatrixSize>
+        preparedTargets{};
+    std::array<float *, TR::FixedMatrixSize> depthOutputAt{};
+
+    void prepareRoute(RT &rt, size_t position)
+    {
+        auto &r = rt.routes[position];
+        auto &rv = routingValuePointers[position];
+        rv = RoutingValuePointers();
+
+        bool routed = r.source.has_value() && r.target.has_value();
+        preparedSources[position] = routed ? r.source : std::nullopt;
+        preparedSourceVias[position] = routed ? r.sourceVia : std::nullopt;
+        preparedTargets[position] = routed ? r.target : std::nullopt;
+
+        if (!routed)
+            return;
+        if (this->sourceValues.find(*r.source) == this->sourceValues.end())
+            return;
+        if (targetToOutputIndex.find(*r.target) == targetToOutputIndex.end())
+            return;
+
+        rv.source = &this->sourceValues.at(*r.source);
+        if (r.sourceVia.has_value())
+            rv.sourceVia = &this->sourceValues.at(*(r.sourceVia));
+
+        rv.depthScale = 1.f;
+        rv.depth = &r.depth;
+        rv.active = &r.active;
+
+        if constexpr (ModMatrix<TR>::supportsCurves)
+        {
+            if (r.curve.has_value())
+            {
+                if constexpr (ModMatrix<TR>::supportsCurveFunctions)
+                    rv.curveFnPtr = TR::getCurveFunction(*(r.curve));
+                else
+                    rv.curveFn = TR::getCurveOperator(*(r.curve));
+                prepareCurveLUT(*(r.curve), position);
+            }
+        }
+
+        rv.applicationMode = RoutingValuePointers::ADDITIVE;
+        if constexpr (ModMatrix<TR>::supportsMultiplicative)
+        {
+            if (TR::getIsMultiplicative(*(r.target)))
+            {
+                rv.applicationMode = RoutingValuePointers::MULTIPLICATIVE;
+            }
+        }
+
+        rv.target = &matrixOutputs[targetToOutputIndex.at(*r.target)];
+    }
+
+    std::array<std::array<float, curveLUTSize>,
+               ModMatrix<TR>::supportsCurveLUTs ? TR::FixedMatrixSize : 0>
+        curveLUTs{};
+
+    void prepareCurveLUT(const typename TR::CurveIdentifier &c, size_t position)
+    {
+        if constexpr (ModMatrix<TR>::supportsCurveLUTs)
+        {
+            auto domain = TR::getCurveDomain(c);
+            if (!domain.has_value() || !(domain->second > domain->first))
+                return;
+
+            auto &rv = routingValuePointers[position];
+            auto &lut = curveLUTs[position];
+            auto [lo, hi] = *domain;
+            for (size_t i = 0; i < curveLUTSize; ++i)
+            {
+                auto x = lo + (hi - lo) * i / (curveLUTSize - 1);
+                lut[i] = rv.curveFnPtr ? rv.curveFnPtr(x) : rv.curveFn(x);
+            }
+            rv.curveLUT = lut.data();
+            rv.curveLUTMin = lo;
+            rv.curveLUTScale = (curveLUTSize - 1) / (hi - lo);
+        }
+    }
+
+    bool isTargetUsedOutside(const typename TR::TargetIdentifier &t, size_t position) const
+    {
+        for (size_t i = 0; i < TR::FixedMatrixSize; ++i)
+        {
+            if (i != position && preparedTargets[i].has_value() && *preparedTargets[i] == t)
+                return true;
+        }
+        return false;
+    }
+
+    bool canUpdateRouteInPlace(const RT &rt, size_t position) const
+    {
+        assert(position < TR::FixedMatrixSize);
+        const auto &r = rt.routes[position];
+        bool routed = r.source.has_value() && r.target.has_value();
+        auto newT = routed ? r.target : std::nullopt;
+        const auto &oldT = preparedTargets[position];
+
+        if constexpr (ModMatrix<TR>::canSelfModulate)
+        {
+            if ((oldT.has_value() && TR::isTargetModMatrixDepth(*oldT)) ||
+                (newT.has_value() && TR::isTargetModMatrixDepth(*newT)))
+                return false;
+        }
+
+        // a source new to the matrix would need a node in isSourceUsed, so rebuild for it
+        auto isKnown = [this](const auto &s) { return isSourceUsed.find(s) != isSourceUsed.end(); };
+        if (routed && (!isKnown(*r.source) || (r.sourceVia.has_value() && !isKnown(*r.sourceVia))))
+            return false;
+
+        if (oldT == newT)
+            return true;
+
+        // a target which gains its first route needs a new output slot
+        if (newT.has_value() && targetToOutputIndex.find(*newT) == targetToOutputIndex.end())
+            return false;
+        // and one which loses its last route frees one
+        if (oldT.has_value() && !isTargetUsedOutside(*oldT, position))
+            return false;
+        return true;
+    }
+
+    void patchRoute(RT &rt, size_t position)
+    {
+        prepareRoute(rt, position);
+        if (depthOutputAt[position] && routingValuePointers[position].source)
+            routingValuePointers[position].depth = depthOutputAt[position];
+
+        // canUpdateRouteInPlace made sure every source is already in the map, so this
+        // only flips existing entries and never allocates
+        auto markUsed = [this](const auto &s) {
+            auto it = isSourceUsed.find(s);
+            assert(it != isSourceUsed.end());
+            if (it != isSourceUsed.end())
+                it->second = true;
+        };
+        for (auto &[src, used] : isSourceUsed)
+            used = false;
+        for (size_t i = 0; i < TR::FixedMatrixSize; ++i)
+        {
+            if (preparedSources[i].has_value())
+                markUsed(*preparedSources[i]);
+            if (preparedSourceVias[i].has_value())
+                markUsed(*preparedSourceVias[i]);
+        }
+    }
+
+    // the program points into matrixOutputs; map that back to a slot, or -1 if not an output
+    int outputIndexOf(const float *f) const
+    {
+        auto b = matrixOutputs.data();
+        auto lt = std::less<const float *>();
+        if (lt(f, b) || !lt(f, b + TR::FixedMatrixSize))
+            return -1;
+        return (int)(f - b);
+    }
+
+    void addUsedSource(const typename TR::SourceIdentifier &s)
+    {
+        for (size_t i = 0; i < numUsedSources; ++i)
+            if (usedSources[i] == s)
+                return;
+        usedSources[numUsedSources++] = s;
+        if constexpr (PT::hasDenseSources)
+            usedSourceMask.set(TR::sourceToIndex(s));
+    }
+
+    void compileProgram(bool dropIdleRoutes = false)
+    {
+        std::fill(matrixOutputs.begin(), matrixOutputs.end(), 0.f);
+
+        numProgramBaseValues = 0;
+        if constexpr (PT::hasDenseTargets)
+            std::fill(denseTargetOutputs.begin(), denseTargetOutputs.end(), nullptr);
+        for (const auto &[tgt, outIdx] : targetToOutputIndex)
+        {
+            if constexpr (PT::hasDenseTargets)
+                denseTargetOutputs[TR::targetToIndex(tgt)] = &matrixOutputs[outIdx];
+
+            auto &b = programBaseValues[numProgramBaseValues];
+            auto bv = this->baseValues.find(tgt);
+            b.baseValue = (bv == this->baseValues.end()) ? &unboundBaseValue : &(bv->second);
+            b.output = &matrixOutputs[outIdx];
+            numProgramBaseValues++;
+        }
+
+        numProgramRoutes = 0;
+        numUsedSources = 0;
+        usedSourceMask.reset();
+        for (size_t i = 0; i < TR::FixedMatrixSize; ++i)
+        {
+            const auto &rv = routingValuePointers[i];
+            if (!rv.source || !rv.target || !rv.active)
+                continue;
+
+            // a modulated depth can be non-zero even if the table depth is zero
+            if (dropIdleRoutes && (!(*rv.active) || (!depthOutputAt[i] && *rv.depth == 0.f)))
+                continue;
+
+            assert(preparedSources[i].has_value());
+            addUsedSource(*preparedSources[i]);
+            if (preparedSourceVias[i].has_value())
+                addUsedSource(*preparedSourceVias[i]);
+
+            auto &p = programRoutes[numProgramRoutes];
+            p.active = rv.active;
+            p.source = rv.source;
+            p.sourceVia = rv.sourceVia;
+            p.depth = rv.depth;
+            p.target = rv.target;
+            p.depthScale = rv.depthScale;
+            p.curveMode = ProgramRoute::NO_CURVE;
+            p.curveFnPtr = rv.curveFnPtr;
+            p.curveFn = rv.curveFn ? &rv.curveFn : nullptr;
+            p.curveLUT = rv.curveLUT;
+            p.curveLUTMin = rv.curveLUTMin;
+            p.curveLUTScale = rv.curveLUTScale;
+            if (rv.curveLUT)
+                p.curveMode = ProgramRoute::CURVE_LUT;
+            else if (rv.curveFnPtr)
+                p.curveMode = ProgramRoute::CURVE_FUNCTION;
+            else if (rv.curveFn)
+                p.curveMode = ProgramRoute::CURVE_OPERATOR;
+            p.applicationMode = rv.applicationMode;
+            numProgramRoutes++;
+        }
+    }
 };
 
 } // namespace sst::basic_blocks::mod_matrix
@@ -29,6 +29,7 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <cstddef>
 
 namespace sst::basic_blocks::mod_matrix::details
 {
@@ -53,7 +54,21 @@ namespace sst::basic_blocks::mod_matrix::details
 HAS_MEMBER(isTargetModMatrixDepth)
 HAS_MEMBER(getTargetModMatrixElement)
 HAS_MEMBER(getCurveOperator)
+HAS_MEMBER(getCurveFunction)
+HAS_MEMBER(getCurveDomain)
+HAS_MEMBER(sourceToIndex)
+HAS_MEMBER(DenseSourceCount)
+HAS_MEMBER(targetToIndex)
+HAS_MEMBER(DenseTargetCount)
 HAS_MEMBER(getIsMultiplicative)
+HAS_MEMBER(sourceToStream)
+HAS_MEMBER(sourceFromStream)
+HAS_MEMBER(targetToStream)
+HAS_MEMBER(targetFromStream)
+HAS_MEMBER(curveToStream)
+HAS_MEMBER(curveFromStream)
+HAS_MEMBER(payloadToStream)
+HAS_MEMBER(payloadFromStream)
 #undef HAS_MEMBER
 
 struct detailTypeNo
@@ -70,6 +85,25 @@ template <typename T, typename Arg = T> struct has_operator_equal
     };
 };
 
+template <typename TR, bool hasDense = has_DenseSourceCount<TR>::value>
+struct DenseSourceCount
+{
+    static constexpr size_t value{0};
+};
+template <typename TR> struct DenseSourceCount<TR, true>
+{
+    static constexpr size_t value{TR::DenseSourceCount};
+};
+template <typename TR, bool hasDense = has_DenseTargetCount<TR>::value>
+struct DenseTargetCount
+{
+    static constexpr size_t value{0};
+};
+template <typename TR> struct DenseTargetCount<TR, true>
+{
+    static constexpr size_t value{TR::DenseTargetCount};
+};
+
 template <typename TR> struct CheckModMatrixConstraints
 {
     static_assert(std::is_constructible<typename TR::SourceIdentifier>::value,
@@ -99,6 +133,12 @@ template <typename TR> struct CheckModMatrixConstraints
     static_assert(std::is_constructible<typename TR::RoutingExtraPayload>::value,
                   "RoutingExtraPayload must be a constructible type");
 
+    // Dense indices
+    static_assert(!has_sourceToIndex<TR>::value || has_DenseSourceCount<TR>::value,
+                  "sourceToIndex requires a static constexpr size_t DenseSourceCount");
+    static_assert(!has_targetToIndex<TR>::value || has_DenseTargetCount<TR>::value,
+                  "targetToIndex requires a static constexpr size_t DenseTargetCount");
+
     // Self Modulation
     static_assert(!has_isTargetModMatrixDepth<TR>::value ||
                       (TR::IsFixedMatrix && has_getTargetModMatrixElement<TR>::value),
@@ -0,0 +1,77 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_MODMATRIXSIMDDETAILS_H
+#define INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_MODMATRIXSIMDDETAILS_H
+
+/*
+ * Shared SSE helpers for the block and lane matrices. As with the rest of the SIMD
+ * code, include your SSE (or SIMDE) headers first.
+ */
+namespace sst::basic_blocks::mod_matrix::details
+{
+/*
+ * Apply a prepared route's curve to four values. Lookup table curves are evaluated in
+ * registers (the table reads are scalar since SSE2 has no gather); the function curves
+ * fall back to one call per lane.
+ */
+template <typename ProgramRoute, size_t lutSize>
+inline __m128 applyCurveSSE(const ProgramRoute &r, __m128 x)
+{
+    switch (r.curveMode)
+    {
+    case ProgramRoute::NO_CURVE:
+        return x;
+    case ProgramRoute::CURVE_LUT:
+    {
+        auto p = _mm_mul_ps(_mm_sub_ps(x, _mm_set1_ps(r.curveLUTMin)),
+                            _mm_set1_ps(r.curveLUTScale));
+        p = _mm_max_ps(_mm_setzero_ps(), _mm_min_ps(p, _mm_set1_ps((float)(lutSize - 1))));
+        // the last segment takes p == lutSize - 1 as f == 1
+        auto pi = _mm_cvttps_epi32(_mm_min_ps(p, _mm_set1_ps((float)(lutSize - 2))));
+        auto f = _mm_sub_ps(p, _mm_cvtepi32_ps(pi));
+
+        int idx alignas(16)[4];
+        _mm_store_si128((__m128i *)idx, pi);
+        auto lo = _mm_setr_ps(r.curveLUT[idx[0]], r.curveLUT[idx[1]], r.curveLUT[idx[2]],
+                              r.curveLUT[idx[3]]);
+        auto hi = _mm_setr_ps(r.curveLUT[idx[0] + 1], r.curveLUT[idx[1] + 1],
+                              r.curveLUT[idx[2] + 1], r.curveLUT[idx[3] + 1]);
+        return _mm_add_ps(lo, _mm_mul_ps(f, _mm_sub_ps(hi, lo)));
+    }
+    default:
+    {
+        float v alignas(16)[4];
+        _mm_store_ps(v, x);
+        for (auto &f : v)
+            f = r.applyCurve(f);
+        return _mm_load_ps(v);
+    }
+    }
+}
+} // namespace sst::basic_blocks::mod_matrix::details
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_MODMATRIXSIMDDETAILS_H
@@ -0,0 +1,419 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_ROUTINGTABLESERIALIZATION_H
+#define INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_ROUTINGTABLESERIALIZATION_H
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "ModMatrix.h"
+#include "sst/basic-blocks/mechanics/endian-ops.h"
+
+/*
+ * A compact, versioned binary format for a FixedLengthRoutingTable. The stream is a 16
+ * byte header followed by one fixed size record per route, all little endian and
+ * naturally aligned, so an encoded table can be read in place (from a memory mapped
+ * patch bank, say) with RoutingTableView and needs no parsing beyond a header check.
+ *
+ *   header: uint32 magic 'sbrt', uint16 version, uint16 record bytes, uint32 route count,
+ *           uint32 reserved
+ *   record: uint64 source, sourceVia, target, curve, extraPayload; float32 depth;
+ *           uint32 flags (active and which of the optionals are present)
+ *
+ * Identifiers are written as 64 bit values. Integral and enum identifiers are handled
+ * directly; any other type needs a pair of static trait hooks, for example
+ * uint64_t sourceToStream(const SourceIdentifier &) and
+ * SourceIdentifier sourceFromStream(uint64_t), with the same for target, curve and
+ * payload. A reader accepts records longer than its own, so later versions can append
+ * fields, and a stream with fewer routes than the table leaves the rest empty.
+ *
+ * loadInto decodes over the table a matrix was prepared from and patches only the
+ * positions whose identifiers changed with updateRoute, so a patch change which keeps
+ * most routes skips the hashing of a full prepare. Depth and activation changes need no
+ * patching at all since the prepared program reads them from the table.
+ */
+namespace sst::basic_blocks::mod_matrix
+{
+enum struct RoutingStreamStatus : uint8_t
+{
+    OK,
+    TOO_SHORT,
+    BAD_MAGIC,
+    UNSUPPORTED_VERSION,
+    TOO_MANY_ROUTES
+};
+
+namespace details
+{
+template <typename T> inline uint64_t integralToStream(const T &t)
+{
+    if constexpr (std::is_enum_v<T>)
+        return (uint64_t)(int64_t)static_cast<std::underlying_type_t<T>>(t);
+    else
+        return (uint64_t)(int64_t)t;
+}
+template <typename T> inline T integralFromStream(uint64_t v)
+{
+    if constexpr (std::is_enum_v<T>)
+        return static_cast<T>(static_cast<std::underlying_type_t<T>>((int64_t)v));
+    else
+        return static_cast<T>((int64_t)v);
+}
+
+inline void streamWrite32(uint8_t *p, uint32_t v)
+{
+    uint32_t w = (uint32_t)mechanics::endian_write_int32LE(v);
+    memcpy(p, &w, sizeof(w));
+}
+inline uint32_t streamRead32(const uint8_t *p)
+{
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return (uint32_t)mechanics::endian_read_int32LE(w);
+}
+inline void streamWrite16(uint8_t *p, uint16_t v)
+{
+    uint16_t w = (uint16_t)mechanics::endian_write_int16LE(v);
+    memcpy(p, &w, sizeof(w));
+}
+inline uint16_t streamRead16(const uint8_t *p)
+{
+    uint16_t w;
+    memcpy(&w, p, sizeof(w));
+    return (uint16_t)mechanics::endian_read_int16LE(w);
+}
+inline void streamWrite64(uint8_t *p, uint64_t v)
+{
+    streamWrite32(p, (uint32_t)v);
+    streamWrite32(p + 4, (uint32_t)(v >> 32));
+}
+inline uint64_t streamRead64(const uint8_t *p)
+{
+    return (uint64_t)streamRead32(p) | ((uint64_t)streamRead32(p + 4) << 32);
+}
+inline void streamWriteFloat(uint8_t *p, float f)
+{
+    f = mechanics::endian_write_float32LE(f);
+    memcpy(p, &f, sizeof(f));
+}
+inline float streamReadFloat(const uint8_t *p)
+{
+    float f;
+    memcpy(&f, p, sizeof(f));
+    return mechanics::endian_read_float32LE(f);
+}
+} // namespace details
+
+template <typename ModMatrixTraits> struct RoutingTableStream
+{
+    using TR = ModMatrixTraits;
+    using RT = FixedLengthRoutingTable<TR>;
+    using Routing = typename RT::Routing;
+
+    // the bytes of "sbrt" read as a little endian uint32
+    static constexpr uint32_t magic{0x74726273};
+    static constexpr uint16_t version{1};
+    static constexpr size_t headerBytes{16};
+    static constexpr size_t recordBytes{48};
+    static constexpr size_t bytesRequired{headerBytes + recordBytes * TR::FixedMatrixSize};
+
+    enum Flags : uint32_t
+    {
+        ACTIVE = 1 << 0,
+        HAS_SOURCE = 1 << 1,
+        HAS_SOURCE_VIA = 1 << 2,
+        HAS_TARGET = 1 << 3,
+        HAS_CURVE = 1 << 4,
+        HAS_PAYLOAD = 1 << 5
+    };
+
+    /*
+     * Writes rt to dst, which needs bytesRequired bytes. Returns the bytes written, or 0
+     * if capacity is too small.
+     */
+    static size_t encode(const RT &rt, uint8_t *dst, size_t capacity)
+    {
+        if (!dst || capacity < bytesRequired)
+            return 0;
+
+        details::streamWrite32(dst, magic);
+        details::streamWrite16(dst + 4, version);
+        details::streamWrite16(dst + 6, (uint16_t)recordBytes);
+        details::streamWrite32(dst + 8, (uint32_t)TR::FixedMatrixSize);
+        details::streamWrite32(dst + 12, 0);
+
+        auto p = dst + headerBytes;
+        for (const auto &r : rt.routes)
+        {
+            uint32_t flags = r.active ? (uint32_t)ACTIVE : 0u;
+            uint64_t s{0}, sv{0}, t{0}, c{0}, x{0};
+            if (r.source.has_value())
+            {
+                flags |= HAS_SOURCE;
+                s = sourceToStream(*r.source);
+            }
+            if (r.sourceVia.has_value())
+            {
+                flags |= HAS_SOURCE_VIA;
+                sv = sourceToStream(*r.sourceVia);
+            }
+            if (r.target.has_value())
+            {
+                flags |= HAS_TARGET;
+                t = targetToStream(*r.target);
+            }
+            if (r.curve.has_value())
+            {
+                flags |= HAS_CURVE;
+                c = curveToStream(*r.curve);
+            }
+            if (r.extraPayload.has_value())
+            {
+                flags |= HAS_PAYLOAD;
+                x = payloadToStream(*r.extraPayload);
+            }
+            details::streamWrite64(p, s);
+            details::streamWrite64(p + 8, sv);
+            details::streamWrite64(p + 16, t);
+            details::streamWrite64(p + 24, c);
+            details::streamWrite64(p + 32, x);
+            details::streamWriteFloat(p + 40, r.depth);
+            details::streamWrite32(p + 44, flags);
+            p += recordBytes;
+        }
+        return bytesRequired;
+    }
+
+    static std::vector<uint8_t> encode(const RT &rt)
+    {
+        std::vector<uint8_t> res(bytesRequired);
+        encode(rt, res.data(), res.size());
+        return res;
+    }
+
+    /*
+     * A read only view of an encoded table which decodes routes on demand. The view
+     * doesn't copy, so data has to outlive it.
+     */
+    struct View
+    {
+        View(const uint8_t *d, size_t size) : data(d) { status = check(size); }
+
+        RoutingStreamStatus status{RoutingStreamStatus::TOO_SHORT};
+        explicit operator bool() const { return status == RoutingStreamStatus::OK; }
+
+        size_t size() const { return count; }
+
+        Routing route(size_t i) const
+        {
+            assert(status == RoutingStreamStatus::OK && i < count);
+            auto p = data + headerBytes + i * stride;
+            auto flags = details::streamRead32(p + 44);
+
+            Routing r;
+            r.active = flags & ACTIVE;
+            if (flags & HAS_SOURCE)
+                r.source = sourceFromStream(details::streamRead64(p));
+            if (flags & HAS_SOURCE_VIA)
+                r.sourceVia = sourceFromStream(details::streamRead64(p + 8));
+            if (flags & HAS_TARGET)
+                r.target = targetFromStream(details::streamRead64(p + 16));
+            if (flags & HAS_CURVE)
+                r.curve = curveFromStream(details::streamRead64(p + 24));
+            if (flags & HAS_PAYLOAD)
+                r.extraPayload = payloadFromStream(details::streamRead64(p + 32));
+            r.depth = details::streamReadFloat(p + 40);
+            return r;
+        }
+
+      private:
+        const uint8_t *data{nullptr};
+        size_t count{0}, stride{recordBytes};
+
+        RoutingStreamStatus check(size_t size)
+        {
+            if (!data || size < headerBytes)
+                return RoutingStreamStatus::TOO_SHORT;
+            if (details::streamRead32(data) != magic)
+                return RoutingStreamStatus::BAD_MAGIC;
+            auto ver = details::streamRead16(data + 4);
+            stride = details::streamRead16(data + 6);
+            if (ver == 0 || ver > version || stride < recordBytes)
+                return RoutingStreamStatus::UNSUPPORTED_VERSION;
+            count = details::streamRead32(data + 8);
+            if (count > TR::FixedMatrixSize)
+            {
+                count = 0;
+                return RoutingStreamStatus::TOO_MANY_ROUTES;
+            }
+            if ((size - headerBytes) / stride < count)
+            {
+                count = 0;
+                return RoutingStreamStatus::TOO_SHORT;
+            }
+            return RoutingStreamStatus::OK;
+        }
+    };
+
+    // Replaces every route of rt; rt is left untouched unless the stream is valid
+    static RoutingStreamStatus decode(const uint8_t *data, size_t size, RT &rt)
+    {
+        View v(data, size);
+        if (!v)
+            return v.status;
+        for (size_t i = 0; i < TR::FixedMatrixSize; ++i)
+            rt.routes[i] = i < v.size() ? v.route(i) : Routing();
+        return RoutingStreamStatus::OK;
+    }
+
+    /*
+     * Decodes over rt, the table m was prepared from, and updates m's program to match.
+     * Positions whose source, via, target or curve change are patched with updateRoute,
+     * which falls back to a full prepare when a patch can't be done in place.
+     */
+    template <typename Matrix>
+    static RoutingStreamStatus loadInto(Matrix &m, RT &rt, const uint8_t *data, size_t size)
+    {
+        View v(data, size);
+        if (!v)
+            return v.status;
+
+        std::array<bool, TR::FixedMatrixSize> changed{};
+        for (size_t i = 0; i < TR::FixedMatrixSize; ++i)
+        {
+            auto r = i < v.size() ? v.route(i) : Routing();
+            auto &o = rt.routes[i];
+            changed[i] = !(r.source == o.source && r.sourceVia == o.sourceVia &&
+                           r.target == o.target && r.curve == o.curve);
+            o = r;
+        }
+
+        // a patch only reads its own position, and a fallback prepare covers the rest
+        for (size_t i = 0; i < TR::FixedMatrixSize; ++i)
+            if (changed[i] && !m.updateRoute(rt, i))
+                break;
+        return RoutingStreamStatus::OK;
+    }
+
+  private:
+    using SI = typename TR::SourceIdentifier;
+    using TI = typename TR::TargetIdentifier;
+    using CI = typename TR::CurveIdentifier;
+    using PI = typename TR::RoutingExtraPayload;
+
+    template <typename T> static constexpr bool isIntegralId{std::is_integral_v<T> ||
+                                                             std::is_enum_v<T>};
+
+    static uint64_t sourceToStream(const SI &s)
+    {
+        if constexpr (details::has_sourceToStream<TR>::value)
+            return TR::sourceToStream(s);
+        else
+        {
+            static_assert(isIntegralId<SI>, "Non integral sources need sourceToStream");
+            return details::integralToStream(s);
+        }
+    }
+    static SI sourceFromStream(uint64_t v)
+    {
+        if constexpr (details::has_sourceFromStream<TR>::value)
+            return TR::sourceFromStream(v);
+        else
+        {
+            static_assert(isIntegralId<SI>, "Non integral sources need sourceFromStream");
+            return details::integralFromStream<SI>(v);
+        }
+    }
+    static uint64_t targetToStream(const TI &t)
+    {
+        if constexpr (details::has_targetToStream<TR>::value)
+            return TR::targetToStream(t);
+        else
+        {
+            static_assert(isIntegralId<TI>, "Non integral targets need targetToStream");
+            return details::integralToStream(t);
+        }
+    }
+    static TI targetFromStream(uint64_t v)
+    {
+        if constexpr (details::has_targetFromStream<TR>::value)
+            return TR::targetFromStream(v);
+        else
+        {
+            static_assert(isIntegralId<TI>, "Non integral targets need targetFromStream");
+            return details::integralFromStream<TI>(v);
+        }
+    }
+    static uint64_t curveToStream(const CI &c)
+    {
+        if constexpr (details::has_curveToStream<TR>::value)
+            return TR::curveToStream(c);
+        else
+        {
+            static_assert(isIntegralId<CI>, "Non integral curves need curveToStream");
+            return details::integralToStream(c);
+        }
+    }
+    static CI curveFromStream(uint64_t v)
+    {
+        if constexpr (details::has_curveFromStream<TR>::value)
+            return TR::curveFromStream(v);
+        else
+        {
+            static_assert(isIntegralId<CI>, "Non integral curves need curveFromStream");
+            return details::integralFromStream<CI>(v);
+        }
+    }
+    static uint64_t payloadToStream(const PI &x)
+    {
+        if constexpr (details::has_payloadToStream<TR>::value)
+            return TR::payloadToStream(x);
+        else
+        {
+            static_assert(isIntegralId<PI>, "Non integral payloads need payloadToStream");
+            return details::integralToStream(x);
+        }
+    }
+    static PI payloadFromStream(uint64_t v)
+    {
+        if constexpr (details::has_payloadFromStream<TR>::value)
+            return TR::payloadFromStream(v);
+        else
+        {
+            static_assert(isIntegralId<PI>, "Non integral payloads need payloadFromStream");
+            return details::integralFromStream<PI>(v);
+        }
+    }
+};
+} // namespace sst::basic_blocks::mod_matrix
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_ROUTINGTABLESERIALIZATION_H
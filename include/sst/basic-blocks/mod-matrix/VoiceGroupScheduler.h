@@ -0,0 +1,267 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_VOICEGROUPSCHEDULER_H
+#define INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_VOICEGROUPSCHEDULER_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+
+#include "FixedLaneMatrix.h"
+#include "sst/basic-blocks/modulators/ADSREnvelopeBank.h"
+#include "sst/basic-blocks/modulators/SimpleLFOBank.h"
+#include "sst/basic-blocks/mechanics/memory-arena.h"
+#include "sst/basic-blocks/mechanics/instrumentation.h"
+
+/*
+ * An optional scheduler which owns the per voice modulation of a polyphonic engine. Voices
+ * are handled in groups of four, one per SIMD lane, and each group holds an
+ * ADSREnvelopeBank, a SimpleLFOBank with LFOsPerVoice lanes per voice and a
+ * FixedLaneMatrix together with the per voice parameters those consume. All the groups
+ * live in one contiguous arena allocated at construction.
+ *
+ * processGroups renders a range of groups stage by stage: the envelopes of a tile of
+ * GroupsPerTile groups, then their LFOs, then their matrices, so the modulator outputs a
+ * matrix reads are still in cache and each stage's code runs over several groups in a row.
+ * Groups whose voices are all idle are skipped. Groups share no mutable state, so a host
+ * can hand disjoint ranges (see workRange) to different threads; binding, prepare and
+ * attack calls must not overlap a render.
+ *
+ * The envelope output and the end of block value of each LFO are bound to every group's
+ * matrix with bindEnvelopeSource and bindLFOSource. Target base values are per group and
+ * are bound on group(g).matrix. Include your SSE headers before this one.
+ */
+namespace sst::basic_blocks::mod_matrix
+{
+template <typename ModMatrixTraits, typename SRProvider, int BLOCK_SIZE, int NumVoices,
+          int LFOsPerVoice = 1, int GroupsPerTile = 4>
+struct VoiceGroupScheduler
+{
+    static_assert(NumVoices > 0 && !(NumVoices & 3), "NumVoices must be a multiple of 4");
+    static_assert(LFOsPerVoice > 0 && GroupsPerTile > 0);
+
+    static constexpr int voicesPerGroup{4};
+    static constexpr int numGroups{NumVoices / voicesPerGroup};
+    static constexpr int numLFOLanes{LFOsPerVoice * voicesPerGroup};
+
+    using TR = ModMatrixTraits;
+    using envBank_t = modulators::ADSREnvelopeBank<SRProvider, BLOCK_SIZE, voicesPerGroup>;
+    using lfoBank_t = modulators::SimpleLFOBank<SRProvider, BLOCK_SIZE, numLFOLanes>;
+    using matrix_t = FixedLaneMatrix<TR>;
+    using RT = typename matrix_t::RT;
+
+    struct Group
+    {
+        Group(SRProvider *sr, uint32_t seed) : env(sr), lfo(sr, seed) {}
+
+        envBank_t env;
+        // lane k * 4 + l is LFO k of voice l, so each register holds one LFO for four voices
+        lfoBank_t lfo;
+        matrix_t matrix;
+
+        // per voice envelope parameters, as ADSREnvelopeBank::processBlock
+        float envA alignas(16)[voicesPerGroup]{}, envD alignas(16)[voicesPerGroup]{};
+        float envS alignas(16)[voicesPerGroup]{}, envR alignas(16)[voicesPerGroup]{};
+        int envAShape[voicesPerGroup]{}, envDShape[voicesPerGroup]{};
+        int envRShape[voicesPerGroup]{};
+        bool gate[voicesPerGroup]{};
+
+        // per LFO lane parameters, as SimpleLFOBank::process_block
+        float lfoRate alignas(16)[numLFOLanes]{}, lfoDeform alignas(16)[numLFOLanes]{};
+        int lfoShape[numLFOLanes]{};
+        bool lfoReverse{false};
+
+        // the last sample of each LFO block, per voice, as bound to the matrix
+        float lfoValue alignas(16)[LFOsPerVoice][voicesPerGroup]{};
+
+        bool isActive() const
+        {
+            for (int l = 0; l < voicesPerGroup; ++l)
+                if (gate[l] || !env.isQuiescent(l))
+                    return true;
+            return false;
+        }
+    };
+
+    /*
+     * The LFO bank of group g is seeded with seed + g * numLFOLanes, so every LFO lane in
+     * the scheduler gets its own random sequence.
+     */
+    VoiceGroupScheduler(SRProvider *sr, uint32_t seed = 8675309)
+        : arena(sizeof(Group) * numGroups + alignof(Group))
+    {
+        groups = static_cast<Group *>(arena.allocate(sizeof(Group) * numGroups, alignof(Group)));
+        assert(groups);
+        for (int g = 0; g < numGroups; ++g)
+            new (groups + g) Group(sr, seed + (uint32_t)(g * numLFOLanes));
+    }
+
+    ~VoiceGroupScheduler()
+    {
+        for (int g = 0; g < numGroups; ++g)
+            groups[g].~Group();
+    }
+
+    VoiceGroupScheduler(const VoiceGroupScheduler &) = delete;
+    VoiceGroupScheduler &operator=(const VoiceGroupScheduler &) = delete;
+    VoiceGroupScheduler(VoiceGroupScheduler &&) = delete;
+    VoiceGroupScheduler &operator=(VoiceGroupScheduler &&) = delete;
+
+    Group &group(int g)
+    {
+        assert(g >= 0 && g < numGroups);
+        return groups[g];
+    }
+    const Group &group(int g) const
+    {
+        assert(g >= 0 && g < numGroups);
+        return groups[g];
+    }
+    Group &groupForVoice(int v) { return group(v / voicesPerGroup); }
+    static constexpr int laneForVoice(int v) { return v % voicesPerGroup; }
+
+    void bindEnvelopeSource(const typename TR::SourceIdentifier &s)
+    {
+        for (int g = 0; g < numGroups; ++g)
+            groups[g].matrix.bindSourceLanes(s, groups[g].env.output);
+    }
+
+    void bindLFOSource(int k, const typename TR::SourceIdentifier &s)
+    {
+        assert(k >= 0 && k < LFOsPerVoice);
+        for (int g = 0; g < numGroups; ++g)
+            groups[g].matrix.bindSourceLanes(s, groups[g].lfoValue[k]);
+    }
+
+    // Every group shares the routing table. Bind sources and base values first.
+    void prepare(RT &rt)
+    {
+        for (int g = 0; g < numGroups; ++g)
+            groups[g].matrix.prepare(rt);
+    }
+
+    // Opens the gate of voice v, starts its envelope from fromValue and restarts its LFOs
+    void attack(int v, float fromValue = 0.f)
+    {
+        auto &gr = groupForVoice(v);
+        auto l = laneForVoice(v);
+        gr.gate[l] = true;
+        gr.env.attackFrom(l, fromValue, gr.envAShape[l]);
+        for (int k = 0; k < LFOsPerVoice; ++k)
+            gr.lfo.attack(k * voicesPerGroup + l);
+    }
+
+    void release(int v) { groupForVoice(v).gate[laneForVoice(v)] = false; }
+
+    void immediatelySilence(int v)
+    {
+        auto &gr = groupForVoice(v);
+        auto l = laneForVoice(v);
+        gr.gate[l] = false;
+        gr.env.immediatelySilence(l);
+    }
+
+    bool isQuiescent(int v) const
+    {
+        auto &gr = group(v / voicesPerGroup);
+        auto l = laneForVoice(v);
+        return !gr.gate[l] && gr.env.isQuiescent(l);
+    }
+
+    /*
+     * Renders one block for groups [begin, end). Ranges which don't overlap can run at
+     * the same time on different threads.
+     */
+    void processGroups(int begin, int end)
+    {
+        SST_BASIC_BLOCKS_PROBE("VoiceGroupScheduler::processGroups");
+        assert(begin >= 0 && begin <= end && end <= numGroups);
+
+        for (int t0 = begin; t0 < end; t0 += GroupsPerTile)
+        {
+            auto t1 = std::min(t0 + GroupsPerTile, end);
+
+            bool active[GroupsPerTile];
+            for (int g = t0; g < t1; ++g)
+                active[g - t0] = groups[g].isActive();
+
+            for (int g = t0; g < t1; ++g)
+            {
+                if (!active[g - t0])
+                    continue;
+                auto &gr = groups[g];
+                gr.env.processBlock(gr.envA, gr.envD, gr.envS, gr.envR, gr.envAShape,
+                                    gr.envDShape, gr.envRShape, gr.gate);
+            }
+
+            for (int g = t0; g < t1; ++g)
+            {
+                if (!active[g - t0])
+                    continue;
+                auto &gr = groups[g];
+                gr.lfo.process_block(gr.lfoRate, gr.lfoDeform, gr.lfoShape, gr.lfoReverse);
+                for (int k = 0; k < LFOsPerVoice; ++k)
+                    for (int l = 0; l < voicesPerGroup; ++l)
+                        gr.lfoValue[k][l] =
+                            gr.lfo.outputBlock[k * voicesPerGroup + l][BLOCK_SIZE - 1];
+            }
+
+            for (int g = t0; g < t1; ++g)
+            {
+                if (active[g - t0])
+                    groups[g].matrix.process();
+            }
+        }
+    }
+
+    void process() { processGroups(0, numGroups); }
+
+    struct WorkRange
+    {
+        int begin{0}, end{0};
+    };
+
+    /*
+     * Splits the groups into numWorkers contiguous ranges of near equal size. Worker w
+     * renders processGroups(r.begin, r.end); a range may be empty when there are more
+     * workers than groups.
+     */
+    static constexpr WorkRange workRange(int worker, int numWorkers)
+    {
+        assert(numWorkers > 0 && worker >= 0 && worker < numWorkers);
+        return {(int)((int64_t)numGroups * worker / numWorkers),
+                (int)((int64_t)numGroups * (worker + 1) / numWorkers)};
+    }
+
+  private:
+    mechanics::MemoryArena arena;
+    Group *groups{nullptr};
+};
+} // namespace sst::basic_blocks::mod_matrix
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_MOD_MATRIX_VOICEGROUPSCHEDULER_H
@@ -41,11 +41,13 @@ namespace sst::basic_blocks::modulators
  * @tparam SRProvider See the comments in ADSREnvelope
  * @tparam BLOCK_SIZE Must be a power of 2
  * @tparam RangeProvider Defines the min and max
+ * @tparam withCubedCache Set false to skip the outputCacheCubed block
  */
-template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange>
-struct ADAREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
+template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange,
+          bool withCubedCache = true>
+struct ADAREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>
 {
-    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>;
+    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>;
 
     SRProvider *srProvider;
     ADAREnvelope(SRProvider *s) : srProvider(s) {}
@@ -45,14 +45,16 @@ namespace sst::basic_blocks::modulators
  *
  * @tparam BLOCK_SIZE  the block size
  * @tparam RangeProvider - sets mins and maxes
+ * @tparam withCubedCache - set false to skip the outputCacheCubed block
  */
-template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange>
-struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
+template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange,
+          bool withCubedCache = true>
+struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>
 {
-    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>;
+    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>;
 
     SRProvider *srProvider;
-    ADSREnvelope(SRProvider *s) : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>(), srProvider(s)
+    ADSREnvelope(SRProvider *s) : base_t(), srProvider(s)
     {
         onSampleRateChanged();
     }
@@ -100,6 +102,20 @@ struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
         base_t::resetCurrent();
     }
 
+    /*
+     * The fraction of a block the next target computation covers. It is 1 except while
+     * processBlockWithGateChangeAt computes the two halves of a split block.
+     */
+    float segmentFraction{1.f};
+
+    // the analog one pole coefficient which covers segmentFraction of a block
+    inline float segmentCoefficient(float c) const
+    {
+        if (segmentFraction == 1.f || c >= 1.f)
+            return c;
+        return 1.f - std::pow(1.f - c, segmentFraction);
+    }
+
     float rFrom{0};
     inline float targetDigitalADSR(const float a, const float d, const float s, const float r,
                                    const int ashape, const int dshape, const int rshape,
@@ -128,7 +144,8 @@ struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
         {
         case base_t::s_attack:
         {
-            phase += srProvider->envelope_rate_linear_nowrap(a * base_t::etScale + base_t::etMin);
+            phase += segmentFraction *
+                     srProvider->envelope_rate_linear_nowrap(a * base_t::etScale + base_t::etMin);
             if (phase > 1)
             {
                 phase = 0;
@@ -141,7 +158,8 @@ struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
 
         case base_t::s_decay:
         {
-            phase += srProvider->envelope_rate_linear_nowrap(d * base_t::etScale + base_t::etMin);
+            phase += segmentFraction *
+                     srProvider->envelope_rate_linear_nowrap(d * base_t::etScale + base_t::etMin);
             if (phase > 1)
             {
                 phase = 0;
@@ -173,7 +191,8 @@ struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
         break;
         case base_t::s_release:
         {
-            phase += srProvider->envelope_rate_linear_nowrap(r * base_t::etScale + base_t::etMin);
+            phase += segmentFraction *
+                     srProvider->envelope_rate_linear_nowrap(r * base_t::etScale + base_t::etMin);
             if (phase > 1)
             {
                 phase = 0;
@@ -197,14 +216,15 @@ struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
     {
         auto &stage = this->stage;
 
-        float coef_A =
-            powf(2.f, std::min(0.f, coeff_offset - (a * base_t::etScale + base_t::etMin)));
-        float coef_D =
-            powf(2.f, std::min(0.f, coeff_offset - (d * base_t::etScale + base_t::etMin)));
+        float coef_A = segmentCoefficient(
+            powf(2.f, std::min(0.f, coeff_offset - (a * base_t::etScale + base_t::etMin))));
+        float coef_D = segmentCoefficient(
+            powf(2.f, std::min(0.f, coeff_offset - (d * base_t::etScale + base_t::etMin))));
         float coef_R =
             (stage >= base_t::s_eoc)
                 ? 6.f
-                : pow(2.f, std::min(0.f, coeff_offset - (r * base_t::etScale + base_t::etMin)));
+                : segmentCoefficient(pow(
+                      2.f, std::min(0.f, coeff_offset - (r * base_t::etScale + base_t::etMin))));
 
         const float v_cc = 1.01f;
         float v_gate = gateActive ? v_cc : 0.f;
@@ -216,7 +236,8 @@ struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
 
         if (stage == base_t::s_attack)
         {
-            phase += srProvider->envelope_rate_linear_nowrap(a * base_t::etScale + base_t::etMin);
+            phase += segmentFraction *
+                     srProvider->envelope_rate_linear_nowrap(a * base_t::etScale + base_t::etMin);
             if (phase > 1)
             {
                 stage = base_t::s_decay;
@@ -280,7 +301,8 @@ struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
 
         if (stage == base_t::s_release)
         {
-            phase += srProvider->envelope_rate_linear_nowrap(r * base_t::etScale + base_t::etMin);
+            phase += segmentFraction *
+                     srProvider->envelope_rate_linear_nowrap(r * base_t::etScale + base_t::etMin);
             if (phase > 1)
             {
                 stage = base_t::s_analog_residual_release;
@@ -332,15 +354,80 @@ struct ADSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
         base_t::step();
     }
 
+    inline float shapedTarget(const float a, const float d, const float s, const float r,
+                              const int ashape, const int dshape, const int rshape,
+                              const bool gateActive)
+    {
+        if (isDigital)
+            return base_t::shapeTarget(
+                targetDigitalADSR(a, d, s, r, ashape, dshape, rshape, gateActive), ashape, dshape,
+                rshape);
+        return targetAnalogADSR(a, d, s, r, 1, 1, 1, gateActive);
+    }
+
+    /*
+     * Process a block where the gate changes to gateActive at sample gateChangeAt. The
+     * envelope runs with the old gate for the first gateChangeAt samples and the new gate
+     * for the rest, each half ramping to a target advanced by its share of the block, so
+     * a note off lands on the right sample without calling process() per sample.
+     * gateChangeAt <= 0 is the same as processBlock with the new gate.
+     */
+    inline void processBlockWithGateChangeAt(const float a, const float d, const float s,
+                                             const float r, const int ashape, const int dshape,
+                                             const int rshape, const bool gateActive,
+                                             const int gateChangeAt)
+    {
+        SST_BASIC_BLOCKS_PROBE("ADSREnvelope::processBlockWithGateChangeAt");
+        if (gateChangeAt <= 0 || gateChangeAt >= BLOCK_SIZE)
+        {
+            processBlock(a, d, s, r, ashape, dshape, rshape,
+                         gateChangeAt >= BLOCK_SIZE ? !gateActive : gateActive);
+            return;
+        }
+
+        if (base_t::preBlockCheck())
+        {
+            clearCacheIfIdle();
+            return;
+        }
+
+        segmentFraction = gateChangeAt * base_t::BLOCK_SIZE_INV;
+        auto mid = shapedTarget(a, d, s, r, ashape, dshape, rshape, !gateActive);
+        this->updateBlockSegmentTo(this->outBlock0, mid, 0, gateChangeAt);
+
+        // the release picks up from wherever the first half got to
+        this->output = mid;
+        segmentFraction = 1.f - segmentFraction;
+        auto target = mid;
+        if (this->stage < base_t::s_eoc)
+            target = shapedTarget(a, d, s, r, ashape, dshape, rshape, gateActive);
+        segmentFraction = 1.f;
+        this->updateBlockSegmentTo(mid, target, gateChangeAt, BLOCK_SIZE);
+
+        this->outBlock0 = target;
+        this->current = 0;
+        base_t::step();
+        clearCacheIfIdle();
+    }
+
     inline void processBlock(const float a, const float d, const float s, const float r,
                              const int ashape, const int dshape, const int rshape,
                              const bool gateActive)
     {
+        SST_BASIC_BLOCKS_PROBE("ADSREnvelope::processBlock");
+        if (this->isQuiescent())
+            return;
+
         this->current = BLOCK_SIZE;
         process(a, d, s, r, ashape, dshape, rshape, gateActive);
+        clearCacheIfIdle();
+    }
+
+    inline void clearCacheIfIdle()
+    {
         if (this->stage == base_t::s_complete || this->stage == base_t::s_eoc)
         {
-            memset(this->outputCache, 0, sizeof(this->outputCache));
+            this->clearOutputCacheOnce();
         }
     }
 };
@@ -0,0 +1,324 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MODULATORS_ADSRENVELOPEBANK_H
+#define INCLUDE_SST_BASIC_BLOCKS_MODULATORS_ADSRENVELOPEBANK_H
+
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "DiscreteStagesEnvelope.h"
+
+namespace sst::basic_blocks::modulators
+{
+/**
+ * A lane parallel bank of N digital ADSR envelopes, with N a multiple of 4. Stage, phase
+ * and output for four voices live in one SSE register, stage transitions are resolved with
+ * masks and each processBlock writes the voices' output blocks four at a time.
+ *
+ * Each voice follows ADSREnvelope::processBlock in digital mode, so a voice of the bank
+ * matches an ADSREnvelope fed the same parameters. The rates still come from the
+ * SRProvider per voice, and the cube root shapes are resolved per voice since SSE has no
+ * cube root, but both are only computed for the stage a voice is in. The analog mode is
+ * not available in the bank.
+ *
+ * @tparam SRProvider - as in ADSREnvelope
+ * @tparam BLOCK_SIZE - the block size
+ * @tparam N - the number of voices
+ * @tparam RangeProvider - sets mins and maxes
+ */
+template <typename SRProvider, int BLOCK_SIZE, int N, typename RangeProvider = TenSecondRange>
+struct ADSREnvelopeBank
+{
+    static_assert(N > 0 && !(N & 3), "Bank size must be a multiple of 4");
+    using stages_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, false>;
+    using Stage = typename stages_t::Stage;
+    static constexpr float BLOCK_SIZE_INV{stages_t::BLOCK_SIZE_INV};
+    static constexpr int numVoices{N};
+
+    SRProvider *srProvider;
+
+    float outputCache alignas(16)[N][BLOCK_SIZE];
+    float outBlock0 alignas(16)[N];
+    float output alignas(16)[N];
+    float phase alignas(16)[N];
+    float rFrom alignas(16)[N];
+    float eoc_output alignas(16)[N];
+    int32_t stage alignas(16)[N];
+    int32_t eoc_countdown alignas(16)[N];
+
+    ADSREnvelopeBank(SRProvider *s) : srProvider(s)
+    {
+        for (int v = 0; v < N; ++v)
+            immediatelySilence(v);
+    }
+
+    void attackFrom(int v, float fv, int ashp)
+    {
+        assert(v >= 0 && v < N);
+        float f = fv;
+        switch (ashp)
+        {
+        case 0:
+            f = f * f;
+            break;
+        case 2:
+            f = pow(f, 1.0 / 3.0);
+            break;
+        }
+        phase[v] = f;
+        stage[v] = stages_t::s_attack;
+        eoc_output[v] = 0;
+        eoc_countdown[v] = 0;
+    }
+
+    void immediatelySilence(int v)
+    {
+        assert(v >= 0 && v < N);
+        stage[v] = stages_t::s_complete;
+        phase[v] = 0;
+        rFrom[v] = 0;
+        outBlock0[v] = 0;
+        output[v] = 0;
+        eoc_output[v] = 0;
+        eoc_countdown[v] = 0;
+        memset(outputCache[v], 0, sizeof(outputCache[v]));
+    }
+
+    // a completed voice has a zero block and does no work until its next attack
+    bool isQuiescent(int v) const { return stage[v] == stages_t::s_complete; }
+
+    /*
+     * Each argument points at N per voice values with the meaning of the matching
+     * ADSREnvelope::processBlock argument.
+     */
+    inline void processBlock(const float *a, const float *d, const float *s, const float *r,
+                             const int *ashape, const int *dshape, const int *rshape,
+                             const bool *gateActive)
+    {
+        for (int g = 0; g < N; g += 4)
+            processGroup(g, a, d, s, r, ashape, dshape, rshape, gateActive);
+    }
+
+  private:
+    static inline __m128 blend(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    static inline __m128i blendi(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+    static inline __m128i isStage(__m128i st, int s)
+    {
+        return _mm_cmpeq_epi32(st, _mm_set1_epi32(s));
+    }
+
+    // shapeTarget for the stage each lane ended up in
+    static inline __m128 shapeTargets(__m128 t, __m128i st, __m128i ash, __m128i dsh,
+                                      __m128i rsh)
+    {
+        auto shp = blendi(isStage(st, stages_t::s_attack), ash,
+                          blendi(isStage(st, stages_t::s_decay), dsh,
+                                 blendi(isStage(st, stages_t::s_release), rsh,
+                                        _mm_set1_epi32(1))));
+        auto sq = _mm_castsi128_ps(_mm_cmpeq_epi32(shp, _mm_setzero_si128()));
+        auto cu = _mm_castsi128_ps(_mm_cmpeq_epi32(shp, _mm_set1_epi32(2)));
+        t = blend(sq, _mm_sqrt_ps(t), t);
+        t = blend(cu, _mm_mul_ps(t, _mm_mul_ps(t, t)), t);
+        return t;
+    }
+
+    inline void processGroup(int g, const float *a, const float *d, const float *s,
+                             const float *r, const int *ashape, const int *dshape,
+                             const int *rshape, const bool *gateActive)
+    {
+        const auto one = _mm_set1_ps(1.f);
+        const auto ione = _mm_set1_epi32(1);
+
+        auto st = _mm_load_si128((const __m128i *)(stage + g));
+        if (_mm_movemask_epi8(isStage(st, stages_t::s_complete)) == 0xFFFF)
+            return;
+
+        auto ash = _mm_loadu_si128((const __m128i *)(ashape + g));
+        auto dsh = _mm_loadu_si128((const __m128i *)(dshape + g));
+        auto rsh = _mm_loadu_si128((const __m128i *)(rshape + g));
+        auto gate = _mm_cmpgt_epi32(_mm_setr_epi32(gateActive[g], gateActive[g + 1],
+                                                   gateActive[g + 2], gateActive[g + 3]),
+                                    _mm_setzero_si128());
+
+        // preBlockCheck: end of cycle lanes count down to complete and don't run this block
+        auto wasComplete = isStage(st, stages_t::s_complete);
+        auto wasEoc = isStage(st, stages_t::s_eoc);
+        auto eocc = _mm_sub_epi32(_mm_load_si128((const __m128i *)(eoc_countdown + g)),
+                                  _mm_and_si128(wasEoc, ione));
+        auto eocDone = _mm_and_si128(wasEoc, _mm_cmpeq_epi32(eocc, _mm_setzero_si128()));
+        _mm_store_si128((__m128i *)(eoc_countdown + g), eocc);
+        _mm_store_ps(eoc_output + g,
+                     _mm_and_ps(_mm_castsi128_ps(_mm_andnot_si128(eocDone, wasEoc)), one));
+        st = blendi(eocDone, _mm_set1_epi32(stages_t::s_complete), st);
+        auto active = _mm_andnot_si128(_mm_or_si128(wasComplete, wasEoc),
+                                       _mm_cmpeq_epi32(st, st));
+
+        auto ph = _mm_load_ps(phase + g);
+        auto ob0 = _mm_load_ps(outBlock0 + g);
+
+        // a released gate moves to the release stage from the current output
+        auto rel = _mm_andnot_si128(
+            gate, _mm_and_si128(active, _mm_cmplt_epi32(st, _mm_set1_epi32(stages_t::s_release))));
+        if (_mm_movemask_epi8(rel))
+        {
+            auto rf = _mm_load_ps(output + g);
+            auto rsq = _mm_castsi128_ps(_mm_cmpeq_epi32(rsh, _mm_setzero_si128()));
+            rf = blend(rsq, _mm_mul_ps(rf, rf), rf);
+            auto relf = _mm_castsi128_ps(rel);
+            _mm_store_ps(rFrom + g, blend(relf, rf, _mm_load_ps(rFrom + g)));
+            auto relm = _mm_movemask_ps(relf);
+            for (int i = 0; i < 4; ++i)
+                if ((relm & (1 << i)) && rshape[g + i] == 2)
+                    rFrom[g + i] = pow(output[g + i], 1.0 / 3.0);
+            st = blendi(rel, _mm_set1_epi32(stages_t::s_release), st);
+            ph = _mm_andnot_ps(relf, ph);
+        }
+        _mm_store_si128((__m128i *)(stage + g), st);
+
+        // the rate for each lane's stage, and the decay shaped sustain for decaying lanes
+        float rate alignas(16)[4]{}, sDecay alignas(16)[4]{};
+        for (int i = 0; i < 4; ++i)
+        {
+            auto l = g + i;
+            float p{0};
+            switch (stage[l])
+            {
+            case stages_t::s_attack:
+                p = a[l];
+                break;
+            case stages_t::s_decay:
+            {
+                p = d[l];
+                auto S = s[l];
+                switch (dshape[l])
+                {
+                case 0:
+                    S = S * S;
+                    break;
+                case 2:
+                    S = pow(S, 1.0 / 3.0);
+                    break;
+                }
+                sDecay[i] = S;
+                break;
+            }
+            case stages_t::s_release:
+                p = r[l];
+                break;
+            default:
+                continue;
+            }
+            rate[i] =
+                srProvider->envelope_rate_linear_nowrap(p * stages_t::etScale + stages_t::etMin);
+        }
+
+        auto inAttack = _mm_castsi128_ps(_mm_and_si128(active, isStage(st, stages_t::s_attack)));
+        auto inDecay = _mm_castsi128_ps(_mm_and_si128(active, isStage(st, stages_t::s_decay)));
+        auto inSustain =
+            _mm_castsi128_ps(_mm_and_si128(active, isStage(st, stages_t::s_sustain)));
+        auto inRelease =
+            _mm_castsi128_ps(_mm_and_si128(active, isStage(st, stages_t::s_release)));
+
+        ph = _mm_add_ps(ph, _mm_load_ps(rate));
+        auto over = _mm_cmpgt_ps(ph, one);
+        auto sv = _mm_loadu_ps(s + g);
+
+        auto tAttack = blend(over, one, ph);
+        auto sd = _mm_load_ps(sDecay);
+        auto tDecay = blend(over, sv, _mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, ph),
+                                                            _mm_sub_ps(one, sd)),
+                                                 sd));
+        auto tRelease =
+            _mm_andnot_ps(over, _mm_mul_ps(_mm_load_ps(rFrom + g), _mm_sub_ps(one, ph)));
+
+        auto target = _mm_setzero_ps();
+        target = blend(inAttack, tAttack, target);
+        target = blend(inDecay, tDecay, target);
+        target = blend(inSustain, sv, target);
+        target = blend(inRelease, tRelease, target);
+
+        // stage transitions for the lanes which ran over the end of their stage
+        auto advance = _mm_castps_si128(_mm_and_ps(over, _mm_or_ps(_mm_or_ps(inAttack, inDecay),
+                                                                   inRelease)));
+        auto toEoc = _mm_and_si128(advance, _mm_castps_si128(inRelease));
+        st = _mm_add_epi32(st, _mm_and_si128(_mm_andnot_si128(toEoc, advance), ione));
+        st = blendi(toEoc, _mm_set1_epi32(stages_t::s_eoc), st);
+        ph = _mm_andnot_ps(_mm_castsi128_ps(advance), ph);
+        if (_mm_movemask_epi8(toEoc))
+        {
+            auto cd = _mm_set1_epi32((int)std::round(srProvider->samplerate * 0.01));
+            auto prior = _mm_load_si128((const __m128i *)(eoc_countdown + g));
+            _mm_store_si128((__m128i *)(eoc_countdown + g), blendi(toEoc, cd, prior));
+        }
+
+        target = shapeTargets(target, st, ash, dsh, rsh);
+
+        // lanes which didn't run keep their outBlock0, and idle lanes output zeros
+        auto ran = _mm_castsi128_ps(active);
+        target = blend(ran, target, ob0);
+        auto idle = _mm_castsi128_ps(_mm_or_si128(isStage(st, stages_t::s_complete),
+                                                  isStage(st, stages_t::s_eoc)));
+
+        _mm_store_si128((__m128i *)(stage + g), st);
+        _mm_store_ps(phase + g, ph);
+        _mm_store_ps(outBlock0 + g, target);
+        // as ADSREnvelope::step leaves output at the start of the block's ramp
+        _mm_store_ps(output + g, _mm_and_ps(ran, ob0));
+
+        auto dO = _mm_mul_ps(_mm_sub_ps(target, ob0), _mm_set1_ps(BLOCK_SIZE_INV));
+        ob0 = _mm_andnot_ps(idle, ob0);
+        dO = _mm_andnot_ps(idle, dO);
+        auto idx = _mm_setzero_ps();
+        for (int i = 0; i < BLOCK_SIZE; i += 4)
+        {
+            auto r0 = _mm_add_ps(ob0, _mm_mul_ps(dO, idx));
+            idx = _mm_add_ps(idx, one);
+            auto r1 = _mm_add_ps(ob0, _mm_mul_ps(dO, idx));
+            idx = _mm_add_ps(idx, one);
+            auto r2 = _mm_add_ps(ob0, _mm_mul_ps(dO, idx));
+            idx = _mm_add_ps(idx, one);
+            auto r3 = _mm_add_ps(ob0, _mm_mul_ps(dO, idx));
+            idx = _mm_add_ps(idx, one);
+
+            // rows are samples across voices; transpose to four samples of each voice
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_store_ps(outputCache[g] + i, r0);
+            _mm_store_ps(outputCache[g + 1] + i, r1);
+            _mm_store_ps(outputCache[g + 2] + i, r2);
+            _mm_store_ps(outputCache[g + 3] + i, r3);
+        }
+    }
+};
+} // namespace sst::basic_blocks::modulators
+#endif // INCLUDE_SST_BASIC_BLOCKS_MODULATORS_ADSRENVELOPEBANK_H
@@ -32,10 +32,11 @@
 
 namespace sst::basic_blocks::modulators
 {
-template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange>
-struct AHDSRShapedSC : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
+template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange,
+          bool withCubedCache = true>
+struct AHDSRShapedSC : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>
 {
-    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>;
+    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>;
 
     static constexpr int nTables{64};
     static constexpr int nLUTPoints{256};
@@ -43,8 +44,7 @@ struct AHDSRShapedSC : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
     static inline bool lutsInitialized{false};
 
     SRProvider *srProvider{nullptr};
-    AHDSRShapedSC(SRProvider *s)
-        : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>(), srProvider(s)
+    AHDSRShapedSC(SRProvider *s) : base_t(), srProvider(s)
     {
         assert(srProvider);
     }
@@ -235,6 +235,9 @@ struct AHDSRShapedSC : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
                              const float r, const float ashape, const float dshape,
                              const float rshape, const bool gateActive)
     {
+        SST_BASIC_BLOCKS_PROBE("AHDSRShapedSC::processBlock");
+        if (this->isQuiescent())
+            return;
         processCore(a, h, d, s, r, ashape, dshape, rshape, gateActive);
     }
 
@@ -44,14 +44,16 @@ namespace sst::basic_blocks::modulators
  *
  * @tparam BLOCK_SIZE  the block size
  * @tparam RangeProvider - sets mins and maxes
+ * @tparam withCubedCache - set false to skip the outputCacheCubed block
  */
-template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange>
-struct DAHDEnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
+template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange,
+          bool withCubedCache = true>
+struct DAHDEnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>
 {
-    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>;
+    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>;
 
     SRProvider *srProvider;
-    DAHDEnvelope(SRProvider *s) : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>(), srProvider(s)
+    DAHDEnvelope(SRProvider *s) : base_t(), srProvider(s)
     {
         onSampleRateChanged();
     }
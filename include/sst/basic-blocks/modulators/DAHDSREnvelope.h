@@ -40,12 +40,13 @@ namespace sst::basic_blocks::modulators
  * @tparam SRProvider See the comments in ADSREnvelope
  * @tparam BLOCK_SIZE Must be a power of 2
  * @tparam RangeProvider Defines the min and max
+ * @tparam withCubedCache Set false to skip the outputCacheCubed block
  */
 template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange,
-          bool processEverySample = true>
-struct DAHDSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
+          bool processEverySample = true, bool withCubedCache = true>
+struct DAHDSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>
 {
-    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>;
+    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>;
 
     SRProvider *srProvider;
     DAHDSREnvelope(SRProvider *s) : srProvider(s) {}
@@ -185,6 +186,7 @@ struct DAHDSREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
     inline void processBlockScaledAD(const float dl, const float a, const float h, const float dc,
                                      const float s, const float r, const bool gateActive)
     {
+        SST_BASIC_BLOCKS_PROBE("DAHDSREnvelope::processBlockScaledAD");
         if (base_t::preBlockCheck())
             return;
 
@@ -40,11 +40,13 @@ namespace sst::basic_blocks::modulators
  * @tparam SRProvider See the comments in ADSREnvelope
  * @tparam BLOCK_SIZE Must be a power of 2
  * @tparam RangeProvider Defines the min and max
+ * @tparam withCubedCache Set false to skip the outputCacheCubed block
  */
-template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange>
-struct DAREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
+template <typename SRProvider, int BLOCK_SIZE, typename RangeProvider = TenSecondRange,
+          bool withCubedCache = true>
+struct DAREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>
 {
-    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>;
+    using base_t = DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider, withCubedCache>;
 
     SRProvider *srProvider;
     DAREnvelope(SRProvider *s) : srProvider(s) {}
@@ -169,6 +171,7 @@ struct DAREnvelope : DiscreteStagesEnvelope<BLOCK_SIZE, RangeProvider>
     inline void processBlockScaledAD(const float d, const float a, const float r,
                                      const bool gateActive)
     {
+        SST_BASIC_BLOCKS_PROBE("DAREnvelope::processBlockScaledAD");
         if (base_t::preBlockCheck())
             return;
 
@@ -27,6 +27,11 @@
 #ifndef INCLUDE_SST_BASIC_BLOCKS_MODULATORS_DISCRETESTAGESENVELOPE_H
 #define INCLUDE_SST_BASIC_BLOCKS_MODULATORS_DISCRETESTAGESENVELOPE_H
 
+#include <cassert>
+#include <cstring>
+
+#include "sst/basic-blocks/mechanics/instrumentation.h"
+
 namespace sst::basic_blocks::modulators
 {
 enum DPhaseStrategies
@@ -68,7 +73,12 @@ struct TwentyFiveSecondExp
     static constexpr double A{0.6931471824646}, B{10.1267113685608}, C{-2.0}, D{1000.0};
 };
 
-template <int BLOCK_SIZE, typename RangeProvider> struct DiscreteStagesEnvelope
+/*
+ * withCubedCache = false skips filling outputCacheCubed in updateBlockTo for callers who
+ * only read outputCache; outputCubed is then computed on demand in step().
+ */
+template <int BLOCK_SIZE, typename RangeProvider, bool withCubedCache = true>
+struct DiscreteStagesEnvelope
 {
     static constexpr float etminV()
     {
@@ -103,7 +113,7 @@ template <int BLOCK_SIZE, typename RangeProvider> struct DiscreteStagesEnvelope
         for (int i = 0; i < BLOCK_SIZE; ++i)
         {
             outputCache[i] = 0;
-            outputCacheCubed[0] = 0;
+            outputCacheCubed[i] = 0;
         }
     }
 
@@ -113,6 +123,14 @@ template <int BLOCK_SIZE, typename RangeProvider> struct DiscreteStagesEnvelope
     int current{BLOCK_SIZE};
     int eoc_countdown{0};
 
+    /*
+     * True while outputCache (and the cubed cache) hold all zeros. Together with a
+     * completed stage this is the quiescent state: the block output is constant zero until
+     * the next attack, so processing can skip all its work and callers reading the block
+     * can skip theirs.
+     */
+    bool outputCacheIsZero{true};
+
     enum Stage
     {
         s_delay, // skipped in ADSR
@@ -134,17 +152,31 @@ template <int BLOCK_SIZE, typename RangeProvider> struct DiscreteStagesEnvelope
         eoc_countdown = 0;
     }
 
+    bool isQuiescent() const { return stage == s_complete && outputCacheIsZero; }
+
+    void clearOutputCacheOnce()
+    {
+        if (outputCacheIsZero)
+            return;
+        memset(outputCache, 0, sizeof(outputCache));
+        if constexpr (withCubedCache)
+            memset(outputCacheCubed, 0, sizeof(outputCacheCubed));
+        outputCacheIsZero = true;
+    }
+
     bool preBlockCheck()
     {
         if (stage == s_complete)
         {
             output = 0;
+            clearOutputCacheOnce();
             return true;
         }
 
         if (stage == s_eoc)
         {
             output = 0;
+            clearOutputCacheOnce();
             eoc_output = 1;
 
             eoc_countdown--;
@@ -209,20 +241,52 @@ template <int BLOCK_SIZE, typename RangeProvider> struct DiscreteStagesEnvelope
 
     void updateBlockTo(float target)
     {
+        if (target == 0.f && outBlock0 == 0.f)
+        {
+            // the zero to zero ramp of an idle block only needs writing once
+            clearOutputCacheOnce();
+            current = 0;
+            return;
+        }
+
+        // a plain loop, which the compiler vectorizes without needing SSE headers here
         float dO = (target - outBlock0) * BLOCK_SIZE_INV;
         for (int i = 0; i < BLOCK_SIZE; ++i)
         {
             outputCache[i] = outBlock0 + dO * i;
-            outputCacheCubed[i] = outputCache[i] * outputCache[i] * outputCache[i];
+            if constexpr (withCubedCache)
+                outputCacheCubed[i] = outputCache[i] * outputCache[i] * outputCache[i];
         }
         outBlock0 = target;
+        outputCacheIsZero = false;
         current = 0;
     }
 
+    /*
+     * Ramp outputCache[start, end) from 'from' towards 'target', reaching it at end. This
+     * is the split block path used for gate changes mid block. It doesn't touch outBlock0
+     * or current; the caller sets those once the whole block is written.
+     */
+    void updateBlockSegmentTo(float from, float target, int start, int end)
+    {
+        assert(start >= 0 && start < end && end <= BLOCK_SIZE);
+        float dO = (target - from) / (end - start);
+        outputCacheIsZero = false;
+        for (int i = start; i < end; ++i)
+        {
+            outputCache[i] = from + dO * (i - start);
+            if constexpr (withCubedCache)
+                outputCacheCubed[i] = outputCache[i] * outputCache[i] * outputCache[i];
+        }
+    }
+
     void step()
     {
         output = outputCache[current];
-        outputCubed = outputCacheCubed[current];
+        if constexpr (withCubedCache)
+            outputCubed = outputCacheCubed[current];
+        else
+            outputCubed = output * output * output;
         current++;
     }
 
@@ -237,6 +301,7 @@ template <int BLOCK_SIZE, typename RangeProvider> struct DiscreteStagesEnvelope
         outBlock0 = 0;
         memset(outputCache, 0, sizeof(outputCache));
         memset(outputCacheCubed, 0, sizeof(outputCacheCubed));
+        outputCacheIsZero = true;
     }
 
     float rateFrom01(float r01)
@@ -28,9 +28,11 @@
 #define INCLUDE_SST_BASIC_BLOCKS_MODULATORS_FXMODCONTROL_H
 
 #include <cmath>
+#include <cstring>
 #include <utility>
 
 #include "sst/basic-blocks/dsp/BlockInterpolators.h"
+#include "sst/basic-blocks/tables/SineTableProvider.h"
 
 namespace sst::basic_blocks::modulators
 {
@@ -43,9 +45,6 @@ template <int blockSize> struct FXModControl
     {
         lfophase = 0.0f;
         lfosandhtarget = 0.0f;
-
-        for (int i = 0; i < LFO_TABLE_SIZE; ++i)
-            sin_lfo_table[i] = sin(2.0 * M_PI * i / LFO_TABLE_SIZE);
     }
     FXModControl() : FXModControl(0, 0) {}
 
@@ -65,9 +64,18 @@ template <int blockSize> struct FXModControl
         mod_square,
     };
 
+    /*
+     * With the depth at and heading to zero, value() is constant zero. pre_process still
+     * runs the phase, random state and waveform so the modulator resumes where it would have,
+     * but settles the waveform at once, so callers can skip value() and post_process() for
+     * the block and processBlock skips the fill.
+     */
+    inline bool isQuiescent() const noexcept { return depth.v == 0.f && depth.dv == 0.f; }
+
     inline void pre_process(int mwave, float rate, float depth_val, float phase_offset)
     {
         assert(samplerate > 1000);
+        bool quiet = depth_val == 0.f && isQuiescent();
         bool lforeset = false;
         bool rndreset = false;
         float lfoout = lfoval.v;
@@ -217,6 +225,8 @@ template <int blockSize> struct FXModControl
         }
         }
 
+        if (quiet)
+            lfoval.instantize();
         depth.newValue(depth_val);
     }
 
@@ -228,6 +238,40 @@ template <int blockSize> struct FXModControl
         depth.process();
     }
 
+    /*
+     * The block form of pre_process followed by blockSize rounds of value() and
+     * post_process(): write the modulation curve for the block into out
+     * (blockSize floats, no alignment needed). The waveform is still evaluated at block
+     * rate, as the stepped form does, and the interpolated product of the waveform and
+     * depth ramps is written four samples at a time.
+     */
+    inline void processBlock(int mwave, float rate, float depth_val, float phase_offset,
+                             float *out)
+    {
+        static_assert(!(blockSize & 3), "Block processing needs a multiple of 4 block size");
+        pre_process(mwave, rate, depth_val, phase_offset);
+
+        if (isQuiescent())
+        {
+            memset(out, 0, blockSize * sizeof(float));
+            return;
+        }
+
+        auto lv = _mm_set1_ps(lfoval.v), ldv = _mm_set1_ps(lfoval.dv);
+        auto dv = _mm_set1_ps(depth.v), ddv = _mm_set1_ps(depth.dv);
+        auto idx = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+        const auto four = _mm_set1_ps(4.f);
+        for (int i = 0; i < blockSize; i += 4)
+        {
+            auto l = _mm_add_ps(lv, _mm_mul_ps(ldv, idx));
+            auto d = _mm_add_ps(dv, _mm_mul_ps(ddv, idx));
+            _mm_storeu_ps(out + i, _mm_mul_ps(l, d));
+            idx = _mm_add_ps(idx, four);
+        }
+        lfoval.v += lfoval.dv * blockSize;
+        depth.v += depth.dv * blockSize;
+    }
+
   private:
     dsp::lipol<float, blockSize, true> lfoval{};
     dsp::lipol<float, blockSize, true> depth{};
@@ -236,7 +280,8 @@ template <int blockSize> struct FXModControl
 
     static constexpr int LFO_TABLE_SIZE = 8192;
     static constexpr int LFO_TABLE_MASK = LFO_TABLE_SIZE - 1;
-    float sin_lfo_table[LFO_TABLE_SIZE]{};
+    // one table shared by every instance rather than 32k each
+    const float *sin_lfo_table{tables::SineTableProvider<LFO_TABLE_SIZE>::shared().table};
 };
 } // namespace sst::basic_blocks::modulators
 
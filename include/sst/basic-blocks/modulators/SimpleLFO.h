@@ -29,6 +29,7 @@
 
 #include "sst/basic-blocks/dsp/CorrelatedNoise.h"
 #include "sst/basic-blocks/dsp/Interpolators.h"
+#include "sst/basic-blocks/mechanics/instrumentation.h"
 
 #include <random>
 #include <cmath>
@@ -89,6 +90,17 @@ template <typename SRProvider, int BLOCK_SIZE> struct SimpleLFO
     float outputBlock[BLOCK_SIZE];
     float phase{0};
 
+    /*
+     * At zero amplitude, once the block has reached zero, the LFO is quiescent:
+     * process_block only keeps the phase and random state running and leaves the
+     * zeroed outputBlock alone, and callers can treat the output as constant.
+     */
+    bool outputBlockIsZero{true};
+    inline bool isQuiescent() const
+    {
+        return amplitude == 0.f && lastTarget == 0.f && outputBlockIsZero;
+    }
+
     inline float bend1(float x, float d)
     {
         auto a = 0.5 * std::clamp(d, -3.f, 3.f);
@@ -118,6 +130,7 @@ template <typename SRProvider, int BLOCK_SIZE> struct SimpleLFO
         }
         lastDPhase = 0;
         amplitude = 1;
+        outputBlockIsZero = true;
     }
     // FIXME - make this work for proper attacks
     inline void attack(const int lshape)
@@ -126,6 +139,7 @@ template <typename SRProvider, int BLOCK_SIZE> struct SimpleLFO
         lastDPhase = 0;
         for (int i = 0; i < BLOCK_SIZE; ++i)
             outputBlock[i] = 0;
+        outputBlockIsZero = true;
     }
 
     float lastDPhase{0};
@@ -150,10 +164,12 @@ template <typename SRProvider, int BLOCK_SIZE> struct SimpleLFO
         {
             f = lastTarget;
         }
+        outputBlockIsZero = (lastTarget == 0.f);
     }
 
     inline void process_block(const float r, const float d, const int lshape, bool reverse = false)
     {
+        SST_BASIC_BLOCKS_PROBE("SimpleLFO::process_block");
         float target{0.f};
 
         auto frate = srProvider->envelope_rate_linear_nowrap(-r);
@@ -189,6 +205,13 @@ template <typename SRProvider, int BLOCK_SIZE> struct SimpleLFO
             }
         }
         auto shp = (Shape)(lshape);
+        if (amplitude == 0.f && lastTarget == 0.f && shp != RANDOM_TRIGGER)
+        {
+            // silent; the random trigger still has to run to keep its countdown moving
+            setZeroBlock();
+            return;
+        }
+
         switch (shp)
         {
         case SINE:
@@ -246,6 +269,13 @@ template <typename SRProvider, int BLOCK_SIZE> struct SimpleLFO
             break;
         }
         target = target * amplitude;
+        if (target == 0.f && lastTarget == 0.f)
+        {
+            setZeroBlock();
+            return;
+        }
+
+        outputBlockIsZero = false;
         if (phaseMidpoint > 0 && (shp == PULSE || shp == SH_NOISE || shp == RANDOM_TRIGGER))
         {
             for (int i = 0; i < phaseMidpoint; ++i)
@@ -265,6 +295,17 @@ template <typename SRProvider, int BLOCK_SIZE> struct SimpleLFO
     }
 
   private:
+    inline void setZeroBlock()
+    {
+        if (!outputBlockIsZero)
+        {
+            for (int i = 0; i < BLOCK_SIZE; ++i)
+                outputBlock[i] = 0;
+            outputBlockIsZero = true;
+        }
+        lastTarget = 0;
+    }
+
     SimpleLFO(const SimpleLFO &) = delete;
     SimpleLFO &operator=(const SimpleLFO &) = delete;
     SimpleLFO(SimpleLFO &&) = delete;
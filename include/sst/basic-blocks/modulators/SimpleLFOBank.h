@@ -0,0 +1,338 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_MODULATORS_SIMPLELFOBANK_H
+#define INCLUDE_SST_BASIC_BLOCKS_MODULATORS_SIMPLELFOBANK_H
+
+#include <array>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cassert>
+
+#include "SimpleLFO.h"
+#include "sst/basic-blocks/dsp/FastMath.h"
+
+/*
+ * A structure-of-arrays bank of N SimpleLFOs, with N a multiple of 4. Phases advance
+ * four lanes at a time in SSE, the sine uses fastsinSSE, and each lane's shape is
+ * selected with masked blends so a register of lanes with mixed shapes doesn't branch
+ * per lane. Only the noise and random trigger shapes touch scalar state, and only when
+ * a lane's phase wraps.
+ *
+ * Each lane otherwise follows SimpleLFO::process_block, including its random sequence,
+ * so lane l of a bank seeded with s matches a SimpleLFO seeded with s + l up to the
+ * fastsin error. Like the rest of the SIMD code, include your SSE headers first.
+ */
+namespace sst::basic_blocks::modulators
+{
+template <typename SRProvider, int BLOCK_SIZE, int N> struct SimpleLFOBank
+{
+    static_assert(N > 0 && !(N & 3), "Bank size must be a multiple of 4");
+    static_assert((BLOCK_SIZE >= 8) & !(BLOCK_SIZE & (BLOCK_SIZE - 1)),
+                  "Block size must be power of 2 8 or above.");
+    static constexpr float BLOCK_SIZE_INV{1.f / BLOCK_SIZE};
+    static constexpr int numLanes{N};
+
+    using Shape = typename SimpleLFO<SRProvider, BLOCK_SIZE>::Shape;
+
+    SRProvider *srProvider{nullptr};
+
+    float outputBlock alignas(16)[N][BLOCK_SIZE];
+    float phase alignas(16)[N];
+    float lastTarget alignas(16)[N];
+    float amplitude alignas(16)[N];
+    float lastDPhase[N];
+
+    SimpleLFOBank(SRProvider *s, uint32_t seed = rand()) : srProvider(s)
+    {
+        for (int l = 0; l < N; ++l)
+        {
+            phase[l] = 0;
+            lastTarget[l] = 0;
+            amplitude[l] = 1;
+            lastDPhase[l] = 0;
+            rndTrigCountdown[l] = 0;
+            seedLane(l, seed + l);
+        }
+    }
+
+    // Restart the lane's random sequence the same way a SimpleLFO constructed with seed does
+    void seedLane(int l, uint32_t seed)
+    {
+        assert(l >= 0 && l < N);
+        gen[l] = std::default_random_engine();
+        gen[l].seed(seed);
+
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+            outputBlock[l][i] = 0;
+
+        rngState[0][l] = urng(l);
+        rngState[1][l] = urng(l);
+        for (int i = 0; i < 4; ++i)
+        {
+            rngCurrent[l] = dsp::correlated_noise_o2mk2_supplied_value(rngState[0][l],
+                                                                       rngState[1][l], 0, urng(l));
+            rngHistory[3 - i][l] = rngCurrent[l];
+        }
+    }
+
+    inline void attack(int l)
+    {
+        phase[l] = 0;
+        lastDPhase[l] = 0;
+        for (int i = 0; i < BLOCK_SIZE; ++i)
+            outputBlock[l][i] = 0;
+    }
+
+    inline void applyPhaseOffset(int l, float dPhase)
+    {
+        if (dPhase != lastDPhase[l])
+        {
+            phase[l] += dPhase - lastDPhase[l];
+            if (phase[l] > 1)
+                phase[l] -= 1;
+        }
+        lastDPhase[l] = dPhase;
+    }
+
+    inline void setAmplitude(int l, float f) { amplitude[l] = f; }
+
+    inline void freeze(int l)
+    {
+        for (auto &f : outputBlock[l])
+            f = lastTarget[l];
+    }
+
+    /*
+     * r, d and lshape are per lane arrays with the same meaning as the SimpleLFO
+     * process_block arguments
+     */
+    inline void process_block(const float *r, const float *d, const int *lshape,
+                              bool reverse = false)
+    {
+        float frate alignas(16)[N];
+        for (int l = 0; l < N; ++l)
+            frate[l] = srProvider->envelope_rate_linear_nowrap(-r[l]);
+
+        float target alignas(16)[N];
+        int phaseMidpoint[N];
+
+        const auto one = _mm_set1_ps(1.f);
+        const auto dir = _mm_set1_ps(reverse ? -1.f : 1.f);
+        for (int g = 0; g < N; g += 4)
+        {
+            auto ph = _mm_add_ps(_mm_load_ps(phase + g), _mm_mul_ps(_mm_load_ps(frate + g), dir));
+            auto over = _mm_cmpgt_ps(ph, one);
+            auto under = _mm_cmplt_ps(ph, _mm_setzero_ps());
+            ph = _mm_add_ps(ph, _mm_sub_ps(_mm_and_ps(under, one), _mm_and_ps(over, one)));
+            _mm_store_ps(phase + g, ph);
+
+            auto overMask = _mm_movemask_ps(over);
+            auto wrapMask = overMask | _mm_movemask_ps(under);
+            for (int i = 0; i < 4; ++i)
+            {
+                auto l = g + i;
+                phaseMidpoint[l] = 0;
+                if (!(wrapMask & (1 << i)))
+                    continue;
+
+                if (lshape[l] == Shape::SH_NOISE || lshape[l] == Shape::SMOOTH_NOISE)
+                    advanceNoise(l, d[l]);
+                if (overMask & (1 << i))
+                    phaseMidpoint[l] = std::clamp(
+                        (int)std::round(frate[l] / std::max(phase[l], 0.00001f)), 0,
+                        BLOCK_SIZE - 1);
+            }
+
+            auto t = evaluateShapes(g, d, lshape, overMask);
+            _mm_store_ps(target + g, _mm_mul_ps(t, _mm_load_ps(amplitude + g)));
+        }
+
+        const auto idx0 = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+        const auto four = _mm_set1_ps(4.f);
+        for (int l = 0; l < N; ++l)
+        {
+            auto shp = lshape[l];
+            if (phaseMidpoint[l] > 0 &&
+                (shp == Shape::PULSE || shp == Shape::SH_NOISE || shp == Shape::RANDOM_TRIGGER))
+            {
+                for (int i = 0; i < phaseMidpoint[l]; ++i)
+                    outputBlock[l][i] = lastTarget[l];
+                for (int i = phaseMidpoint[l]; i < BLOCK_SIZE; ++i)
+                    outputBlock[l][i] = target[l];
+            }
+            else
+            {
+                auto lt = _mm_set1_ps(lastTarget[l]);
+                auto dO = _mm_set1_ps((target[l] - lastTarget[l]) * BLOCK_SIZE_INV);
+                auto idx = idx0;
+                for (int i = 0; i < BLOCK_SIZE; i += 4)
+                {
+                    _mm_store_ps(outputBlock[l] + i, _mm_add_ps(lt, _mm_mul_ps(dO, idx)));
+                    idx = _mm_add_ps(idx, four);
+                }
+            }
+            lastTarget[l] = target[l];
+        }
+    }
+
+  private:
+    std::array<std::default_random_engine, N> gen;
+    std::uniform_real_distribution<float> distro{-1.f, 1.f};
+    float urng(int l) { return distro(gen[l]); }
+
+    float rngState alignas(16)[2][N];
+    float rngHistory alignas(16)[4][N];
+    float rngCurrent alignas(16)[N];
+    int rndTrigCountdown[N];
+
+    void advanceNoise(int l, float d)
+    {
+        // The deform can push correlated noise out of bounds
+        auto ud = d * 0.8;
+        rngCurrent[l] = dsp::correlated_noise_o2mk2_supplied_value(rngState[0][l], rngState[1][l],
+                                                                   ud, urng(l));
+        rngHistory[3][l] = rngHistory[2][l];
+        rngHistory[2][l] = rngHistory[1][l];
+        rngHistory[1][l] = rngHistory[0][l];
+        rngHistory[0][l] = rngCurrent[l];
+    }
+
+    static inline __m128 blend(__m128 mask, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // the same double bend as SimpleLFO::bend1
+    static inline __m128 bend1(__m128 x, __m128 d)
+    {
+        auto a = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_max_ps(_mm_set1_ps(-3.f),
+                                                          _mm_min_ps(d, _mm_set1_ps(3.f))));
+        x = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(a, _mm_mul_ps(x, x))), a);
+        x = _mm_add_ps(_mm_sub_ps(x, _mm_mul_ps(a, _mm_mul_ps(x, x))), a);
+        return x;
+    }
+
+    inline __m128 evaluateShapes(int g, const float *d, const int *lshape, int overMask)
+    {
+        const auto one = _mm_set1_ps(1.f);
+        const auto two = _mm_set1_ps(2.f);
+        const auto half = _mm_set1_ps(0.5f);
+
+        auto ph = _mm_load_ps(phase + g);
+        auto dv = _mm_loadu_ps(d + g);
+        auto shapes = _mm_loadu_si128((const __m128i *)(lshape + g));
+        auto isShape = [shapes](int s) {
+            return _mm_castsi128_ps(_mm_cmpeq_epi32(shapes, _mm_set1_epi32(s)));
+        };
+        auto mSine = isShape(Shape::SINE), mRamp = isShape(Shape::RAMP),
+             mDown = isShape(Shape::DOWN_RAMP), mTri = isShape(Shape::TRI),
+             mPulse = isShape(Shape::PULSE), mSmooth = isShape(Shape::SMOOTH_NOISE),
+             mSH = isShape(Shape::SH_NOISE), mRT = isShape(Shape::RANDOM_TRIGGER);
+
+        auto res = _mm_setzero_ps();
+        if (_mm_movemask_ps(mSine))
+        {
+            // sin(2 pi p) = -sin(2 pi p - pi) which keeps fastsin in its -pi, pi range
+            auto x = _mm_sub_ps(_mm_mul_ps(ph, _mm_set1_ps(2.0 * M_PI)), _mm_set1_ps(M_PI));
+            res = blend(mSine, _mm_sub_ps(_mm_setzero_ps(), dsp::fastsinSSE(x)), res);
+        }
+        if (_mm_movemask_ps(mRamp))
+            res = blend(mRamp, _mm_sub_ps(_mm_mul_ps(two, ph), one), res);
+        if (_mm_movemask_ps(mDown))
+            res = blend(mDown, _mm_sub_ps(one, _mm_mul_ps(two, ph)), res);
+        if (_mm_movemask_ps(mTri))
+        {
+            auto tph = _mm_add_ps(ph, _mm_set1_ps(0.25f));
+            tph = _mm_sub_ps(tph, _mm_and_ps(_mm_cmpgt_ps(tph, one), one));
+            auto tri = _mm_min_ps(tph, _mm_sub_ps(one, tph));
+            res = blend(mTri, _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(4.f), tri), one), res);
+        }
+
+        auto mBend = _mm_or_ps(_mm_or_ps(mSine, mRamp), _mm_or_ps(mDown, mTri));
+        if (_mm_movemask_ps(mBend))
+            res = blend(mBend, bend1(res, dv), res);
+
+        if (_mm_movemask_ps(mPulse))
+        {
+            auto hi = _mm_cmplt_ps(ph, _mm_mul_ps(_mm_add_ps(dv, one), half));
+            res = blend(mPulse, blend(hi, one, _mm_set1_ps(-1.f)), res);
+        }
+        if (_mm_movemask_ps(mSmooth))
+        {
+            // dsp::cubic_ipol across the four history rows
+            auto y0 = _mm_load_ps(rngHistory[3] + g), y1 = _mm_load_ps(rngHistory[2] + g),
+                 y2 = _mm_load_ps(rngHistory[1] + g), y3 = _mm_load_ps(rngHistory[0] + g);
+            auto mu2 = _mm_mul_ps(ph, ph);
+            auto a0 = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(y3, y2), y0), y1);
+            auto a1 = _mm_sub_ps(_mm_sub_ps(y0, y1), a0);
+            auto a2 = _mm_sub_ps(y2, y0);
+            auto ci = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_mul_ps(ph, mu2)),
+                                            _mm_mul_ps(a1, mu2)),
+                                 _mm_add_ps(_mm_mul_ps(a2, ph), y1));
+            res = blend(mSmooth, ci, res);
+        }
+        if (_mm_movemask_ps(mSH))
+            res = blend(mSH, _mm_load_ps(rngCurrent + g), res);
+
+        auto rtMask = _mm_movemask_ps(mRT);
+        if (rtMask)
+        {
+            float rt alignas(16)[4]{};
+            for (int i = 0; i < 4; ++i)
+            {
+                if (!(rtMask & (1 << i)))
+                    continue;
+                auto l = g + i;
+                if ((overMask & (1 << i)) && urng(l) > (-d[l]))
+                {
+                    // 10 ms triggers according to spec so thats 1% of sample rate
+                    rndTrigCountdown[l] =
+                        (int)std::round(0.01 * srProvider->samplerate * BLOCK_SIZE_INV);
+                }
+                if (rndTrigCountdown[l] > 0)
+                {
+                    rndTrigCountdown[l]--;
+                    rt[i] = 1;
+                }
+                else
+                {
+                    rt[i] = -1;
+                }
+            }
+            res = blend(mRT, _mm_load_ps(rt), res);
+        }
+        return res;
+    }
+
+    SimpleLFOBank(const SimpleLFOBank &) = delete;
+    SimpleLFOBank &operator=(const SimpleLFOBank &) = delete;
+    SimpleLFOBank(SimpleLFOBank &&) = delete;
+    SimpleLFOBank &operator=(SimpleLFOBank &&) = delete;
+};
+} // namespace sst::basic_blocks::modulators
+#endif // INCLUDE_SST_BASIC_BLOCKS_MODULATORS_SIMPLELFOBANK_H
@@ -56,6 +56,10 @@
  */
 
 #include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -64,6 +68,10 @@
 #include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 #include <fmt/core.h>
 #include <array>
@@ -174,18 +182,52 @@ struct ParamMetaData
      */
     std::optional<std::string> valueToString(float val, const FeatureState &fs = {}) const;
 
+    /*
+     * The same string written into a caller buffer with no heap allocation, for UIs that
+     * redraw many labels every frame. The output is always null terminated and truncated to
+     * fit. Like snprintf, the return value is the untruncated length, so a result >= outSize
+     * means the buffer was too small. nullopt means there is no representation, as above.
+     */
+    std::optional<size_t> valueToString(float val, char *out, size_t outSize,
+                                        const FeatureState &fs = {}) const;
+
     /*
      * Some parameters have a secondary representation. For instance 441.2hz could also be ~A4.
      * If this parameter supports that it will return a string value from this API. Surge uses
      * this in the left side of the tooltip.
      */
     std::optional<std::string> valueToAlternateString(float val) const;
+    std::optional<size_t> valueToAlternateString(float val, char *out, size_t outSize) const;
+
+    /*
+     * Parsing a string back to a value reports failure through a ParseError rather than
+     * a string or an exception, so type-ins and preset loads neither throw nor allocate.
+     * parseErrorToString renders the message the std::string &errMsg APIs produce.
+     */
+    struct ParseError
+    {
+        enum Code : uint8_t
+        {
+            NONE,
+            INVALID_NUMBER,        // no number at the front of the string, or a float overflow
+            OUT_OF_RANGE,          // a number, but outside the parameter (or modulation) range
+            EXCEEDS_MAX_DEPTH,     // a modulation depth larger than the parameter range
+            UNSUPPORTED_CONVERSION // this type/display scale cannot be parsed
+        } code{NONE};
+
+        explicit operator bool() const { return code != NONE; }
+    };
+    std::optional<size_t> parseErrorToString(const ParseError &err, char *out,
+                                             size_t outSize) const;
+    std::string parseErrorToString(const ParseError &err) const;
 
     /*
      * Convert a value to a string; if the optional is empty populate the error message.
      */
     std::optional<float> valueFromString(std::string_view, std::string &errMsg,
                                          const FeatureState &fs = {}) const;
+    std::optional<float> valueFromString(std::string_view, ParseError &err,
+                                         const FeatureState &fs = {}) const;
 
     /*
      * Distances to String conversions are more peculiar, especially with non-linear ranges.
@@ -216,6 +258,8 @@ struct ParamMetaData
     std::optional<float> modulationNaturalFromString(std::string_view deltaNatural,
                                                      float naturalBaseVal,
                                                      std::string &errMsg) const;
+    std::optional<float> modulationNaturalFromString(std::string_view deltaNatural,
+                                                     float naturalBaseVal, ParseError &err) const;
 
     enum DisplayScale
     {
@@ -302,6 +346,95 @@ struct ParamMetaData
         return 0.f;
     }
 
+    /*
+     * Batch versions of the above for automation lanes and offline rendering. The
+     * NormalizationDescriptor holds just what the conversion needs, computed once, so a
+     * host can keep it next to the lane rather than the whole ParamMetaData. These give
+     * the same values as the scalar calls except that out-of-range input is clamped
+     * rather than asserted. ParamMetadataSIMD.h has SSE versions of the same kernels.
+     */
+    struct NormalizationDescriptor
+    {
+        Type type{NONE};
+        float minVal{0.f}, range{1.f};
+    };
+    NormalizationDescriptor normalizationDescriptor() const
+    {
+        return {type, minVal, maxVal - minVal};
+    }
+
+    static void naturalToNormalized01(const NormalizationDescriptor &d, const float *in,
+                                      float *out, size_t n)
+    {
+        switch (d.type)
+        {
+        case FLOAT:
+            for (size_t i = 0; i < n; ++i)
+                out[i] = std::clamp((in[i] - d.minVal) / d.range, 0.f, 1.f);
+            break;
+        case INT:
+            for (size_t i = 0; i < n; ++i)
+            {
+                float v = 0.005 + 0.99 * (in[i] - d.minVal) / d.range;
+                out[i] = std::clamp(v, 0.f, 1.f);
+            }
+            break;
+        case BOOL:
+            for (size_t i = 0; i < n; ++i)
+                out[i] = in[i] > 0.5 ? 1.f : 0.f;
+            break;
+        case NONE:
+        default:
+            std::fill(out, out + n, 0.f);
+            break;
+        }
+    }
+    static void normalized01ToNatural(const NormalizationDescriptor &d, const float *in,
+                                      float *out, size_t n)
+    {
+        switch (d.type)
+        {
+        case FLOAT:
+            for (size_t i = 0; i < n; ++i)
+                out[i] = std::clamp(in[i], 0.f, 1.f) * d.range + d.minVal;
+            break;
+        case INT:
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto v = std::clamp(in[i], 0.f, 1.f);
+                out[i] = (int)((1 / 0.99) * (v - 0.005) * d.range + 0.5) + d.minVal;
+            }
+            break;
+        case BOOL:
+            for (size_t i = 0; i < n; ++i)
+                out[i] = in[i] > 0.5 ? d.minVal + d.range : d.minVal;
+            break;
+        case NONE:
+        default:
+            std::fill(out, out + n, 0.f);
+            break;
+        }
+    }
+    void naturalToNormalized01(const float *in, float *out, size_t n) const
+    {
+        naturalToNormalized01(normalizationDescriptor(), in, out, n);
+    }
+    void normalized01ToNatural(const float *in, float *out, size_t n) const
+    {
+        normalized01ToNatural(normalizationDescriptor(), in, out, n);
+    }
+
+    /*
+     * Everything here with a string or a map in it is for display, and a ParamMetaData is
+     * a few hundred bytes before the strings spill to the heap. The audio thread only needs
+     * the range and the shape of the scale, so hotDescriptor() extracts those into a 32
+     * byte trivially copyable HotDescriptor, and a HotDescriptorSet packs a whole plugin's
+     * worth of them contiguously. Both are defined below the class.
+     */
+    struct HotDescriptor;
+    struct HotDescriptorSet;
+    HotDescriptor hotDescriptor() const;
+
     ParamMetaData withType(Type t)
     {
         auto res = *this;
@@ -694,6 +827,92 @@ struct ParamMetaData
     }
 
     std::string temposyncNotation(float f) const;
+    size_t temposyncNotation(float f, char *out, size_t outSize) const;
+
+  private:
+    // fmt::format_to_n into out with a terminating null; returns the untruncated length
+    template <typename... Args>
+    static size_t formatInto(char *out, size_t outSize, fmt::format_string<Args...> f,
+                             Args &&...args)
+    {
+        if (outSize == 0)
+            return fmt::formatted_size(f, std::forward<Args>(args)...);
+        auto r = fmt::format_to_n(out, outSize - 1, f, std::forward<Args>(args)...);
+        *(r.size < outSize ? r.out : out + outSize - 1) = 0;
+        return r.size;
+    }
+
+    // calls the buffer version, retrying on the heap only if the label is unusually long
+    template <typename F> static std::optional<std::string> toStdString(F &&write)
+    {
+        char buf[256];
+        auto n = write(buf, sizeof(buf));
+        if (!n.has_value())
+            return std::nullopt;
+        if (*n < sizeof(buf))
+            return std::string(buf, *n);
+        std::string res(*n + 1, '\0');
+        write(res.data(), res.size());
+        res.resize(*n);
+        return res;
+    }
+
+    /*
+     * The stof/atoi replacements used by the parsers. Like stof, parseFloat skips leading
+     * whitespace and a '+' and reads the longest number at the front of the string, so
+     * "0.20 s" is 0.2; it fails on no number or float overflow. parseInt is atoi: 0 on
+     * no digits or overflow. Where the standard library lacks floating from_chars we fall back to
+     * strtof on a bounded stack copy, which is what stof calls anyway.
+     */
+    static std::string_view skipNumberPrefix(std::string_view v)
+    {
+        size_t i{0};
+        while (i < v.size() && std::isspace((unsigned char)v[i]))
+            i++;
+        if (i + 1 < v.size() && v[i] == '+' && v[i + 1] != '-' && v[i + 1] != '+')
+            i++;
+        return v.substr(i);
+    }
+
+    static bool parseFloat(std::string_view v, float &res)
+    {
+        v = skipNumberPrefix(v);
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        // from_chars wants hex without its prefix and a sign, which strtof takes with both
+        auto neg = !v.empty() && v[0] == '-';
+        auto h = v.substr(neg ? 1 : 0);
+        if (h.size() > 2 && h[0] == '0' && (h[1] == 'x' || h[1] == 'X') &&
+            std::isxdigit((unsigned char)h[2]))
+        {
+            auto r = std::from_chars(h.data() + 2, h.data() + h.size(), res,
+                                     std::chars_format::hex);
+            res = neg ? -res : res;
+            return r.ec == std::errc();
+        }
+        auto r = std::from_chars(v.data(), v.data() + v.size(), res);
+        return r.ec == std::errc();
+#else
+        char buf[64];
+        auto n = std::min(v.size(), sizeof(buf) - 1);
+        std::copy(v.begin(), v.begin() + n, buf);
+        buf[n] = 0;
+        char *end{nullptr};
+        errno = 0;
+        res = std::strtof(buf, &end);
+        return end != buf && errno != ERANGE;
+#endif
+    }
+
+    static int parseInt(std::string_view v)
+    {
+        v = skipNumberPrefix(v);
+        int res{0};
+        if (std::from_chars(v.data(), v.data() + v.size(), res).ec != std::errc())
+            return 0;
+        return res;
+    }
+
+  public:
 
     /*
      * OK so I'm doing something a bit tricky here. I want to be able to project
@@ -713,17 +932,166 @@ struct ParamMetaData
     }
 };
 
+struct ParamMetaData::HotDescriptor
+{
+    float minVal{0.f}, maxVal{1.f}, defaultVal{0.f};
+    float svA{0.f}, svB{0.f}, svC{0.f}, svD{0.f};
+
+    // the enums are stored as bytes to keep this at 32 bytes; use the accessors
+    uint8_t typeByte{FLOAT}, displayScaleByte{LINEAR};
+    uint8_t polarityByte{(uint8_t)Polarity::NO_POLARITY}; // resolved, never INFERRED
+
+    enum Features : uint8_t
+    {
+        CAN_EXTEND = 1 << 0,
+        CAN_DEFORM = 1 << 1,
+        CAN_ABSOLUTE = 1 << 2,
+        CAN_TEMPOSYNC = 1 << 3,
+        CAN_DEACTIVATE = 1 << 4
+    };
+    uint8_t features{0};
+
+    Type type() const { return (Type)typeByte; }
+    DisplayScale displayScale() const { return (DisplayScale)displayScaleByte; }
+    Polarity polarity() const { return (Polarity)polarityByte; }
+    bool has(Features f) const { return features & f; }
+    bool isBipolar() const { return polarity() == Polarity::BIPOLAR; }
+
+    NormalizationDescriptor normalizationDescriptor() const
+    {
+        return {type(), minVal, maxVal - minVal};
+    }
+    float naturalToNormalized01(float v) const
+    {
+        float r;
+        ParamMetaData::naturalToNormalized01(normalizationDescriptor(), &v, &r, 1);
+        return r;
+    }
+    float normalized01ToNatural(float v) const
+    {
+        float r;
+        ParamMetaData::normalized01ToNatural(normalizationDescriptor(), &v, &r, 1);
+        return r;
+    }
+
+    /*
+     * The number valueToString would print for a natural value, before extension and
+     * alternate-unit rescaling, so a lane can be drawn on a Hz or dB axis. Scales with no
+     * numeric form return the natural value.
+     */
+    float displayValue(float val) const
+    {
+        switch (displayScale())
+        {
+        case LINEAR:
+            return svA * val;
+        case A_TWO_TO_THE_B:
+            return svA * pow(2.0, svB * val + svC);
+        case SCALED_OFFSET_EXP:
+            return (std::exp(svA + val * (svB - svA)) + svC) / svD;
+        case CUBED_AS_DECIBEL:
+            if (val <= 0)
+                return -std::numeric_limits<float>::infinity();
+            return 20 * std::log10(val * val * val * svA);
+        default:
+            break;
+        }
+        return val;
+    }
+};
+static_assert(sizeof(ParamMetaData::HotDescriptor) == 32);
+static_assert(std::is_trivially_copyable_v<ParamMetaData::HotDescriptor>);
+
+/*
+ * The hot descriptors for a parameter set in one contiguous array, indexed in the order
+ * the params were added. Building the set allocates, so do it off the audio thread;
+ * indexing and iterating do not allocate.
+ */
+struct ParamMetaData::HotDescriptorSet
+{
+    HotDescriptorSet() = default;
+    template <typename It> HotDescriptorSet(It b, It e)
+    {
+        reserve(std::distance(b, e));
+        for (; b != e; ++b)
+            add(*b);
+    }
+
+    void reserve(size_t n)
+    {
+        descriptors.reserve(n);
+        ids.reserve(n);
+    }
+    size_t add(const ParamMetaData &p)
+    {
+        descriptors.push_back(p.hotDescriptor());
+        ids.push_back(p.id);
+        return descriptors.size() - 1;
+    }
+
+    const HotDescriptor &operator[](size_t i) const { return descriptors[i]; }
+    const HotDescriptor *data() const { return descriptors.data(); }
+    size_t size() const { return descriptors.size(); }
+    auto begin() const { return descriptors.begin(); }
+    auto end() const { return descriptors.end(); }
+
+    // ids are kept apart from the descriptors since the block loop never reads them
+    uint32_t idAt(size_t i) const { return ids[i]; }
+    std::optional<size_t> indexOf(uint32_t id) const
+    {
+        auto it = std::find(ids.begin(), ids.end(), id);
+        if (it == ids.end())
+            return std::nullopt;
+        return (size_t)std::distance(ids.begin(), it);
+    }
+
+  private:
+    std::vector<HotDescriptor> descriptors;
+    std::vector<uint32_t> ids;
+};
+
+inline ParamMetaData::HotDescriptor ParamMetaData::hotDescriptor() const
+{
+    HotDescriptor h;
+    h.minVal = minVal;
+    h.maxVal = maxVal;
+    h.defaultVal = defaultVal;
+    h.svA = svA;
+    h.svB = svB;
+    h.svC = svC;
+    h.svD = svD;
+    h.typeByte = (uint8_t)type;
+    h.displayScaleByte = (uint8_t)displayScale;
+    h.polarityByte = (uint8_t)getPolarity();
+    h.features = (canExtend ? HotDescriptor::CAN_EXTEND : 0) |
+                 (canDeform ? HotDescriptor::CAN_DEFORM : 0) |
+                 (canAbsolute ? HotDescriptor::CAN_ABSOLUTE : 0) |
+                 (canTemposync ? HotDescriptor::CAN_TEMPOSYNC : 0) |
+                 (canDeactivate ? HotDescriptor::CAN_DEACTIVATE : 0);
+    return h;
+}
+
 /*
  * Implementation below here
  */
 inline std::optional<std::string> ParamMetaData::valueToString(float val,
                                                                const FeatureState &fs) const
 {
+    return toStdString([&](char *out, size_t n) { return valueToString(val, out, n, fs); });
+}
+
+inline std::optional<size_t> ParamMetaData::valueToString(float val, char *out, size_t outSize,
+                                                          const FeatureState &fs) const
+{
+    auto copy = [out, outSize](std::string_view v) {
+        return formatInto(out, outSize, "{}", v);
+    };
+
     if (type == BOOL)
     {
         if (val < 0.5)
-            return customMinDisplay.empty() ? "Off" : customMinDisplay;
-        return customMaxDisplay.empty() ? "On" : customMaxDisplay;
+            return copy(customMinDisplay.empty() ? "Off" : customMinDisplay);
+        return copy(customMaxDisplay.empty() ? "On" : customMaxDisplay);
     }
 
     if (type == INT)
@@ -732,44 +1100,42 @@ inline std::optional<std::string> ParamMetaData::valueToString(float val,
         if (displayScale == UNORDERED_MAP)
         {
             if (discreteValues.find(iv) != discreteValues.end())
-                return discreteValues.at(iv);
+                return copy(discreteValues.at(iv));
             return std::nullopt;
         }
         if (displayScale == MIDI_NOTE)
         {
             if (iv < 0)
-                return "";
+                return copy("");
             auto n = iv;
             auto o = n / 12 - 1 + midiNoteOctaveOffset;
             auto ni = n % 12;
-            static std::array<std::string, 12> nn{"C",  "C#", "D",  "D#", "E",  "F",
-                                                  "F#", "G",  "G#", "A",  "A#", "B"};
+            static constexpr const char *nn[12]{"C",  "C#", "D",  "D#", "E",  "F",
+                                                "F#", "G",  "G#", "A",  "A#", "B"};
 
-            auto res = nn[ni] + std::to_string(o);
-
-            return res;
+            return formatInto(out, outSize, "{}{}", nn[ni], o);
         }
         if (displayScale == LINEAR)
         {
-            return std::to_string(iv) + (unit.empty() ? "" : " ") + unit;
+            return formatInto(out, outSize, "{}{}{}", iv, (unit.empty() ? "" : " "), unit);
         }
 
         return std::nullopt;
     }
 
     if (!customMinDisplay.empty() && val == minVal)
-        return customMinDisplay;
+        return copy(customMinDisplay);
     if (!customMaxDisplay.empty() && val == maxVal)
-        return customMaxDisplay;
+        return copy(customMaxDisplay);
     if (!customDefaultDisplay.empty() && val == defaultVal)
-        return customDefaultDisplay;
+        return copy(customDefaultDisplay);
 
     if (fs.isExtended)
         val = exA * val + exB;
 
     if (fs.isTemposynced)
     {
-        return temposyncNotation(temposyncMultiplier * val);
+        return temposyncNotation(temposyncMultiplier * val, out, outSize);
     }
 
     // float cases
@@ -778,7 +1144,7 @@ inline std::optional<std::string> ParamMetaData::valueToString(float val,
     case LINEAR:
         if (alternateScaleWhen == NO_ALTERNATE)
         {
-            return fmt::format("{:.{}f} {:s}", svA * val,
+            return formatInto(out, outSize, "{:.{}f} {:s}", svA * val,
                                (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces), unit);
         }
         else
@@ -788,13 +1154,13 @@ inline std::optional<std::string> ParamMetaData::valueToString(float val,
                 (alternateScaleWhen == SCALE_ABOVE && rsv > alternateScaleCutoff))
             {
                 rsv = rsv * alternateScaleRescaling;
-                return fmt::format("{:.{}f} {:s}", rsv,
+                return formatInto(out, outSize, "{:.{}f} {:s}", rsv,
                                    (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces),
                                    alternateScaleUnits);
             }
             else
             {
-                return fmt::format("{:.{}f} {:s}", svA * val,
+                return formatInto(out, outSize, "{:.{}f} {:s}", svA * val,
                                    (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces),
                                    unit);
             }
@@ -803,7 +1169,7 @@ inline std::optional<std::string> ParamMetaData::valueToString(float val,
     case A_TWO_TO_THE_B:
         if (alternateScaleWhen == NO_ALTERNATE)
         {
-            return fmt::format("{:.{}f} {:s}", svA * pow(2.0, svB * val + svC),
+            return formatInto(out, outSize, "{:.{}f} {:s}", svA * pow(2.0, svB * val + svC),
                                (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces), unit);
         }
         else
@@ -813,13 +1179,13 @@ inline std::optional<std::string> ParamMetaData::valueToString(float val,
                 (alternateScaleWhen == SCALE_ABOVE && rsv > alternateScaleCutoff))
             {
                 rsv = rsv * alternateScaleRescaling;
-                return fmt::format("{:.{}f} {:s}", rsv,
+                return formatInto(out, outSize, "{:.{}f} {:s}", rsv,
                                    (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces),
                                    alternateScaleUnits);
             }
             else
             {
-                return fmt::format("{:.{}f} {:s}", rsv,
+                return formatInto(out, outSize, "{:.{}f} {:s}", rsv,
                                    (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces),
                                    unit);
             }
@@ -832,11 +1198,11 @@ inline std::optional<std::string> ParamMetaData::valueToString(float val,
             (alternateScaleWhen == SCALE_BELOW && dval > alternateScaleCutoff) ||
             (alternateScaleWhen == SCALE_ABOVE && dval < alternateScaleCutoff))
         {
-            return fmt::format("{:.{}f} {:s}", dval,
+            return formatInto(out, outSize, "{:.{}f} {:s}", dval,
                                (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces), unit);
         }
         // We must be in an alternate case
-        return fmt::format("{:.{}f} {:s}", dval * alternateScaleRescaling,
+        return formatInto(out, outSize, "{:.{}f} {:s}", dval * alternateScaleRescaling,
                            (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces),
                            alternateScaleUnits);
     }
@@ -845,12 +1211,12 @@ inline std::optional<std::string> ParamMetaData::valueToString(float val,
     {
         if (val <= 0)
         {
-            return "-inf";
+            return copy("-inf");
         }
 
         auto v3 = val * val * val * svA;
         auto db = 20 * std::log10(v3);
-        return fmt::format("{:.{}f} dB", db,
+        return formatInto(out, outSize, "{:.{}f} dB", db,
                            (fs.isHighPrecision ? (decimalPlaces + 4) : decimalPlaces));
     }
     break;
@@ -860,9 +1226,57 @@ inline std::optional<std::string> ParamMetaData::valueToString(float val,
     return std::nullopt;
 }
 
+inline std::optional<size_t> ParamMetaData::parseErrorToString(const ParseError &err, char *out,
+                                                               size_t outSize) const
+{
+    switch (err.code)
+    {
+    case ParseError::NONE:
+        return formatInto(out, outSize, "");
+    case ParseError::INVALID_NUMBER:
+    case ParseError::OUT_OF_RANGE:
+    {
+        char nv[128], xv[128];
+        auto nn = valueToString(minVal, nv, sizeof(nv));
+        auto xn = valueToString(maxVal, xv, sizeof(xv));
+        if (nn.has_value() && xn.has_value())
+            return formatInto(out, outSize, "{} < val < {}",
+                              std::string_view(nv, std::min(*nn, sizeof(nv) - 1)),
+                              std::string_view(xv, std::min(*xn, sizeof(xv) - 1)));
+        return formatInto(out, outSize, "Invalid input");
+    }
+    case ParseError::EXCEEDS_MAX_DEPTH:
+        return formatInto(out, outSize, "Maximum depth: {} {}", (maxVal - minVal) * svA, unit);
+    case ParseError::UNSUPPORTED_CONVERSION:
+        return formatInto(out, outSize, "Unsupported conversion");
+    }
+    return std::nullopt;
+}
+
+inline std::string ParamMetaData::parseErrorToString(const ParseError &err) const
+{
+    return *toStdString([&](char *out, size_t n) { return parseErrorToString(err, out, n); });
+}
+
 inline std::optional<float> ParamMetaData::valueFromString(std::string_view v, std::string &errMsg,
                                                            const FeatureState &fs) const
 {
+    ParseError err;
+    auto res = valueFromString(v, err, fs);
+    if (!res.has_value() && err.code != ParseError::UNSUPPORTED_CONVERSION)
+        errMsg = parseErrorToString(err);
+    return res;
+}
+
+inline std::optional<float> ParamMetaData::valueFromString(std::string_view v, ParseError &err,
+                                                           const FeatureState &fs) const
+{
+    err.code = ParseError::NONE;
+    auto fail = [&err](ParseError::Code c) -> std::optional<float> {
+        err.code = c;
+        return std::nullopt;
+    };
+
     if (type == BOOL)
     {
         if (v == "On" || v == "on" || v == "1" || v == "true" || v == "True")
@@ -874,14 +1288,13 @@ inline std::optional<float> ParamMetaData::valueFromString(std::string_view v, s
     {
         if (displayScale == MIDI_NOTE)
         {
-            auto s = std::string(v);
-            auto c0 = std::toupper(s[0]);
+            auto c0 = std::toupper(v.empty() ? 0 : (unsigned char)v[0]);
             if (c0 >= 'A' && c0 <= 'G')
             {
                 auto n0 = c0 - 'A';
-                auto sharp = s[1] == '#';
-                auto flat = s[1] == 'b';
-                auto oct = std::atoi(s.c_str() + 1 + (sharp ? 1 : 0) + (flat ? 1 : 0));
+                auto sharp = v.size() > 1 && v[1] == '#';
+                auto flat = v.size() > 1 && v[1] == 'b';
+                auto oct = parseInt(v.substr(1 + (sharp ? 1 : 0) + (flat ? 1 : 0)));
 
                 std::array<int, 7> noteToPosition{9, 11, 0, 2, 4, 5, 7};
                 auto res =
@@ -889,13 +1302,13 @@ inline std::optional<float> ParamMetaData::valueFromString(std::string_view v, s
                 return (float)res;
             }
             else
-                return (float)std::atoi(s.c_str());
+                return (float)parseInt(v);
         }
         if (displayScale == LINEAR)
         {
-            return (float)std::atoi(std::string(v).c_str());
+            return (float)parseInt(v);
         }
-        return std::nullopt;
+        return fail(ParseError::UNSUPPORTED_CONVERSION);
     }
 
     if (!customMinDisplay.empty() && v == customMinDisplay)
@@ -904,165 +1317,128 @@ inline std::optional<float> ParamMetaData::valueFromString(std::string_view v, s
     if (!customMaxDisplay.empty() && v == customMaxDisplay)
         return maxVal;
 
-    auto rangeMsg = [this]() {
-        std::string em;
-        auto nv = valueToString(minVal);
-        auto xv = valueToString(maxVal);
-        if (nv.has_value() && xv.has_value())
-            em = fmt::format("{} < val < {}", *nv, *xv);
-        else
-            em = fmt::format("Invalid input");
-        return em;
-    };
     switch (displayScale)
     {
     case LINEAR:
     {
-        try
-        {
-            auto r = std::stof(std::string(v));
-            assert(svA != 0);
-            r = r / svA;
-
-            if (alternateScaleWhen != NO_ALTERNATE)
-            {
-                auto ps = v.find(alternateScaleUnits);
-                if (ps != std::string::npos && alternateScaleRescaling != 0.f)
-                {
-                    // We have a string containing the alterante units
-                    r = r / alternateScaleRescaling;
-                }
-            }
-
-            if (fs.isExtended)
-            {
-                r = (r - exB) / exA;
-            }
+        float r;
+        if (!parseFloat(v, r))
+            return fail(ParseError::INVALID_NUMBER);
+        assert(svA != 0);
+        r = r / svA;
 
-            if (r < minVal || r > maxVal)
+        if (alternateScaleWhen != NO_ALTERNATE)
+        {
+            auto ps = v.find(alternateScaleUnits);
+            if (ps != std::string::npos && alternateScaleRescaling != 0.f)
             {
-                errMsg = rangeMsg();
-                return std::nullopt;
+                // We have a string containing the alterante units
+                r = r / alternateScaleRescaling;
             }
-
-            return r;
         }
-        catch (const std::exception &)
+
+        if (fs.isExtended)
         {
-            errMsg = rangeMsg();
-            return std::nullopt;
+            r = (r - exB) / exA;
         }
+
+        if (r < minVal || r > maxVal)
+            return fail(ParseError::OUT_OF_RANGE);
+
+        return r;
     }
     break;
     case A_TWO_TO_THE_B:
     {
-        try
-        {
-            auto r = std::stof(std::string(v));
-            assert(svA != 0);
-            assert(svB != 0);
+        float r;
+        if (!parseFloat(v, r))
+            return fail(ParseError::INVALID_NUMBER);
+        assert(svA != 0);
+        assert(svB != 0);
 
-            if (alternateScaleWhen != NO_ALTERNATE)
+        if (alternateScaleWhen != NO_ALTERNATE)
+        {
+            auto ps = v.find(alternateScaleUnits);
+            if (ps != std::string::npos && alternateScaleRescaling != 0.f)
             {
-                auto ps = v.find(alternateScaleUnits);
-                if (ps != std::string::npos && alternateScaleRescaling != 0.f)
-                {
-                    // We have a string containing the alterante units
-                    r = r / alternateScaleRescaling;
-                }
+                // We have a string containing the alterante units
+                r = r / alternateScaleRescaling;
             }
+        }
 
-            if (r < 0)
-            {
-                errMsg = rangeMsg();
-                return std::nullopt;
-            }
-            /* v = svA 2^(svB r + svC)
-             * log2(v / svA) = svB r + svC
-             * (log2(v/svA) - svC)/svB = r
-             */
-            r = (log2(r / svA) - svC) / svB;
-            if (r < minVal || r > maxVal)
-            {
-                errMsg = rangeMsg();
-                return std::nullopt;
-            }
+        if (r < 0)
+            return fail(ParseError::OUT_OF_RANGE);
 
-            return r;
-        }
-        catch (const std::exception &)
-        {
-            errMsg = rangeMsg();
-            return std::nullopt;
-        }
+        /* v = svA 2^(svB r + svC)
+         * log2(v / svA) = svB r + svC
+         * (log2(v/svA) - svC)/svB = r
+         */
+        r = (log2(r / svA) - svC) / svB;
+        if (r < minVal || r > maxVal)
+            return fail(ParseError::OUT_OF_RANGE);
+
+        return r;
     }
     break;
     case SCALED_OFFSET_EXP:
     {
-        try
-        {
-            auto r = std::stof(std::string(v));
+        float r;
+        if (!parseFloat(v, r))
+            return fail(ParseError::INVALID_NUMBER);
 
-            if (alternateScaleWhen != NO_ALTERNATE)
+        if (alternateScaleWhen != NO_ALTERNATE)
+        {
+            auto ps = v.find(alternateScaleUnits);
+            if (ps != std::string::npos && alternateScaleRescaling != 0.f)
             {
-                auto ps = v.find(alternateScaleUnits);
-                if (ps != std::string::npos && alternateScaleRescaling != 0.f)
-                {
-                    // We have a string containing the alterante units
-                    r = r / alternateScaleRescaling;
-                }
+                // We have a string containing the alterante units
+                r = r / alternateScaleRescaling;
             }
+        }
 
-            // OK so its R = exp(A + X (B-A)) - C)/D
-            // D R + C = exp(A + X (B-a))
-            // log(DR + C) = A + X (B-A)
-            // (log (DR + C) - A) / (B - A) = X
-            auto drc = std::max(svD * r + svC, 0.00000001f);
-            auto xv = (std::log(drc) - svA) / (svB - svA);
+        // OK so its R = exp(A + X (B-A)) - C)/D
+        // D R + C = exp(A + X (B-a))
+        // log(DR + C) = A + X (B-A)
+        // (log (DR + C) - A) / (B - A) = X
+        auto drc = std::max(svD * r + svC, 0.00000001f);
+        auto xv = (std::log(drc) - svA) / (svB - svA);
 
-            return xv;
-        }
-        catch (const std::exception &)
-        {
-            errMsg = rangeMsg();
-            return std::nullopt;
-        }
-        return 0.f;
+        return xv;
     }
     break;
     case CUBED_AS_DECIBEL:
     {
-        try
-        {
-            if (v == "-inf")
-                return 0.f;
+        if (v == "-inf")
+            return 0.f;
 
-            auto r = std::stof(std::string(v));
-            auto db = pow(10.f, r / 20);
-            auto lv = std::cbrt(db / svA);
-            if (lv < minVal || lv > maxVal)
-            {
-                errMsg = rangeMsg();
-                return std::nullopt;
-            }
+        float r;
+        if (!parseFloat(v, r))
+            return fail(ParseError::INVALID_NUMBER);
+        auto db = pow(10.f, r / 20);
+        auto lv = std::cbrt(db / svA);
+        if (lv < minVal || lv > maxVal)
+            return fail(ParseError::OUT_OF_RANGE);
 
-            return (float)lv;
-        }
-        catch (const std::exception &)
-        {
-            errMsg = rangeMsg();
-            return std::nullopt;
-        }
+        return (float)lv;
     }
     break;
     default:
         break;
     }
-    return std::nullopt;
+    return fail(ParseError::UNSUPPORTED_CONVERSION);
 }
 
 inline std::optional<std::string> ParamMetaData::valueToAlternateString(float val) const
 {
+    return toStdString([&](char *out, size_t n) { return valueToAlternateString(val, out, n); });
+}
+
+inline std::optional<size_t> ParamMetaData::valueToAlternateString(float /* val */, char *out,
+                                                                   size_t outSize) const
+{
+    // no parameter has an alternate display yet, so leave an empty terminated buffer
+    if (out && outSize)
+        out[0] = 0;
     return std::nullopt;
 }
 
@@ -1293,60 +1669,68 @@ inline std::optional<float>
 ParamMetaData::modulationNaturalFromString(std::string_view deltaNatural, float naturalBaseVal,
                                            std::string &errMsg) const
 {
+    ParseError err;
+    auto res = modulationNaturalFromString(deltaNatural, naturalBaseVal, err);
+    if (!res.has_value() && err.code == ParseError::EXCEEDS_MAX_DEPTH)
+        errMsg = parseErrorToString(err);
+    return res;
+}
+
+inline std::optional<float>
+ParamMetaData::modulationNaturalFromString(std::string_view deltaNatural, float naturalBaseVal,
+                                           ParseError &err) const
+{
+    err.code = ParseError::NONE;
+    auto fail = [&err](ParseError::Code c) -> std::optional<float> {
+        err.code = c;
+        return std::nullopt;
+    };
+
     switch (displayScale)
     {
     case LINEAR:
     {
-        try
-        {
-            auto mv = std::stof(std::string(deltaNatural)) / svA;
-            if (std::fabs(mv) > (maxVal - minVal))
-            {
-                errMsg = fmt::format("Maximum depth: {} {}", (maxVal - minVal) * svA, unit);
-                return std::nullopt;
-            }
-            return mv;
-        }
-        catch (const std::exception &e)
-        {
-            return std::nullopt;
-        }
+        float mv;
+        if (!parseFloat(deltaNatural, mv))
+            return fail(ParseError::INVALID_NUMBER);
+        mv = mv / svA;
+        if (std::fabs(mv) > (maxVal - minVal))
+            return fail(ParseError::EXCEEDS_MAX_DEPTH);
+        return mv;
     }
     break;
     case A_TWO_TO_THE_B:
     {
-        try
-        {
-            auto xbv = svA * pow(2, svB * naturalBaseVal);
-            auto mv = std::stof(std::string(deltaNatural));
-            auto rv = xbv + mv;
-            if (rv < 0)
-            {
-                return std::nullopt;
-            }
+        auto xbv = svA * pow(2, svB * naturalBaseVal);
+        float mv;
+        if (!parseFloat(deltaNatural, mv))
+            return fail(ParseError::INVALID_NUMBER);
+        auto rv = xbv + mv;
+        if (rv < 0)
+            return fail(ParseError::OUT_OF_RANGE);
 
-            auto r = log2(rv / svA) / svB;
-            auto rg = maxVal - minVal;
-            if (r < -rg || r > rg)
-            {
-                return std::nullopt;
-            }
+        auto r = log2(rv / svA) / svB;
+        auto rg = maxVal - minVal;
+        if (r < -rg || r > rg)
+            return fail(ParseError::OUT_OF_RANGE);
 
-            return (float)(r - naturalBaseVal);
-        }
-        catch (const std::exception &e)
-        {
-            return std::nullopt;
-        }
+        return (float)(r - naturalBaseVal);
     }
     break;
     default:
         break;
     }
-    return std::nullopt;
+    return fail(ParseError::UNSUPPORTED_CONVERSION);
 }
 
 inline std::string ParamMetaData::temposyncNotation(float f) const
+{
+    return *toStdString([&](char *out, size_t n) -> std::optional<size_t> {
+        return temposyncNotation(f, out, n);
+    });
+}
+
+inline size_t ParamMetaData::temposyncNotation(float f, char *out, size_t outSize) const
 {
     float a, b = modff(f, &a);
 
@@ -1357,8 +1741,9 @@ inline std::string ParamMetaData::temposyncNotation(float f) const
     }
 
     float d, q;
-    std::string nn, t;
-    char tmp[1024];
+    const char *nn{""}, *t{""};
+    bool isFraction{false};
+    int denominator{0};
 
     if (f >= 1)
     {
@@ -1368,15 +1753,14 @@ inline std::string ParamMetaData::temposyncNotation(float f) const
         {
             if (std::fabs(q - floor(q + 0.01)) < 0.01)
             {
-                snprintf(tmp, 1024, "%d whole notes", (int)floor(q + 0.01));
+                return formatInto(out, outSize, "{} whole notes", (int)floor(q + 0.01));
             }
             else
             {
                 // this is the triplet case
-                snprintf(tmp, 1024, "%d whole triplets", (int)floor(q * 3.0 / 2.0 + 0.02));
+                return formatInto(out, outSize, "{} whole triplets",
+                                  (int)floor(q * 3.0 / 2.0 + 0.02));
             }
-            std::string res = tmp;
-            return res;
         }
         else if (q >= 2)
         {
@@ -1391,16 +1775,15 @@ inline std::string ParamMetaData::temposyncNotation(float f) const
         else if (q < 1.4)
         {
             t = "triplet";
-            if (nn == "whole")
+            if (std::string_view(nn) == "whole")
             {
                 nn = "double whole";
             }
             else
             {
                 q = pow(2.0, f - 1);
-                snprintf(tmp, 1024, "%d whole triplets", (int)floor(q * 3.0 / 2.0 + 0.02));
-                std::string res = tmp;
-                return res;
+                return formatInto(out, outSize, "{} whole triplets",
+                                  (int)floor(q * 3.0 / 2.0 + 0.02));
             }
         }
         else
@@ -1432,14 +1815,13 @@ inline std::string ParamMetaData::temposyncNotation(float f) const
         }
         else
         {
-            char tmp[1024];
-            snprintf(tmp, 1024, "1/%d", (int)d);
-            nn = tmp;
+            isFraction = true;
+            denominator = (int)d;
         }
     }
-    std::string res = nn + " " + t;
-
-    return res;
+    if (isFraction)
+        return formatInto(out, outSize, "1/{} {}", denominator, t);
+    return formatInto(out, outSize, "{} {}", nn, t);
 }
 
 } // namespace sst::basic_blocks::params
@@ -0,0 +1,174 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_PARAMS_PARAMMETADATASIMD_H
+#define INCLUDE_SST_BASIC_BLOCKS_PARAMS_PARAMMETADATASIMD_H
+
+/*
+ * SSE versions of the ParamMetaData batch normalization kernels, kept out of
+ * ParamMetadata.h so that header stays usable without SIMD. As with the rest of the
+ * SIMD code, include your SSE (or SIMDE) headers first. Results match the scalar
+ * ParamMetaData conversions bit for bit, the INT case included, since that keeps the
+ * surge double precision arithmetic.
+ */
+
+#include "ParamMetadata.h"
+
+namespace sst::basic_blocks::params::simd
+{
+namespace details
+{
+// std::clamp(x, 0, 1) lane by lane; maxps/minps return their second operand on NaN
+inline __m128 clamp01(__m128 x)
+{
+    return _mm_min_ps(_mm_set1_ps(1.f), _mm_max_ps(_mm_setzero_ps(), x));
+}
+
+// f is applied to four lanes at a time, fs to the remainder
+template <typename F, typename FS>
+inline void run(const float *in, float *out, size_t n, F &&f, FS &&fs)
+{
+    size_t i{0};
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, f(_mm_loadu_ps(in + i)));
+    for (; i < n; ++i)
+        out[i] = fs(in[i]);
+}
+} // namespace details
+
+inline void naturalToNormalized01(const ParamMetaData::NormalizationDescriptor &d,
+                                  const float *in, float *out, size_t n)
+{
+    using pmd = ParamMetaData;
+    auto scalar = [&d](float x) {
+        float r{0.f};
+        pmd::naturalToNormalized01(d, &x, &r, 1);
+        return r;
+    };
+    auto mn = _mm_set1_ps(d.minVal);
+    switch (d.type)
+    {
+    case pmd::FLOAT:
+    {
+        auto rg = _mm_set1_ps(d.range);
+        details::run(
+            in, out, n,
+            [&](__m128 x) { return details::clamp01(_mm_div_ps(_mm_sub_ps(x, mn), rg)); },
+            scalar);
+    }
+    break;
+    case pmd::INT:
+    {
+        auto rg = _mm_set1_pd(d.range);
+        auto sc = _mm_set1_pd(0.99), of = _mm_set1_pd(0.005);
+        auto half = [&](__m128d v) { return _mm_add_pd(of, _mm_div_pd(_mm_mul_pd(sc, v), rg)); };
+        details::run(
+            in, out, n,
+            [&](__m128 x) {
+                auto df = _mm_sub_ps(x, mn);
+                auto lo = _mm_cvtpd_ps(half(_mm_cvtps_pd(df)));
+                auto hi = _mm_cvtpd_ps(half(_mm_cvtps_pd(_mm_movehl_ps(df, df))));
+                return details::clamp01(_mm_movelh_ps(lo, hi));
+            },
+            scalar);
+    }
+    break;
+    case pmd::BOOL:
+    {
+        auto h = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.f);
+        details::run(
+            in, out, n, [&](__m128 x) { return _mm_and_ps(_mm_cmpgt_ps(x, h), one); },
+            scalar);
+    }
+    break;
+    case pmd::NONE:
+    default:
+        std::fill(out, out + n, 0.f);
+        break;
+    }
+}
+
+inline void normalized01ToNatural(const ParamMetaData::NormalizationDescriptor &d,
+                                  const float *in, float *out, size_t n)
+{
+    using pmd = ParamMetaData;
+    auto scalar = [&d](float x) {
+        float r{0.f};
+        pmd::normalized01ToNatural(d, &x, &r, 1);
+        return r;
+    };
+    auto mn = _mm_set1_ps(d.minVal);
+    switch (d.type)
+    {
+    case pmd::FLOAT:
+    {
+        auto rg = _mm_set1_ps(d.range);
+        details::run(
+            in, out, n,
+            [&](__m128 x) { return _mm_add_ps(_mm_mul_ps(details::clamp01(x), rg), mn); },
+            scalar);
+    }
+    break;
+    case pmd::INT:
+    {
+        auto rg = _mm_set1_pd(d.range);
+        auto sc = _mm_set1_pd(1 / 0.99), of = _mm_set1_pd(0.005), rnd = _mm_set1_pd(0.5);
+        auto half = [&](__m128d v) {
+            auto r = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(sc, _mm_sub_pd(v, of)), rg), rnd);
+            return _mm_cvttpd_epi32(r);
+        };
+        details::run(
+            in, out, n,
+            [&](__m128 x) {
+                auto c = details::clamp01(x);
+                auto lo = half(_mm_cvtps_pd(c));
+                auto hi = half(_mm_cvtps_pd(_mm_movehl_ps(c, c)));
+                return _mm_add_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi64(lo, hi)), mn);
+            },
+            scalar);
+    }
+    break;
+    case pmd::BOOL:
+    {
+        auto h = _mm_set1_ps(0.5f), mx = _mm_set1_ps(d.minVal + d.range);
+        details::run(
+            in, out, n,
+            [&](__m128 x) {
+                auto m = _mm_cmpgt_ps(x, h);
+                return _mm_or_ps(_mm_and_ps(m, mx), _mm_andnot_ps(m, mn));
+            },
+            scalar);
+    }
+    break;
+    case pmd::NONE:
+    default:
+        std::fill(out, out + n, 0.f);
+        break;
+    }
+}
+} // namespace sst::basic_blocks::params::simd
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_PARAMS_PARAMMETADATASIMD_H
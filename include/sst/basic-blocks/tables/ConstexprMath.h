@@ -0,0 +1,84 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_TABLES_CONSTEXPRMATH_H
+#define INCLUDE_SST_BASIC_BLOCKS_TABLES_CONSTEXPRMATH_H
+
+#include <cstdint>
+
+/*
+ * Just enough double precision math, usable in constant expressions, to generate the
+ * pow based tables at compile time (C++17 has no constexpr std::exp). The results agree
+ * with libm to a few double ulps, far below the float precision the tables are stored in.
+ * These are slow series evaluations meant for table generation, not for the audio thread.
+ */
+namespace sst::basic_blocks::tables::constexpr_math
+{
+static constexpr double ln2Hi{6.93147180369123816490e-01};
+static constexpr double ln2Lo{1.90821492927058770002e-10};
+static constexpr double ln10{2.30258509299404568402};
+
+// 2^k for integer k, exactly
+constexpr double ldexp1(int64_t k)
+{
+    double r = 1.0;
+    for (; k > 0; --k)
+        r *= 2.0;
+    for (; k < 0; ++k)
+        r *= 0.5;
+    return r;
+}
+
+constexpr double exp(double x)
+{
+    auto kd = x * (1.0 / (ln2Hi + ln2Lo));
+    auto k = (int64_t)(kd < 0 ? kd - 0.5 : kd + 0.5);
+    // |r| <= ln(2) / 2 so the series converges in a couple dozen terms
+    auto r = (x - k * ln2Hi) - k * ln2Lo;
+
+    double sum = 1.0, term = 1.0;
+    for (int n = 1; n < 30; ++n)
+    {
+        term *= r / n;
+        sum += term;
+    }
+    return sum * ldexp1(k);
+}
+
+// 2^x, exact for integer x
+constexpr double exp2(double x)
+{
+    auto k = (int64_t)(x < 0 ? x - 0.5 : x + 0.5);
+    auto f = x - (double)k;
+    if (f == 0)
+        return ldexp1(k);
+    return exp(f * (ln2Hi + ln2Lo)) * ldexp1(k);
+}
+
+constexpr double exp10(double x) { return exp(x * ln10); }
+} // namespace sst::basic_blocks::tables::constexpr_math
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_TABLES_CONSTEXPRMATH_H
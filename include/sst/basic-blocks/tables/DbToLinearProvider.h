@@ -28,6 +28,9 @@
 #define INCLUDE_SST_BASIC_BLOCKS_TABLES_DBTOLINEARPROVIDER_H
 
 #include <cmath>
+#include <cstddef>
+
+#include "sst/basic-blocks/tables/ConstexprMath.h"
 
 namespace sst::basic_blocks::tables
 {
@@ -43,6 +46,17 @@ struct DbToLinearProvider
             table_dB[i] = powf(10.f, 0.05f * ((float)i - 384.f));
         }
     }
+    // init() as a constant expression; see TwoToTheXProvider::generated()
+    static constexpr DbToLinearProvider generated()
+    {
+        DbToLinearProvider res{};
+        for (auto i = 0U; i < nPoints; i++)
+        {
+            res.table_dB[i] = (float)constexpr_math::exp10(0.05f * ((float)i - 384.f));
+        }
+        return res;
+    }
+
     float dbToLinear(float db) const
     {
         db += 384;
@@ -52,8 +66,34 @@ struct DbToLinearProvider
         return (1.f - a) * table_dB[e & (nPoints - 1)] + a * table_dB[(e + 1) & (nPoints - 1)];
     }
 
+    // four at once, matching dbToLinear lane for lane
+    __m128 dbToLinear(__m128 db) const
+    {
+        db = _mm_add_ps(db, _mm_set1_ps(384.f));
+        auto ei = _mm_cvttps_epi32(db);
+        auto a = _mm_sub_ps(db, _mm_cvtepi32_ps(ei));
+
+        const auto mask = _mm_set1_epi32(nPoints - 1);
+        int e0 alignas(16)[4], e1 alignas(16)[4];
+        _mm_store_si128((__m128i *)e0, _mm_and_si128(ei, mask));
+        _mm_store_si128((__m128i *)e1, _mm_and_si128(_mm_add_epi32(ei, _mm_set1_epi32(1)), mask));
+
+        auto t0 = _mm_setr_ps(table_dB[e0[0]], table_dB[e0[1]], table_dB[e0[2]], table_dB[e0[3]]);
+        auto t1 = _mm_setr_ps(table_dB[e1[0]], table_dB[e1[1]], table_dB[e1[2]], table_dB[e1[3]]);
+        return _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), a), t0), _mm_mul_ps(a, t1));
+    }
+
+    void dbToLinearBlock(const float *db, float *lin, size_t n) const
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(lin + i, dbToLinear(_mm_loadu_ps(db + i)));
+        for (; i < n; ++i)
+            lin[i] = dbToLinear(db[i]);
+    }
+
   private:
-    float table_dB[nPoints];
+    float table_dB[nPoints]{};
 };
 } // namespace sst::basic_blocks::tables
 #endif // SHORTCIRCUITXT_DBTOLINEARPROVIDER_H
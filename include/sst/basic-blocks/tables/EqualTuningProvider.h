@@ -30,6 +30,8 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "sst/basic-blocks/tables/ConstexprMath.h"
+
 namespace sst::basic_blocks::tables
 {
 struct EqualTuningProvider
@@ -50,6 +52,26 @@ struct EqualTuningProvider
         }
     }
 
+    // init() as a constant expression; see TwoToTheXProvider::generated()
+    static constexpr EqualTuningProvider generated()
+    {
+        namespace cxm = constexpr_math;
+        EqualTuningProvider res{};
+        for (auto i = 0U; i < tuning_table_size; i++)
+        {
+            res.table_pitch[i] = (float)cxm::exp2(((float)i - 256.f) * (1.f / 12.f));
+            res.table_pitch_inv[i] = 1.f / res.table_pitch[i];
+        }
+
+        for (auto i = 0U; i < 1001; ++i)
+        {
+            double twelths = i * 1.0 / 12.0 / 1000.0;
+            res.table_two_to_the[i] = (float)cxm::exp2(twelths);
+            res.table_two_to_the_minus[i] = (float)cxm::exp2(-twelths);
+        }
+        return res;
+    }
+
     /**
      * note is float offset from note 69 / A440
      * return is 2^(note * 12), namely frequency / 440.0
@@ -69,14 +91,54 @@ struct EqualTuningProvider
         return table_pitch[e] * pow2v;
     }
 
+    /*
+     * note_to_pitch for four notes, lane for lane identical to the scalar version. The table
+     * reads are scalar loads from the vector indices since SSE2 has no gather.
+     */
+    __m128 note_to_pitch(__m128 note) const
+    {
+        auto x = _mm_min_ps(_mm_max_ps(_mm_add_ps(note, _mm_set1_ps(256.f)), _mm_set1_ps(1.e-4f)),
+                            _mm_set1_ps(tuning_table_size - (float)1.e-4));
+        auto ei = _mm_cvttps_epi32(x);
+        auto a = _mm_sub_ps(x, _mm_cvtepi32_ps(ei));
+
+        auto pow2pos = _mm_mul_ps(a, _mm_set1_ps(1000.f));
+        auto pf = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(pow2pos)), _mm_set1_ps(999.f));
+        auto pow2frac = _mm_sub_ps(pow2pos, pf);
+        auto pi = _mm_cvttps_epi32(pf);
+
+        int e alignas(16)[4], idx alignas(16)[4];
+        _mm_store_si128((__m128i *)e, ei);
+        _mm_store_si128((__m128i *)idx, pi);
+
+        auto t0 = _mm_setr_ps(table_two_to_the[idx[0]], table_two_to_the[idx[1]],
+                              table_two_to_the[idx[2]], table_two_to_the[idx[3]]);
+        auto t1 = _mm_setr_ps(table_two_to_the[idx[0] + 1], table_two_to_the[idx[1] + 1],
+                              table_two_to_the[idx[2] + 1], table_two_to_the[idx[3] + 1]);
+        auto pow2v = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), pow2frac), t0),
+                                _mm_mul_ps(pow2frac, t1));
+        auto tp = _mm_setr_ps(table_pitch[e[0]], table_pitch[e[1]], table_pitch[e[2]],
+                              table_pitch[e[3]]);
+        return _mm_mul_ps(tp, pow2v);
+    }
+
+    void note_to_pitch_block(const float *note, float *pitch, size_t n) const
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(pitch + i, note_to_pitch(_mm_loadu_ps(note + i)));
+        for (; i < n; ++i)
+            pitch[i] = note_to_pitch(note[i]);
+    }
+
   protected:
     static constexpr size_t tuning_table_size = 512;
-    float table_pitch alignas(16)[tuning_table_size];
-    float table_pitch_inv alignas(16)[tuning_table_size];
-    float table_note_omega alignas(16)[2][tuning_table_size];
+    float table_pitch alignas(16)[tuning_table_size]{};
+    float table_pitch_inv alignas(16)[tuning_table_size]{};
+    float table_note_omega alignas(16)[2][tuning_table_size]{};
     // 2^0 -> 2^+/-1/12th. See comment in note_to_pitch
-    float table_two_to_the alignas(16)[1001];
-    float table_two_to_the_minus alignas(16)[1001];
+    float table_two_to_the alignas(16)[1001]{};
+    float table_two_to_the_minus alignas(16)[1001]{};
 };
 extern EqualTuningProvider equalTuning;
 } // namespace sst::basic_blocks::tables
@@ -0,0 +1,104 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_TABLES_LANCZOSTABLEPROVIDER_H
+#define INCLUDE_SST_BASIC_BLOCKS_TABLES_LANCZOSTABLEPROVIDER_H
+
+/*
+ * A special note on licensing: like LanczosResampler.h, which is its client,
+ * this file can be re-used either in a GPL3 or MIT licensing context. See the
+ * information in README.md.
+ */
+
+#include <cmath>
+#include <cstddef>
+
+namespace sst::basic_blocks::tables
+{
+/*
+ * The windowed kernel and its per-step derivative for a Lanczos resampler with window A,
+ * sampled at tableObs + 1 fractional offsets. Each row holds the 2A taps for one offset,
+ * zero padded to rowWidth, a multiple of 4, so SSE clients can read whole rows for any A.
+ *
+ * The tables are large and identical for every resampler, so rather than building a copy
+ * per instance use shared(), which builds them on first use. The function local static
+ * makes that initialization race free when resamplers are constructed on several threads.
+ */
+template <size_t A, size_t tableObs = 8192> struct LanczosTableProvider
+{
+    static_assert(A >= 1, "Lanczos window must be at least 1");
+    static constexpr size_t filterWidth{A * 2};
+    static constexpr size_t rowWidth{(filterWidth + 3) & ~(size_t)3};
+    static constexpr double dx{1.0 / tableObs};
+
+    float lanczosTable alignas(16)[tableObs + 1][rowWidth]{};
+    float lanczosTableDX alignas(16)[tableObs + 1][rowWidth]{};
+
+    static double kernel(double x)
+    {
+        if (fabs(x) < 1e-7)
+            return 1;
+        return A * std::sin(M_PI * x) * std::sin(M_PI * x / A) / (M_PI * M_PI * x * x);
+    }
+
+    LanczosTableProvider()
+    {
+        for (size_t t = 0; t < tableObs + 1; ++t)
+        {
+            double x0 = dx * t;
+            for (size_t i = 0; i < filterWidth; ++i)
+            {
+                double x = x0 + i - A;
+                lanczosTable[t][i] = kernel(x);
+            }
+        }
+        for (size_t t = 0; t < tableObs; ++t)
+        {
+            for (size_t i = 0; i < filterWidth; ++i)
+            {
+                // t+1 is fine here since the input goes up to tableObs + 1 size
+                lanczosTableDX[t][i] = lanczosTable[t + 1][i] - lanczosTable[t][i];
+            }
+        }
+        for (size_t i = 0; i < filterWidth; ++i)
+        {
+            // Wrap at the end - deriv is the same
+            lanczosTableDX[tableObs][i] = lanczosTableDX[0][i];
+        }
+    }
+
+    static const LanczosTableProvider &shared()
+    {
+        static const LanczosTableProvider instance;
+        return instance;
+    }
+
+    LanczosTableProvider(const LanczosTableProvider &) = delete;
+    LanczosTableProvider &operator=(const LanczosTableProvider &) = delete;
+};
+} // namespace sst::basic_blocks::tables
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_TABLES_LANCZOSTABLEPROVIDER_H
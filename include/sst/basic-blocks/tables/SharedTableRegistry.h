@@ -0,0 +1,184 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_TABLES_SHAREDTABLEREGISTRY_H
+#define INCLUDE_SST_BASIC_BLOCKS_TABLES_SHAREDTABLEREGISTRY_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/*
+ * A process wide registry of immutable tables. TableRegistry::acquire<T>() returns a
+ * SharedTable<T> handle to the one T for that type (and, optionally, sample rate). The
+ * table is built on first acquire, exactly once even with racing threads, and freed when the
+ * last handle goes away. Thirty plugin instances then hold thirty handles to one table, not
+ * thirty copies.
+ *
+ * A T is default constructed and then init() is called if it has one. For a sample rate
+ * keyed acquire, T is constructed from the double sample rate instead, and the unkeyed
+ * table lives apart from every keyed one, sample rate 0 included. Each table is
+ * allocated on its own cache lines. Acquiring and releasing take a lock, so do it at setup
+ * time; reading through a handle is a plain pointer dereference.
+ *
+ *   auto sinc = tables::TableRegistry::acquire<tables::SurgeSincTableProvider>();
+ *   dsp::SSESincDelayLine<8192> line(*sinc);
+ */
+namespace sst::basic_blocks::tables
+{
+namespace detail
+{
+template <typename T, typename = void> struct has_init : std::false_type
+{
+};
+template <typename T>
+struct has_init<T, std::void_t<decltype(std::declval<T &>().init())>> : std::true_type
+{
+};
+
+template <typename T> struct alignas(64) RegistryEntry
+{
+    alignas(64) T table;
+    alignas(64) size_t refs{0};
+    std::optional<double> key;
+
+    RegistryEntry()
+    {
+        if constexpr (has_init<T>::value)
+            table.init();
+    }
+    explicit RegistryEntry(double sampleRate) : table(sampleRate), key(sampleRate) {}
+};
+
+template <typename T> struct RegistryStore
+{
+    std::mutex lock;
+    // the unkeyed table sits under std::nullopt, apart from every sample rate
+    std::map<std::optional<double>, RegistryEntry<T> *> entries;
+
+    static RegistryStore &get()
+    {
+        static RegistryStore store;
+        return store;
+    }
+};
+} // namespace detail
+
+template <typename T> struct SharedTable
+{
+    SharedTable() = default;
+    SharedTable(const SharedTable &other) : entry(other.entry)
+    {
+        if (entry)
+        {
+            auto &st = detail::RegistryStore<T>::get();
+            std::lock_guard<std::mutex> g(st.lock);
+            entry->refs++;
+        }
+    }
+    SharedTable(SharedTable &&other) noexcept : entry(std::exchange(other.entry, nullptr)) {}
+    SharedTable &operator=(SharedTable other) noexcept
+    {
+        std::swap(entry, other.entry);
+        return *this;
+    }
+    ~SharedTable() { reset(); }
+
+    void reset()
+    {
+        if (!entry)
+            return;
+        auto &st = detail::RegistryStore<T>::get();
+        std::lock_guard<std::mutex> g(st.lock);
+        if (--entry->refs == 0)
+        {
+            st.entries.erase(entry->key);
+            delete entry;
+        }
+        entry = nullptr;
+    }
+
+    const T *get() const { return entry ? &entry->table : nullptr; }
+    const T &operator*() const { return entry->table; }
+    const T *operator->() const { return &entry->table; }
+    explicit operator bool() const { return entry != nullptr; }
+
+  private:
+    explicit SharedTable(detail::RegistryEntry<T> *e) : entry(e) {}
+    detail::RegistryEntry<T> *entry{nullptr};
+
+    friend struct TableRegistry;
+};
+
+struct TableRegistry
+{
+    template <typename T> static SharedTable<T> acquire()
+    {
+        return acquireImpl<T>(std::nullopt, []() { return new detail::RegistryEntry<T>(); });
+    }
+
+    template <typename T> static SharedTable<T> acquire(double sampleRate)
+    {
+        static_assert(std::is_constructible_v<T, double>,
+                      "Sample rate keyed tables must be constructible from the sample rate");
+        return acquireImpl<T>(sampleRate,
+                              [sampleRate]() { return new detail::RegistryEntry<T>(sampleRate); });
+    }
+
+    // how many handles share the table, mostly for tests and diagnostics
+    template <typename T> static size_t useCount() { return useCountImpl<T>(std::nullopt); }
+    template <typename T> static size_t useCount(double sampleRate)
+    {
+        return useCountImpl<T>(sampleRate);
+    }
+
+  private:
+    template <typename T> static size_t useCountImpl(const std::optional<double> &key)
+    {
+        auto &st = detail::RegistryStore<T>::get();
+        std::lock_guard<std::mutex> g(st.lock);
+        auto it = st.entries.find(key);
+        return (it == st.entries.end() || !it->second) ? 0 : it->second->refs;
+    }
+
+    template <typename T, typename F>
+    static SharedTable<T> acquireImpl(const std::optional<double> &key, F build)
+    {
+        auto &st = detail::RegistryStore<T>::get();
+        std::lock_guard<std::mutex> g(st.lock);
+        auto &e = st.entries[key];
+        if (!e)
+            e = build();
+        e->refs++;
+        return SharedTable<T>(e);
+    }
+};
+} // namespace sst::basic_blocks::tables
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_TABLES_SHAREDTABLEREGISTRY_H
@@ -0,0 +1,67 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+#ifndef INCLUDE_SST_BASIC_BLOCKS_TABLES_SINETABLEPROVIDER_H
+#define INCLUDE_SST_BASIC_BLOCKS_TABLES_SINETABLEPROVIDER_H
+
+#include <cmath>
+
+namespace sst::basic_blocks::tables
+{
+/*
+ * One cycle of sin(2 pi x) in tableSize points, for LFOs which interpolate a table
+ * with a wrapping mask (so tableSize must be a power of 2).
+ *
+ * Every client of a given size reads the same values, so share one copy with shared(),
+ * which is built on first use and is race free across threads. That keeps each client
+ * instance small and the one table warm in cache.
+ */
+template <int tableSize> struct SineTableProvider
+{
+    static_assert(tableSize > 0 && !(tableSize & (tableSize - 1)),
+                  "Sine table size must be a power of 2");
+    static constexpr int tableMask{tableSize - 1};
+
+    float table alignas(16)[tableSize];
+
+    SineTableProvider()
+    {
+        for (int i = 0; i < tableSize; ++i)
+            table[i] = sin(2.0 * M_PI * i / tableSize);
+    }
+
+    static const SineTableProvider &shared()
+    {
+        static const SineTableProvider instance;
+        return instance;
+    }
+
+    SineTableProvider(const SineTableProvider &) = delete;
+    SineTableProvider &operator=(const SineTableProvider &) = delete;
+};
+} // namespace sst::basic_blocks::tables
+
+#endif // INCLUDE_SST_BASIC_BLOCKS_TABLES_SINETABLEPROVIDER_H
@@ -27,9 +27,14 @@
 #ifndef INCLUDE_SST_BASIC_BLOCKS_TABLES_TWOTOTHEXPROVIDER_H
 #define INCLUDE_SST_BASIC_BLOCKS_TABLES_TWOTOTHEXPROVIDER_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 
+#include "sst/basic-blocks/tables/ConstexprMath.h"
+
 namespace sst::basic_blocks::tables
 {
 struct TwoToTheXProvider
@@ -40,7 +45,7 @@ struct TwoToTheXProvider
     float baseValue[providerRange]{};
 
     static constexpr int nInterp{1001};
-    float table_two_to_the alignas(16)[nInterp];
+    float table_two_to_the alignas(16)[nInterp]{};
 
     void init()
     {
@@ -56,6 +61,30 @@ struct TwoToTheXProvider
         }
     }
 
+    /*
+     * The tables init() computes, as a constant expression. Writing
+     *   static constexpr auto twoX = TwoToTheXProvider::generated();
+     * puts them in read only data with no startup work. init() rounds the platform pow to
+     * float, so the entries match it to within one float ulp, and bit for bit where pow is
+     * correctly rounded, as with glibc.
+     */
+    static constexpr TwoToTheXProvider generated()
+    {
+        namespace cxm = constexpr_math;
+        TwoToTheXProvider res{};
+        for (int i = 0; i < providerRange; i++)
+        {
+            res.baseValue[i] = (float)cxm::exp2(i + intBase);
+        }
+
+        for (auto i = 0U; i < nInterp; ++i)
+        {
+            double frac = i * 1.0 / (nInterp - 1);
+            res.table_two_to_the[i] = (float)cxm::exp2(frac);
+        }
+        return res;
+    }
+
     float twoToThe(float x) const
     {
         auto xb = std::clamp(x - intBase, 0.f, providerRange * 1.f);
@@ -70,6 +99,48 @@ struct TwoToTheXProvider
 
         return baseValue[e] * pow2v;
     }
+
+    /*
+     * Four values at once with the same arithmetic as twoToThe, so the lanes match it
+     * exactly. SSE2 has no gather, so the table reads are scalar loads from the vector indices.
+     * The indices are clamped so x at the very top of the range stays inside the tables.
+     */
+    __m128 twoToThe(__m128 x) const
+    {
+        auto xb = _mm_sub_ps(x, _mm_set1_ps((float)intBase));
+        xb = _mm_min_ps(_mm_max_ps(xb, _mm_setzero_ps()), _mm_set1_ps(providerRange * 1.f));
+        auto ef = _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(xb)),
+                             _mm_set1_ps(providerRange - 1.f));
+        auto a = _mm_sub_ps(xb, ef);
+
+        auto pow2pos = _mm_mul_ps(a, _mm_set1_ps((float)(nInterp - 1)));
+        auto pf =
+            _mm_min_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(pow2pos)), _mm_set1_ps(nInterp - 2.f));
+        auto pow2frac = _mm_sub_ps(pow2pos, pf);
+        auto ei = _mm_cvttps_epi32(ef), pi = _mm_cvttps_epi32(pf);
+
+        int e alignas(16)[4], idx alignas(16)[4];
+        _mm_store_si128((__m128i *)e, ei);
+        _mm_store_si128((__m128i *)idx, pi);
+
+        auto t0 = _mm_setr_ps(table_two_to_the[idx[0]], table_two_to_the[idx[1]],
+                              table_two_to_the[idx[2]], table_two_to_the[idx[3]]);
+        auto t1 = _mm_setr_ps(table_two_to_the[idx[0] + 1], table_two_to_the[idx[1] + 1],
+                              table_two_to_the[idx[2] + 1], table_two_to_the[idx[3] + 1]);
+        auto pow2v = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), pow2frac), t0),
+                                _mm_mul_ps(pow2frac, t1));
+        auto bv = _mm_setr_ps(baseValue[e[0]], baseValue[e[1]], baseValue[e[2]], baseValue[e[3]]);
+        return _mm_mul_ps(bv, pow2v);
+    }
+
+    void twoToTheBlock(const float *in, float *out, size_t n) const
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(out + i, twoToThe(_mm_loadu_ps(in + i)));
+        for (; i < n; ++i)
+            out[i] = twoToThe(in[i]);
+    }
 };
 } // namespace sst::basic_blocks::tables
 
@@ -25,12 +25,22 @@
  */
 
 #include "catch2.hpp"
+// the pshufb and AVX2 endian paths are only compiled when immintrin.h comes first
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
 #include "smoke_test_sse.h"
 
 #include "sst/basic-blocks/mechanics/block-ops.h"
+#include "sst/basic-blocks/mechanics/block-fusion.h"
+#include "sst/basic-blocks/mechanics/endian-block-ops.h"
+#include "sst/basic-blocks/dsp/Clippers.h"
 
 namespace mech = sst::basic_blocks::mechanics;
 #include <iostream>
+#include <cmath>
+#include <cstring>
+#include <vector>
 
 TEST_CASE("Clear and Copy", "[block]")
 {
@@ -80,4 +90,233 @@ TEST_CASE("Clear and Copy", "[block]")
         for (int i = 0; i < bs; ++i)
             REQUIRE(0.75f * f[i] == g[i]);
     }
-}
\ No newline at end of file
+}
+template <size_t N> void checkBlockOpsAgainstScalar()
+{
+    INFO("Block size " << N);
+    mech::aligned_block<float, N> a, b, c;
+    float ua[N + 1], ub[N + 1]; // offset by one to force unaligned pointers
+    for (auto i = 0U; i < N; ++i)
+    {
+        a[i] = std::sin(i * 0.37) * 1.7;
+        b[i] = std::cos(i * 0.11) - 0.2;
+        ua[i + 1] = a[i];
+        ub[i + 1] = b[i];
+    }
+
+    float ref[N];
+    for (auto i = 0U; i < N; ++i)
+        ref[i] = b[i] + a[i] * 0.3f;
+    mech::scale_accumulate_from_to(a, 0.3f, b);
+    mech::scale_accumulate_from_to<N>(ua + 1, 0.3f, ub + 1);
+    for (auto i = 0U; i < N; ++i)
+    {
+        REQUIRE(b[i] == ref[i]);
+        REQUIRE(ub[i + 1] == ref[i]);
+    }
+
+    mech::mul_block(a, b, c);
+    for (auto i = 0U; i < N; ++i)
+        REQUIRE(c[i] == a[i] * b[i]);
+
+    mech::add_block<N>(ua + 1, ub + 1, c);
+    for (auto i = 0U; i < N; ++i)
+        REQUIRE(c[i] == a[i] + b[i]);
+
+    mech::copy_from_to(a, c);
+    mech::scale_by(-2.f, c);
+    mech::accumulate_from_to(b, c);
+    for (auto i = 0U; i < N; ++i)
+        REQUIRE(c[i] == a[i] * -2.f + b[i]);
+
+    auto mx = 0.f;
+    for (auto i = 0U; i < N; ++i)
+        mx = std::max(mx, std::fabs(c[i]));
+    REQUIRE(mech::blockAbsMax(c) == mx);
+    for (auto i = 0U; i < N; ++i)
+        ua[i + 1] = c[i];
+    REQUIRE(mech::blockAbsMax<N>(ua + 1) == mx);
+
+    mech::clear_block(c);
+    for (auto i = 0U; i < N; ++i)
+        REQUIRE(c[i] == 0.f);
+}
+
+TEST_CASE("Vectorized Block Ops", "[block]")
+{
+    // 7 is all tail, 36 has a partial register, 256 takes the rolled loop
+    checkBlockOpsAgainstScalar<7>();
+    checkBlockOpsAgainstScalar<16>();
+    checkBlockOpsAgainstScalar<36>();
+    checkBlockOpsAgainstScalar<64>();
+    checkBlockOpsAgainstScalar<256>();
+    REQUIRE(alignof(mech::aligned_block<float, 16>) >= 32);
+}
+
+TEST_CASE("Fused Block Ops", "[block]")
+{
+    namespace sdsp = sst::basic_blocks::dsp;
+    SECTION("Matches Separate Passes")
+    {
+        static constexpr int bs{64};
+        float in alignas(16)[bs], env alignas(16)[bs], tmp alignas(16)[bs];
+        float sep alignas(16)[bs], fused alignas(16)[bs];
+        for (int i = 0; i < bs; ++i)
+        {
+            in[i] = 1.4f * std::sin(i * 0.21);
+            env[i] = 0.5f + 0.5f * std::cos(i * 0.05);
+            sep[i] = fused[i] = 0.1f * std::sin(i * 0.9);
+        }
+
+        mech::mul_block<bs>(in, env, tmp);
+        mech::scale_by<bs>(1.7f, tmp);
+        sdsp::softclip_block<bs>(tmp);
+        mech::accumulate_from_to<bs>(tmp, sep);
+
+        mech::fuse<bs>(in).mul(env).scale(1.7f).shape(sdsp::softclip_shaper{}).accumulate_to(fused);
+        for (int i = 0; i < bs; ++i)
+            REQUIRE(fused[i] == Approx(sep[i]).margin(1e-7));
+
+        mech::fuse<bs>(in).add(env).shape(sdsp::tanh7_shaper{}).store_to(fused);
+        mech::add_block<bs>(in, env, tmp);
+        sdsp::tanh7_block<bs>(tmp);
+        for (int i = 0; i < bs; ++i)
+            REQUIRE(fused[i] == Approx(tmp[i]).margin(1e-7));
+    }
+
+    SECTION("Scalar Tail")
+    {
+        static constexpr int bs{13};
+        float in[bs], out[bs];
+        for (int i = 0; i < bs; ++i)
+            in[i] = 3.f * std::sin(i * 0.7);
+        mech::fuse<bs>(in).scale(0.5f).hardclip(0.8f).store_to(out);
+        for (int i = 0; i < bs; ++i)
+            REQUIRE(out[i] == std::clamp(in[i] * 0.5f, -0.8f, 0.8f));
+    }
+}
+
+TEST_CASE("Endian Block Conversion", "[block]")
+{
+    // odd lengths and an unaligned start exercise the scalar tails as well as the SIMD body
+    static constexpr size_t count{37};
+    std::vector<uint8_t> bytes(count * 4 + 1);
+    auto raw = bytes.data() + 1;
+    uint32_t seed{0x2468ace};
+    auto fill = [&]() {
+        for (size_t i = 0; i < bytes.size(); ++i)
+        {
+            seed = seed * 1664525 + 1013904223;
+            bytes[i] = (uint8_t)(seed >> 24);
+        }
+    };
+    // assemble sample i of a width byte format into the top of an int32
+    auto sampleAt = [&](size_t i, int width, bool be) {
+        uint32_t v{0};
+        for (int b = 0; b < width; ++b)
+            v |= (uint32_t)raw[i * width + (be ? width - 1 - b : b)] << (8 * (4 - width + b));
+        return (int32_t)v;
+    };
+
+    float out[count];
+    SECTION("Integer Reads")
+    {
+        for (int tries = 0; tries < 10; ++tries)
+        {
+            fill();
+            // include the extremes
+            raw[0] = 0x80;
+            raw[1] = 0x00;
+            raw[2] = 0x7F;
+            raw[3] = 0xFF;
+
+            auto check = [&](auto fn, int width, bool be) {
+                INFO("Width " << width << " big endian " << be);
+                fn(out, raw, count);
+                for (size_t i = 0; i < count; ++i)
+                    REQUIRE(out[i] == (float)sampleAt(i, width, be) / 2147483648.f);
+            };
+            check(mech::endian_read_block_int16LE, 2, false);
+            check(mech::endian_read_block_int16BE, 2, true);
+            check(mech::endian_read_block_int24LE, 3, false);
+            check(mech::endian_read_block_int24BE, 3, true);
+            check(mech::endian_read_block_int32LE, 4, false);
+            check(mech::endian_read_block_int32BE, 4, true);
+        }
+        mech::endian_read_block_int16BE(out, raw, 2);
+        REQUIRE(out[0] == Approx(-32768.f / 32768.f));
+        REQUIRE(out[1] == Approx(32767.f / 32768.f));
+    }
+
+    SECTION("Float Reads")
+    {
+        fill();
+        mech::endian_read_block_float32BE(out, raw, count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto v = (uint32_t)sampleAt(i, 4, true);
+            float f;
+            memcpy(&f, &v, sizeof(f));
+            REQUIRE(memcmp(&f, out + i, sizeof(f)) == 0);
+        }
+        mech::endian_read_block_float32LE(out, raw, count);
+        REQUIRE(memcmp(out, raw, count * sizeof(float)) == 0);
+    }
+
+    SECTION("Writes")
+    {
+        float in[count];
+        for (size_t i = 0; i < count; ++i)
+            in[i] = 2.4f * ((float)i / (count - 1)) - 1.2f;
+        in[3] = 1.f;
+        in[4] = -1.f;
+        in[5] = 0.f;
+
+        auto check = [&](auto fn, int width, bool be) {
+            INFO("Width " << width << " big endian " << be);
+            fn(raw, in, count);
+            double hi = std::ldexp(1.0, 8 * width - 1);
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto e = std::clamp(std::nearbyint((double)in[i] * hi), -hi, hi - 1);
+                if (width == 4)
+                    e = std::min(e, 2147483520.0);
+                REQUIRE(sampleAt(i, width, be) >> (8 * (4 - width)) == (int32_t)e);
+            }
+        };
+        check(mech::endian_write_block_int16LE, 2, false);
+        check(mech::endian_write_block_int16BE, 2, true);
+        check(mech::endian_write_block_int24LE, 3, false);
+        check(mech::endian_write_block_int24BE, 3, true);
+        check(mech::endian_write_block_int32LE, 4, false);
+        check(mech::endian_write_block_int32BE, 4, true);
+
+        mech::endian_write_block_float32BE(raw, in, count);
+        mech::endian_read_block_float32BE(out, raw, count);
+        REQUIRE(memcmp(out, in, sizeof(in)) == 0);
+
+        mech::endian_write_block_int24BE(raw, in, count);
+        mech::endian_read_block_int24BE(out, raw, count);
+        for (size_t i = 0; i < count; ++i)
+            REQUIRE(out[i] == Approx(std::clamp(in[i], -1.f, 1.f)).margin(1.0 / 8388608));
+    }
+
+    SECTION("Swaps")
+    {
+        fill();
+        auto orig = bytes;
+        mech::swap_endian_block16(raw, raw, count * 2);
+        for (size_t i = 0; i < count * 2; ++i)
+        {
+            REQUIRE(raw[2 * i] == orig[2 * i + 2]);
+            REQUIRE(raw[2 * i + 1] == orig[2 * i + 1]);
+        }
+        mech::swap_endian_block16(raw, raw, count * 2);
+        REQUIRE(bytes == orig);
+
+        std::vector<uint8_t> sw(count * 4);
+        mech::swap_endian_block32(sw.data(), raw, count);
+        for (size_t i = 0; i < count * 4; ++i)
+            REQUIRE(sw[i] == raw[(i & ~3) + 3 - (i & 3)]);
+    }
+}
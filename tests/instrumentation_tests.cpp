@@ -0,0 +1,147 @@
+/*
+ * sst-basic-blocks - an open source library of core audio utilities
+ * built by Surge Synth Team.
+ *
+ * Provides a collection of tools useful on the audio thread for blocks,
+ * modulation, etc... or useful for adapting code to multiple environments.
+ *
+ * Copyright 2023, various authors, as described in the GitHub
+ * transaction log. Parts of this code are derived from similar
+ * functions original in Surge or ShortCircuit.
+ *
+ * sst-basic-blocks is released under the GNU General Public Licence v3
+ * or later (GPL-3.0-or-later). The license is found in the "LICENSE"
+ * file in the root of this repository, or at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html.
+ *
+ * A very small number of explicitly chosen header files can also be
+ * used in an MIT/BSD context. Please see the README.md file in this
+ * repo or the comments in the individual files. Only headers with an
+ * explicit mention that they are dual licensed may be copied and reused
+ * outside the GPL3 terms.
+ *
+ * All source in sst-basic-blocks available at
+ * https://github.com/surge-synthesizer/sst-basic-blocks
+ */
+
+/*
+ * This file turns the probes on, so everything it instantiates uses a provider, config or
+ * block size no other test uses. That keeps the probed inline functions from clashing with
+ * the unprobed ones the rest of the tests instantiate.
+ */
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct RecordingSink
+{
+    struct Event
+    {
+        std::string name;
+        bool begin;
+        uint64_t cycles;
+    };
+    static inline std::vector<Event> events;
+
+    static void begin(const char *name, uint64_t c) { events.push_back({name, true, c}); }
+    static void end(const char *name, uint64_t c) { events.push_back({name, false, c}); }
+};
+#define SST_BASIC_BLOCKS_PROBE_SINK RecordingSink
+
+#include "catch2.hpp"
+#include "smoke_test_sse.h"
+
+#include "sst/basic-blocks/mod-matrix/ModMatrix.h"
+#include "sst/basic-blocks/dsp/LanczosResampler.h"
+#include "sst/basic-blocks/modulators/ADSREnvelope.h"
+#include "sst/basic-blocks/modulators/SimpleLFO.h"
+
+namespace
+{
+static constexpr int probeBlockSize{16};
+static constexpr int resamplerBlockSize{24};
+
+struct ProbeSRProvider
+{
+    double samplerate{48000}, sampleRateInv{1.0 / 48000};
+    float envelope_rate_linear_nowrap(float f) const
+    {
+        return probeBlockSize * sampleRateInv * pow(2.f, -f);
+    }
+};
+
+struct ProbeMatrixConfig
+{
+    using SourceIdentifier = int;
+    using TargetIdentifier = int;
+    using CurveIdentifier = int;
+    using RoutingExtraPayload = int;
+
+    static bool isTargetModMatrixDepth(const TargetIdentifier &) { return false; }
+    static size_t getTargetModMatrixElement(const TargetIdentifier &) { return 0; }
+
+    static constexpr bool IsFixedMatrix{true};
+    static constexpr size_t FixedMatrixSize{4};
+};
+
+// each call leaves exactly one begin and one end, in order, with time moving forward
+void requireOneScope(const std::string &name)
+{
+    auto &ev = RecordingSink::events;
+    REQUIRE(ev.size() == 2);
+    REQUIRE(ev[0].name == name);
+    REQUIRE(ev[0].begin);
+    REQUIRE(ev[1].name == name);
+    REQUIRE(!ev[1].begin);
+    REQUIRE(ev[1].cycles >= ev[0].cycles);
+    ev.clear();
+}
+} // namespace
+
+TEST_CASE("Instrumentation Probes", "[instrumentation]")
+{
+    RecordingSink::events.clear();
+
+    SECTION("FixedMatrix")
+    {
+        using mat_t = sst::basic_blocks::mod_matrix::FixedMatrix<ProbeMatrixConfig>;
+        mat_t m;
+        mat_t::RoutingTable rt;
+        float src{0.5f}, tgt{0.25f};
+        m.bindSourceValue(0, src);
+        m.bindTargetBaseValue(0, tgt);
+        rt.updateRoutingAt(0, 0, 0, 0.5f);
+        m.prepare(rt);
+        RecordingSink::events.clear();
+
+        m.process();
+        requireOneScope("FixedMatrix::process");
+        REQUIRE(m.getTargetValue(0) == Approx(0.5f));
+    }
+
+    SECTION("LanczosResampler")
+    {
+        sst::basic_blocks::dsp::LanczosResampler<resamplerBlockSize> rs(48000, 44100);
+        for (int i = 0; i < 200; ++i)
+            rs.push(0.1f, -0.1f);
+        float L[resamplerBlockSize], R[resamplerBlockSize];
+        rs.populateNext(L, R, resamplerBlockSize);
+        requireOneScope("LanczosResampler::populateNext");
+    }
+
+    SECTION("Envelope and LFO")
+    {
+        ProbeSRProvider sr;
+        sst::basic_blocks::modulators::ADSREnvelope<ProbeSRProvider, probeBlockSize> env(&sr);
+        env.attackFrom(0.f, 0.2f, 1, false);
+        RecordingSink::events.clear();
+        env.processBlock(0.2f, 0.3f, 0.6f, 0.4f, 1, 1, 1, true);
+        requireOneScope("ADSREnvelope::processBlock");
+
+        sst::basic_blocks::modulators::SimpleLFO<ProbeSRProvider, probeBlockSize> lfo(&sr, 1234);
+        lfo.attack(0);
+        RecordingSink::events.clear();
+        lfo.process_block(1.f, 0.f, 0);
+        requireOneScope("SimpleLFO::process_block");
+    }
+}
@@ -24,7 +24,13 @@
  * https://github.com/surge-synthesizer/sst-basic-blocks
  */
 
+#include "smoke_test_sse.h"
 #include "sst/basic-blocks/mod-matrix/ModMatrix.h"
+#include "sst/basic-blocks/mod-matrix/FixedBlockMatrix.h"
+#include "sst/basic-blocks/mod-matrix/FixedLaneMatrix.h"
+#include "sst/basic-blocks/mod-matrix/MatrixHandoff.h"
+#include "sst/basic-blocks/mod-matrix/RoutingTableSerialization.h"
+#include "sst/basic-blocks/mod-matrix/VoiceGroupScheduler.h"
 #include <cassert>
 #include "catch2.hpp"
 
@@ -413,3 +419,862 @@ TEST_CASE("WithCurves", "[mod-matrix]")
     REQUIRE(t3P);
     REQUIRE(*t3P == Approx(t3V + 0.5 * std::sin(barSVal)).margin(1e-5));
 }
+
+TEST_CASE("Prepared Program Is Compact", "[mod-matrix]")
+{
+    FixedMatrix<Config> m;
+    FixedMatrix<Config>::RoutingTable rt;
+
+    auto barS = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 2, 3};
+    auto fooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::FOO};
+    auto hooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::HOOTIE};
+
+    auto tg3T = Config::TargetIdentifier{3};
+    auto tg3PT = Config::TargetIdentifier{3, 'facd'};
+
+    float barSVal{1.1}, fooSVal{2.3};
+    m.bindSourceValue(barS, barSVal);
+    m.bindSourceValue(fooS, fooSVal);
+
+    float t3V{0.2}, t3PV{0.3};
+    m.bindTargetBaseValue(tg3T, t3V);
+    m.bindTargetBaseValue(tg3PT, t3PV);
+
+    rt.updateRoutingAt(0, barS, tg3T, 0.5);
+    rt.updateRoutingAt(1, fooS, tg3T, -0.25);
+    rt.updateRoutingAt(2, hooS, tg3PT, 0.7); // unbound source so dropped
+
+    m.prepare(rt);
+
+    REQUIRE(m.numProgramRoutes == 2);
+    REQUIRE(m.numProgramBaseValues == 2);
+
+    m.process();
+    REQUIRE(m.getTargetValue(tg3T) == Approx(t3V + 0.5 * barSVal - 0.25 * fooSVal).margin(1e-5));
+    REQUIRE(m.getTargetValue(tg3PT) == Approx(t3PV).margin(1e-5));
+
+    INFO("Depth changes are picked up without a re-prepare");
+    rt.updateDepthAt(1, 0.25);
+    t3V = 0.4;
+    m.process();
+    REQUIRE(m.getTargetValue(tg3T) == Approx(t3V + 0.5 * barSVal + 0.25 * fooSVal).margin(1e-5));
+}
+
+TEST_CASE("Block Matrix", "[mod-matrix]")
+{
+    static constexpr int bs{16};
+    FixedBlockMatrix<Config, bs> m;
+    FixedBlockMatrix<Config, bs>::RoutingTable rt;
+
+    auto barS = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 2, 3};
+    auto fooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::FOO};
+    auto hooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::HOOTIE};
+
+    auto tg3T = Config::TargetIdentifier{3};
+    auto tg3PT = Config::TargetIdentifier{3, 'facd'};
+    auto tg4T = Config::TargetIdentifier{4};
+
+    float barBlock[bs], fooBlock[bs];
+    for (int i = 0; i < bs; ++i)
+    {
+        barBlock[i] = std::sin(i * 0.3f);
+        fooBlock[i] = 0.1f * i;
+    }
+    float hooVal{0.5f};
+    m.bindSourceBlock(barS, barBlock);
+    m.bindSourceBlock(fooS, fooBlock);
+    m.bindSourceValue(hooS, hooVal);
+
+    float t3V{0.2}, t3PV{0.3}, t4V{0.7};
+    m.bindTargetBaseValue(tg3T, t3V);
+    m.bindTargetBaseValue(tg3PT, t3PV);
+    m.bindTargetBaseValue(tg4T, t4V);
+
+    rt.updateRoutingAt(0, barS, tg3T, 0.5);
+    rt.updateRoutingAt(1, fooS, hooS, {}, tg3T, -0.5);
+    rt.updateRoutingAt(2, hooS, tg3PT, 0.25);
+
+    m.prepare(rt);
+    m.processBlock();
+
+    REQUIRE(m.getTargetBlockPointer(tg4T) == nullptr);
+    REQUIRE(m.getTargetValue(tg4T) == t4V);
+
+    auto b3 = m.getTargetBlockPointer(tg3T);
+    auto b3P = m.getTargetBlockPointer(tg3PT);
+    REQUIRE(b3);
+    REQUIRE(b3P);
+    for (int i = 0; i < bs; ++i)
+    {
+        INFO("Sample " << i);
+        REQUIRE(b3[i] ==
+                Approx(t3V + 0.5 * barBlock[i] - 0.5 * fooBlock[i] * hooVal).margin(1e-5));
+        REQUIRE(b3P[i] == Approx(t3PV + 0.25 * hooVal).margin(1e-5));
+    }
+    REQUIRE(m.getTargetValue(tg3T) == b3[bs - 1]);
+
+    INFO("A base value change ramps across the next block");
+    t3V = 0.6;
+    m.processBlock();
+    for (int i = 0; i < bs; ++i)
+    {
+        auto base = 0.2 + (0.6 - 0.2) * (i + 1) / bs;
+        REQUIRE(b3[i] ==
+                Approx(base + 0.5 * barBlock[i] - 0.5 * fooBlock[i] * hooVal).margin(1e-5));
+    }
+}
+
+TEST_CASE("Lane Matrix", "[mod-matrix]")
+{
+    FixedLaneMatrix<Config> m;
+    FixedLaneMatrix<Config>::RoutingTable rt;
+
+    auto barS = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 2, 3};
+    auto fooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::FOO};
+    auto depS = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 17, 3};
+
+    auto tg3T = Config::TargetIdentifier{3};
+    auto tg3PT = Config::TargetIdentifier{3, 'facd'};
+    auto tgDepth = Config::TargetIdentifier{1, 'fowq', 2};
+
+    float barV alignas(16)[4]{0.1f, -0.4f, 0.9f, 0.3f};
+    float depV alignas(16)[4]{0.f, 0.5f, -0.5f, 1.f};
+    float fooV{0.8f};
+    m.bindSourceLanes(barS, barV);
+    m.bindSourceLanes(depS, depV);
+    m.bindSourceValue(fooS, fooV);
+
+    float t3V alignas(16)[4]{0.2f, 0.3f, 0.4f, 0.5f};
+    float t3PV{0.7f};
+    m.bindTargetBaseLanes(tg3T, t3V);
+    m.bindTargetBaseValue(tg3PT, t3PV);
+
+    rt.updateRoutingAt(0, depS, tgDepth, 0.2);
+    rt.updateRoutingAt(1, fooS, tg3T, -0.5);
+    rt.updateRoutingAt(2, barS, tg3T, 0.5);
+    rt.updateRoutingAt(3, barS, fooS, {}, tg3PT, 0.25);
+
+    m.prepare(rt);
+    m.process();
+
+    auto t3L = m.getTargetLanesPointer(tg3T);
+    REQUIRE(t3L);
+    for (int l = 0; l < 4; ++l)
+    {
+        INFO("Lane " << l);
+        auto dep = 0.5 + 0.2 * depV[l];
+        REQUIRE(t3L[l] == Approx(t3V[l] - 0.5 * fooV + dep * barV[l]).margin(1e-5));
+        REQUIRE(m.getTargetValue(tg3PT, l) == Approx(t3PV + 0.25 * barV[l] * fooV).margin(1e-5));
+    }
+
+    INFO("Each lane matches a scalar matrix for the same voice");
+    for (int l = 0; l < 4; ++l)
+    {
+        FixedMatrix<Config> s;
+        FixedMatrix<Config>::RoutingTable srt = rt;
+        float bv{barV[l]}, dv{depV[l]}, fv{fooV}, tv{t3V[l]}, tpv{t3PV};
+        s.bindSourceValue(barS, bv);
+        s.bindSourceValue(depS, dv);
+        s.bindSourceValue(fooS, fv);
+        s.bindTargetBaseValue(tg3T, tv);
+        s.bindTargetBaseValue(tg3PT, tpv);
+        s.prepare(srt);
+        s.process();
+        REQUIRE(s.getTargetValue(tg3T) == Approx(m.getTargetValue(tg3T, l)).margin(1e-6));
+        REQUIRE(s.getTargetValue(tg3PT) == Approx(m.getTargetValue(tg3PT, l)).margin(1e-6));
+    }
+}
+
+TEST_CASE("Voice Group Scheduler", "[mod-matrix]")
+{
+    namespace smod = sst::basic_blocks::modulators;
+    static constexpr int bs{16}, nv{12};
+    struct SRProvider
+    {
+        double samplerate{48000}, sampleRateInv{1.0 / 48000};
+        float envelope_rate_linear_nowrap(float f) const
+        {
+            return bs * sampleRateInv * std::pow(2.f, -f);
+        }
+    } srp;
+    using sched_t = VoiceGroupScheduler<Config, SRProvider, bs, nv, 2, 2>;
+    using env_t = smod::ADSREnvelopeBank<SRProvider, bs, nv>;
+
+    auto envS = Config::SourceIdentifier{Config::SourceIdentifier::SI::FOO};
+    auto lfo0S = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 0};
+    auto lfo1S = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 1};
+    auto cutT = Config::TargetIdentifier{1};
+    auto panT = Config::TargetIdentifier{2};
+
+    float cutBase alignas(16)[sched_t::numGroups][4], panBase alignas(16)[sched_t::numGroups][4];
+    auto setup = [&](sched_t &s, FixedLaneMatrix<Config>::RoutingTable &rt) {
+        s.bindEnvelopeSource(envS);
+        s.bindLFOSource(0, lfo0S);
+        s.bindLFOSource(1, lfo1S);
+        for (int g = 0; g < sched_t::numGroups; ++g)
+        {
+            auto &gr = s.group(g);
+            gr.matrix.bindTargetBaseLanes(cutT, cutBase[g]);
+            gr.matrix.bindTargetBaseLanes(panT, panBase[g]);
+            for (int l = 0; l < 4; ++l)
+            {
+                int v = g * 4 + l;
+                gr.envA[l] = 0.1f * (v % 3);
+                gr.envD[l] = 0.2f;
+                gr.envS[l] = 0.1f * v / nv + 0.5f;
+                gr.envR[l] = 0.15f;
+                gr.envAShape[l] = gr.envDShape[l] = gr.envRShape[l] = v % 3;
+                gr.lfoRate[l] = 2.f + 0.1f * v;
+                gr.lfoRate[4 + l] = -1.f + 0.2f * v;
+                gr.lfoShape[4 + l] = 1;
+            }
+        }
+        s.prepare(rt);
+    };
+    for (int g = 0; g < sched_t::numGroups; ++g)
+        for (int l = 0; l < 4; ++l)
+        {
+            cutBase[g][l] = 0.1f * l;
+            panBase[g][l] = -0.2f * g;
+        }
+
+    FixedLaneMatrix<Config>::RoutingTable rt;
+    rt.updateRoutingAt(0, envS, cutT, 0.5);
+    rt.updateRoutingAt(1, lfo0S, cutT, 0.25);
+    rt.updateRoutingAt(2, lfo1S, panT, -1.0);
+
+    sched_t sched(&srp, 1234), split(&srp, 1234);
+    setup(sched, rt);
+    setup(split, rt);
+
+    // a reference bank for all voices, driven with the same parameters
+    env_t ref(&srp);
+    float a[nv], d[nv], s[nv], r[nv];
+    int ash[nv], dsh[nv], rsh[nv];
+    bool gate[nv]{};
+    for (int v = 0; v < nv; ++v)
+    {
+        auto &gr = sched.groupForVoice(v);
+        auto l = sched_t::laneForVoice(v);
+        a[v] = gr.envA[l];
+        d[v] = gr.envD[l];
+        s[v] = gr.envS[l];
+        r[v] = gr.envR[l];
+        ash[v] = gr.envAShape[l];
+        dsh[v] = gr.envDShape[l];
+        rsh[v] = gr.envRShape[l];
+    }
+
+    // the last group stays idle
+    for (int v = 0; v < 8; ++v)
+    {
+        sched.attack(v);
+        split.attack(v);
+        ref.attackFrom(v, 0.f, ash[v]);
+        gate[v] = true;
+    }
+
+    for (int blk = 0; blk < 1500; ++blk)
+    {
+        if (blk == 150)
+        {
+            for (int v = 0; v < 8; ++v)
+            {
+                sched.release(v);
+                split.release(v);
+                gate[v] = false;
+            }
+        }
+
+        sched.process();
+        for (int w = 0; w < 3; ++w)
+        {
+            auto wr = sched_t::workRange(w, 3);
+            split.processGroups(wr.begin, wr.end);
+        }
+        ref.processBlock(a, d, s, r, ash, dsh, rsh, gate);
+
+        for (int v = 0; v < nv; ++v)
+        {
+            INFO("Block " << blk << " voice " << v);
+            auto g = v / 4;
+            auto l = sched_t::laneForVoice(v);
+            auto &gr = sched.group(g);
+            REQUIRE(gr.env.output[l] == ref.output[v]);
+            if (v >= 8)
+                continue;
+
+            REQUIRE(gr.lfoValue[0][l] == gr.lfo.outputBlock[l][bs - 1]);
+            REQUIRE(gr.lfoValue[1][l] == gr.lfo.outputBlock[4 + l][bs - 1]);
+            REQUIRE(gr.matrix.getTargetValue(cutT, l) ==
+                    Approx(cutBase[g][l] + 0.5 * gr.env.output[l] + 0.25 * gr.lfoValue[0][l])
+                        .margin(1e-5));
+            REQUIRE(gr.matrix.getTargetValue(panT, l) ==
+                    Approx(panBase[g][l] - gr.lfoValue[1][l]).margin(1e-5));
+            REQUIRE(split.group(g).matrix.getTargetValue(cutT, l) ==
+                    gr.matrix.getTargetValue(cutT, l));
+            REQUIRE(split.group(g).matrix.getTargetValue(panT, l) ==
+                    gr.matrix.getTargetValue(panT, l));
+        }
+        REQUIRE(!sched.group(2).isActive());
+    }
+    for (int v = 0; v < nv; ++v)
+        REQUIRE(sched.isQuiescent(v));
+
+    INFO("Work ranges cover every group once");
+    for (int workers = 1; workers < 6; ++workers)
+    {
+        int next = 0;
+        for (int w = 0; w < workers; ++w)
+        {
+            auto wr = sched_t::workRange(w, workers);
+            REQUIRE(wr.begin == next);
+            REQUIRE(wr.end >= wr.begin);
+            next = wr.end;
+        }
+        REQUIRE(next == sched_t::numGroups);
+    }
+}
+
+TEST_CASE("Incremental Route Update", "[mod-matrix]")
+{
+    FixedMatrix<Config> m;
+    FixedMatrix<Config>::RoutingTable rt;
+
+    auto barS = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 2, 3};
+    auto fooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::FOO};
+    auto hooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::HOOTIE};
+
+    auto tg3T = Config::TargetIdentifier{3};
+    auto tg3PT = Config::TargetIdentifier{3, 'facd'};
+    auto tg4T = Config::TargetIdentifier{4};
+
+    float barSVal{1.1}, fooSVal{2.3}, hooSVal{-0.7};
+    m.bindSourceValue(barS, barSVal);
+    m.bindSourceValue(fooS, fooSVal);
+    m.bindSourceValue(hooS, hooSVal);
+
+    float t3V{0.2}, t3PV{0.3}, t4V{0.4};
+    m.bindTargetBaseValue(tg3T, t3V);
+    m.bindTargetBaseValue(tg3PT, t3PV);
+    m.bindTargetBaseValue(tg4T, t4V);
+
+    rt.updateRoutingAt(0, barS, tg3T, 0.5);
+    rt.updateRoutingAt(1, fooS, tg3PT, -0.5);
+    rt.updateRoutingAt(2, fooS, tg3T, 0.1);
+    m.prepare(rt);
+    m.process();
+    REQUIRE(m.isSourceUsed[fooS]);
+    REQUIRE(!m.isSourceUsed[hooS]);
+
+    SECTION("Source change patches in place")
+    {
+        rt.updateRoutingAt(1, hooS, tg3PT, -0.5);
+        REQUIRE(m.updateRoute(rt, 1));
+        m.process();
+        REQUIRE(m.getTargetValue(tg3PT) == Approx(t3PV - 0.5 * hooSVal).margin(1e-5));
+        REQUIRE(m.getTargetValue(tg3T) ==
+                Approx(t3V + 0.5 * barSVal + 0.1 * fooSVal).margin(1e-5));
+        REQUIRE(m.isSourceUsed[fooS]);
+        REQUIRE(m.isSourceUsed[hooS]);
+    }
+
+    SECTION("Moving to an already routed target patches in place")
+    {
+        rt.updateRoutingAt(2, hooS, tg3PT, 0.1);
+        REQUIRE(m.updateRoute(rt, 2));
+        m.process();
+        REQUIRE(m.getTargetValue(tg3T) == Approx(t3V + 0.5 * barSVal).margin(1e-5));
+        REQUIRE(m.getTargetValue(tg3PT) ==
+                Approx(t3PV - 0.5 * fooSVal + 0.1 * hooSVal).margin(1e-5));
+    }
+
+    SECTION("A newly routed target rebuilds")
+    {
+        rt.updateRoutingAt(3, hooS, tg4T, 0.3);
+        REQUIRE(!m.updateRoute(rt, 3));
+        m.process();
+        REQUIRE(m.getTargetValue(tg4T) == Approx(t4V + 0.3 * hooSVal).margin(1e-5));
+    }
+
+    SECTION("Unrouting the last route into a target rebuilds")
+    {
+        rt.updateRoutingAt(1, hooS, tg4T, 0.3);
+        REQUIRE(!m.updateRoute(rt, 1));
+        m.process();
+        REQUIRE(m.getTargetValue(tg3PT) == t3PV);
+        REQUIRE(m.getTargetValue(tg4T) == Approx(t4V + 0.3 * hooSVal).margin(1e-5));
+    }
+
+    SECTION("A source the matrix has never seen rebuilds")
+    {
+        // unbound and never routed, so it has no isSourceUsed entry to flip in place
+        auto newS = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 9, 9};
+        REQUIRE(m.isSourceUsed.find(newS) == m.isSourceUsed.end());
+        rt.updateRoutingAt(1, newS, tg3PT, -0.5);
+        REQUIRE(!m.updateRoute(rt, 1));
+        REQUIRE(m.isSourceUsed.find(newS) != m.isSourceUsed.end());
+        m.process();
+        REQUIRE(m.getTargetValue(tg3PT) == t3PV);
+    }
+}
+
+TEST_CASE("Matrix Handoff", "[mod-matrix]")
+{
+    MatrixHandoff<FixedMatrix<Config>> h;
+
+    auto barS = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 2, 3};
+    auto fooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::FOO};
+    auto tg3T = Config::TargetIdentifier{3};
+
+    float barSVal{1.1}, fooSVal{2.3}, t3V{0.2};
+    h.forEachMatrix([&](auto &m) {
+        m.bindSourceValue(barS, barSVal);
+        m.bindSourceValue(fooS, fooSVal);
+        m.bindTargetBaseValue(tg3T, t3V);
+    });
+
+    INFO("Before anything is published the audio side has an empty matrix");
+    REQUIRE(!h.acquire());
+    h.matrix().process();
+
+    FixedMatrix<Config>::RoutingTable rt;
+    rt.updateRoutingAt(0, barS, tg3T, 0.5);
+    h.publish(rt);
+
+    INFO("Edits after publishing don't reach the audio side");
+    rt.updateRoutingAt(0, fooS, tg3T, 0.5);
+
+    REQUIRE(h.acquire());
+    REQUIRE(!h.acquire());
+    h.matrix().process();
+    REQUIRE(h.matrix().getTargetValue(tg3T) == Approx(t3V + 0.5 * barSVal).margin(1e-5));
+
+    INFO("Publishing twice before an acquire keeps only the latest");
+    h.publish(rt);
+    rt.updateDepthAt(0, -0.25);
+    h.publish(rt);
+    REQUIRE(h.acquire());
+    h.matrix().process();
+    REQUIRE(h.matrix().getTargetValue(tg3T) == Approx(t3V - 0.25 * fooSVal).margin(1e-5));
+    REQUIRE(h.table().routes[0].depth == -0.25f);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        rt.updateDepthAt(0, 0.1 * i);
+        h.publish(rt);
+        REQUIRE(h.acquire());
+        h.matrix().process();
+        REQUIRE(h.matrix().getTargetValue(tg3T) == Approx(t3V + 0.1 * i * fooSVal).margin(1e-5));
+    }
+}
+
+struct CurveFunctionConfig
+{
+    using SourceIdentifier = int;
+    using TargetIdentifier = int;
+    using CurveIdentifier = int;
+
+    using RoutingExtraPayload = int;
+
+    static constexpr bool IsFixedMatrix{true};
+    static constexpr size_t FixedMatrixSize{16};
+
+    using curveFunction_t = float (*)(float);
+
+    static float cube(float x) { return x * x * x; }
+    static float sinCurve(float x) { return std::sin(x); }
+    static float expCurve(float x) { return std::exp(x); }
+
+    static curveFunction_t getCurveFunction(CurveIdentifier id)
+    {
+        switch (id)
+        {
+        case 1:
+            return cube;
+        case 2:
+            return sinCurve;
+        case 3:
+            return expCurve;
+        }
+        return nullptr;
+    }
+
+    // The polynomial and sin curves are bounded so can be tabulated; exp is left alone
+    static std::optional<std::pair<float, float>> getCurveDomain(CurveIdentifier id)
+    {
+        if (id == 1 || id == 2)
+            return std::make_pair(-2.f, 2.f);
+        return std::nullopt;
+    }
+};
+
+TEST_CASE("With Curve Functions and Tables", "[mod-matrix]")
+{
+    static_assert(ModMatrix<CurveFunctionConfig>::supportsCurveFunctions);
+    static_assert(ModMatrix<CurveFunctionConfig>::supportsCurveLUTs);
+    static_assert(!ModMatrix<CurveConfig>::supportsCurveLUTs);
+
+    auto barS = CurveFunctionConfig::SourceIdentifier{7};
+    auto tg3T = CurveFunctionConfig::TargetIdentifier{3};
+    auto tg4T = CurveFunctionConfig::TargetIdentifier{4};
+    auto tg5T = CurveFunctionConfig::TargetIdentifier{5};
+
+    FixedMatrix<CurveFunctionConfig>::RoutingTable rt;
+    rt.updateRoutingAt(0, barS, tg3T, 0.5);
+    rt.routes[0].curve = 1;
+    rt.updateRoutingAt(1, barS, tg4T, 0.5);
+    rt.routes[1].curve = 2;
+    rt.updateRoutingAt(2, barS, tg5T, 0.5);
+    rt.routes[2].curve = 3;
+
+    SECTION("Scalar")
+    {
+        FixedMatrix<CurveFunctionConfig> m;
+        float barSVal{1.1}, t3V{0.2}, t4V{0.3}, t5V{0.4};
+        m.bindSourceValue(barS, barSVal);
+        m.bindTargetBaseValue(tg3T, t3V);
+        m.bindTargetBaseValue(tg4T, t4V);
+        m.bindTargetBaseValue(tg5T, t5V);
+        m.prepare(rt);
+
+        using PR = FixedMatrix<CurveFunctionConfig>::ProgramRoute;
+        REQUIRE(m.programRoutes[0].curveMode == PR::CURVE_LUT);
+        REQUIRE(m.programRoutes[2].curveMode == PR::CURVE_FUNCTION);
+
+        for (auto v : {-3.f, -1.9f, -0.3f, 0.f, 0.77f, 1.1f, 2.f, 2.5f})
+        {
+            INFO("Source Value " << v);
+            barSVal = v;
+            m.process();
+            auto cv = std::clamp(v, -2.f, 2.f);
+            REQUIRE(m.getTargetValue(tg3T) == Approx(t3V + 0.5 * cv * cv * cv).margin(2e-4));
+            REQUIRE(m.getTargetValue(tg4T) == Approx(t4V + 0.5 * std::sin(cv)).margin(2e-4));
+            REQUIRE(m.getTargetValue(tg5T) == Approx(t5V + 0.5 * std::exp(v)).margin(1e-4));
+        }
+    }
+
+    SECTION("Lanes")
+    {
+        FixedLaneMatrix<CurveFunctionConfig> m;
+        float barV alignas(16)[4]{-2.5f, -0.3f, 0.77f, 1.99f};
+        float t3V{0.2}, t4V{0.3}, t5V{0.4};
+        m.bindSourceLanes(barS, barV);
+        m.bindTargetBaseValue(tg3T, t3V);
+        m.bindTargetBaseValue(tg4T, t4V);
+        m.bindTargetBaseValue(tg5T, t5V);
+        m.prepare(rt);
+        m.process();
+        for (int l = 0; l < 4; ++l)
+        {
+            INFO("Lane " << l);
+            auto cv = std::clamp(barV[l], -2.f, 2.f);
+            REQUIRE(m.getTargetValue(tg3T, l) == Approx(t3V + 0.5 * cv * cv * cv).margin(2e-4));
+            REQUIRE(m.getTargetValue(tg4T, l) == Approx(t4V + 0.5 * std::sin(cv)).margin(2e-4));
+            REQUIRE(m.getTargetValue(tg5T, l) ==
+                    Approx(t5V + 0.5 * std::exp(barV[l])).margin(1e-4));
+        }
+    }
+}
+
+TEST_CASE("Used Sources and Compacted Program", "[mod-matrix]")
+{
+    FixedMatrix<Config> m;
+    FixedMatrix<Config>::RoutingTable rt;
+
+    auto barS = Config::SourceIdentifier{Config::SourceIdentifier::SI::BAR, 2, 3};
+    auto fooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::FOO};
+    auto hooS = Config::SourceIdentifier{Config::SourceIdentifier::SI::HOOTIE};
+    auto unbS = Config::SourceIdentifier{Config::SourceIdentifier::SI::HOOTIE, 4};
+
+    auto tg3T = Config::TargetIdentifier{3};
+    auto tg3PT = Config::TargetIdentifier{3, 'facd'};
+
+    float barSVal{1.1}, fooSVal{2.3}, hooSVal{-0.7};
+    m.bindSourceValue(barS, barSVal);
+    m.bindSourceValue(fooS, fooSVal);
+    m.bindSourceValue(hooS, hooSVal);
+
+    float t3V{0.2}, t3PV{0.3};
+    m.bindTargetBaseValue(tg3T, t3V);
+    m.bindTargetBaseValue(tg3PT, t3PV);
+
+    rt.updateRoutingAt(0, barS, tg3T, 0.5);
+    rt.updateRoutingAt(1, fooS, tg3PT, 0.0);
+    rt.updateRoutingAt(2, barS, hooS, {}, tg3PT, 0.2);
+    rt.updateRoutingAt(3, unbS, tg3PT, 0.2);
+    m.prepare(rt);
+
+    auto isUsed = [&m](auto s) {
+        for (size_t i = 0; i < m.numUsedSources; ++i)
+            if (m.usedSources[i] == s)
+                return true;
+        return false;
+    };
+
+    REQUIRE(m.numProgramRoutes == 3);
+    REQUIRE(m.numUsedSources == 3);
+    REQUIRE(isUsed(barS));
+    REQUIRE(isUsed(fooS));
+    REQUIRE(isUsed(hooS));
+    REQUIRE(!isUsed(unbS));
+
+    rt.updateActiveAt(2, false);
+    m.compactProgram();
+    REQUIRE(m.numProgramRoutes == 1);
+    REQUIRE(m.numUsedSources == 1);
+    REQUIRE(isUsed(barS));
+
+    m.process();
+    REQUIRE(m.getTargetValue(tg3T) == Approx(t3V + 0.5 * barSVal).margin(1e-5));
+    REQUIRE(m.getTargetValue(tg3PT) == Approx(t3PV).margin(1e-5));
+
+    rt.updateActiveAt(2, true);
+    rt.updateDepthAt(1, 0.1);
+    m.compactProgram();
+    REQUIRE(m.numProgramRoutes == 3);
+    m.process();
+    REQUIRE(m.getTargetValue(tg3PT) ==
+            Approx(t3PV + 0.1 * fooSVal + 0.2 * barSVal * hooSVal).margin(1e-5));
+}
+
+struct DenseConfig
+{
+    using SourceIdentifier = int;
+    using TargetIdentifier = int;
+    using CurveIdentifier = int;
+
+    using RoutingExtraPayload = int;
+
+    static constexpr bool IsFixedMatrix{true};
+    static constexpr size_t FixedMatrixSize{8};
+
+    static constexpr size_t DenseSourceCount{6};
+    static size_t sourceToIndex(const SourceIdentifier &s) { return (size_t)s; }
+    static constexpr size_t DenseTargetCount{10};
+    static size_t targetToIndex(const TargetIdentifier &t) { return (size_t)t; }
+};
+
+TEST_CASE("Dense Index Binding", "[mod-matrix]")
+{
+    static_assert(ModMatrix<DenseConfig>::hasDenseSources);
+    static_assert(ModMatrix<DenseConfig>::hasDenseTargets);
+    static_assert(!ModMatrix<CurveConfig>::hasDenseSources);
+
+    FixedMatrix<DenseConfig> m;
+    FixedMatrix<DenseConfig>::RoutingTable rt;
+
+    float s[6]{0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f};
+    for (int i = 0; i < 6; ++i)
+        m.bindSourceValue(i, s[i]);
+    float t[10]{};
+    for (int i = 0; i < 10; ++i)
+    {
+        t[i] = i * 0.1f;
+        m.bindTargetBaseValue(i, t[i]);
+    }
+
+    INFO("Before prepare the base values show through");
+    REQUIRE(m.getTargetValuePointer(3) == &t[3]);
+
+    rt.updateRoutingAt(0, 2, 7, 0.5);
+    rt.updateRoutingAt(1, 4, 7, -0.5);
+    rt.updateRoutingAt(2, 5, 1, 0.25);
+    m.prepare(rt);
+    m.process();
+
+    REQUIRE(m.getTargetValuePointer(3) == &t[3]);
+    REQUIRE(m.getTargetValue(7) == Approx(t[7] + 0.5 * s[2] - 0.5 * s[4]).margin(1e-5));
+    REQUIRE(m.getTargetValue(1) == Approx(t[1] + 0.25 * s[5]).margin(1e-5));
+
+    REQUIRE(m.usedSourceMask.count() == 3);
+    REQUIRE(m.usedSourceMask.test(2));
+    REQUIRE(m.usedSourceMask.test(4));
+    REQUIRE(m.usedSourceMask.test(5));
+
+    rt.updateDepthAt(2, 0.f);
+    m.compactProgram();
+    REQUIRE(!m.usedSourceMask.test(5));
+    REQUIRE(m.usedSourceMask.count() == 2);
+}
+
+struct StreamConfig : Config
+{
+    static uint64_t sourceToStream(const SourceIdentifier &s)
+    {
+        return (uint64_t)s.src | ((uint64_t)(uint16_t)s.index0 << 8) |
+               ((uint64_t)(uint16_t)s.index1 << 24);
+    }
+    static SourceIdentifier sourceFromStream(uint64_t v)
+    {
+        return {(SourceIdentifier::SI)(v & 0xFF), (int16_t)((v >> 8) & 0xFFFF),
+                (int16_t)((v >> 24) & 0xFFFF)};
+    }
+    static uint64_t targetToStream(const TargetIdentifier &t)
+    {
+        return (uint64_t)(uint16_t)t.baz | ((uint64_t)t.nm << 16) |
+               ((uint64_t)(uint16_t)t.depthPosition << 48);
+    }
+    static TargetIdentifier targetFromStream(uint64_t v)
+    {
+        return {(int16_t)(v & 0xFFFF), (uint32_t)(v >> 16), (int16_t)(v >> 48)};
+    }
+};
+
+TEST_CASE("Routing Table Serialization", "[mod-matrix]")
+{
+    using stream_t = RoutingTableStream<StreamConfig>;
+    using rt_t = FixedLengthRoutingTable<StreamConfig>;
+    using SI = Config::SourceIdentifier;
+
+    auto barS = SI{SI::BAR, 2, 3};
+    auto fooS = SI{SI::FOO};
+    auto hooS = SI{SI::HOOTIE, -4, 7};
+    auto tg3T = Config::TargetIdentifier{3};
+    auto tg3PT = Config::TargetIdentifier{3, 'facd'};
+    auto tgDepth = Config::TargetIdentifier{1, 'fowq', 2};
+
+    rt_t rt;
+    rt.updateRoutingAt(0, barS, tg3T, 0.5);
+    rt.updateRoutingAt(2, fooS, hooS, 3, tg3PT, -0.25);
+    rt.updateRoutingAt(5, hooS, tgDepth, 0.125);
+    rt.updateActiveAt(5, false);
+    rt.routes[7].extraPayload = -17;
+    rt.updateDepthAt(9, 0.75);
+
+    auto bytes = stream_t::encode(rt);
+    REQUIRE(bytes.size() == stream_t::bytesRequired);
+    REQUIRE(bytes.size() == 16 + 48 * Config::FixedMatrixSize);
+    REQUIRE(std::string(bytes.begin(), bytes.begin() + 4) == "sbrt");
+    REQUIRE(stream_t::encode(rt, bytes.data(), bytes.size() - 1) == 0);
+
+    SECTION("Round trip")
+    {
+        rt_t back;
+        back.updateRoutingAt(1, fooS, tg3T, 1.0);
+        REQUIRE(stream_t::decode(bytes.data(), bytes.size(), back) == RoutingStreamStatus::OK);
+        for (size_t i = 0; i < Config::FixedMatrixSize; ++i)
+        {
+            INFO("Route " << i);
+            const auto &a = rt.routes[i], &b = back.routes[i];
+            REQUIRE(a.active == b.active);
+            REQUIRE(a.source == b.source);
+            REQUIRE(a.sourceVia == b.sourceVia);
+            REQUIRE(a.target == b.target);
+            REQUIRE(a.curve == b.curve);
+            REQUIRE(a.extraPayload == b.extraPayload);
+            REQUIRE(a.depth == b.depth);
+        }
+
+        stream_t::View v(bytes.data(), bytes.size());
+        REQUIRE(v);
+        REQUIRE(v.size() == Config::FixedMatrixSize);
+        REQUIRE(v.route(2).sourceVia == hooS);
+        REQUIRE(!v.route(5).active);
+    }
+
+    SECTION("Integral identifiers need no hooks")
+    {
+        using dstream_t = RoutingTableStream<DenseConfig>;
+        FixedLengthRoutingTable<DenseConfig> drt, dback;
+        drt.updateRoutingAt(0, 5, -3, 2, 9, 0.5);
+        drt.routes[0].extraPayload = -1;
+        auto db = dstream_t::encode(drt);
+        REQUIRE(dstream_t::decode(db.data(), db.size(), dback) == RoutingStreamStatus::OK);
+        REQUIRE(dback.routes[0].source == 5);
+        REQUIRE(dback.routes[0].sourceVia == -3);
+        REQUIRE(dback.routes[0].curve == 2);
+        REQUIRE(dback.routes[0].target == 9);
+        REQUIRE(dback.routes[0].extraPayload == -1);
+        REQUIRE(!dback.routes[1].source.has_value());
+    }
+
+    SECTION("Invalid streams leave the table alone")
+    {
+        rt_t back;
+        back.updateRoutingAt(1, fooS, tg3T, 1.0);
+        auto check = [&](std::vector<uint8_t> b, RoutingStreamStatus expected) {
+            REQUIRE(stream_t::decode(b.data(), b.size(), back) == expected);
+            REQUIRE(back.routes[1].source == fooS);
+            REQUIRE(!back.routes[0].source.has_value());
+        };
+
+        check({bytes.begin(), bytes.begin() + 8}, RoutingStreamStatus::TOO_SHORT);
+        check({bytes.begin(), bytes.end() - 1}, RoutingStreamStatus::TOO_SHORT);
+
+        auto b = bytes;
+        b[0] = 'x';
+        check(b, RoutingStreamStatus::BAD_MAGIC);
+
+        b = bytes;
+        b[4] = 2;
+        check(b, RoutingStreamStatus::UNSUPPORTED_VERSION);
+
+        b = bytes;
+        b[8] = Config::FixedMatrixSize + 1;
+        check(b, RoutingStreamStatus::TOO_MANY_ROUTES);
+    }
+
+    SECTION("Shorter tables and longer records")
+    {
+        // a stream of three routes, each padded to 56 bytes as a later version might write
+        std::vector<uint8_t> b(16 + 3 * 56, 0xEE);
+        std::copy(bytes.begin(), bytes.begin() + 16, b.begin());
+        b[6] = 56;
+        b[8] = 3;
+        for (int i = 0; i < 3; ++i)
+            std::copy(bytes.begin() + 16 + i * 48, bytes.begin() + 16 + (i + 1) * 48,
+                      b.begin() + 16 + i * 56);
+
+        rt_t back;
+        back.updateRoutingAt(5, fooS, tg3T, 1.0);
+        REQUIRE(stream_t::decode(b.data(), b.size(), back) == RoutingStreamStatus::OK);
+        REQUIRE(back.routes[0].source == barS);
+        REQUIRE(back.routes[2].sourceVia == hooS);
+        REQUIRE(back.routes[2].depth == -0.25f);
+        REQUIRE(!back.routes[5].source.has_value());
+    }
+
+    SECTION("Loading into a prepared matrix")
+    {
+        float barV{1.1f}, fooV{2.3f}, hooV{-0.7f}, t3V{0.2f}, t3PV{0.3f};
+        auto bind = [&](auto &m) {
+            m.bindSourceValue(barS, barV);
+            m.bindSourceValue(fooS, fooV);
+            m.bindSourceValue(hooS, hooV);
+            m.bindTargetBaseValue(tg3T, t3V);
+            m.bindTargetBaseValue(tg3PT, t3PV);
+        };
+
+        rt_t live;
+        live.updateRoutingAt(0, barS, tg3T, 0.5);
+        live.updateRoutingAt(1, fooS, tg3PT, -0.5);
+        FixedMatrix<StreamConfig> m;
+        bind(m);
+        m.prepare(live);
+
+        rt_t next = live;
+        next.updateDepthAt(0, 0.1);
+        next.updateRoutingAt(1, hooS, tg3PT, -0.5);
+        next.updateRoutingAt(2, fooS, tg3T, 0.25);
+        auto nb = stream_t::encode(next);
+
+        REQUIRE(stream_t::loadInto(m, live, nb.data(), nb.size()) == RoutingStreamStatus::OK);
+        m.process();
+
+        FixedMatrix<StreamConfig> ref;
+        bind(ref);
+        ref.prepare(next);
+        ref.process();
+        REQUIRE(m.getTargetValue(tg3T) == Approx(t3V + 0.1 * barV + 0.25 * fooV).margin(1e-5));
+        REQUIRE(m.getTargetValue(tg3T) == Approx(ref.getTargetValue(tg3T)).margin(1e-6));
+        REQUIRE(m.getTargetValue(tg3PT) == Approx(t3PV - 0.5 * hooV).margin(1e-5));
+
+        auto bad = nb;
+        bad[0] = 0;
+        REQUIRE(stream_t::loadInto(m, live, bad.data(), bad.size()) ==
+                RoutingStreamStatus::BAD_MAGIC);
+        m.process();
+        REQUIRE(m.getTargetValue(tg3PT) == Approx(t3PV - 0.5 * hooV).margin(1e-5));
+    }
+}
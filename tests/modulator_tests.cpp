@@ -27,6 +27,9 @@
 #include "catch2.hpp"
 #include "smoke_test_sse.h"
 #include "sst/basic-blocks/modulators/FXModControl.h"
+#include "sst/basic-blocks/modulators/SimpleLFOBank.h"
+
+#include <random>
 
 namespace smod = sst::basic_blocks::modulators;
 
@@ -53,4 +56,194 @@ TEST_CASE("Mod LFO Is Well Behaved", "[mod]")
             }
         }
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("SimpleLFO Bank Matches SimpleLFO", "[mod]")
+{
+    struct SRProvider
+    {
+        double samplerate{48000}, sampleRateInv{1.0 / 48000};
+        float envelope_rate_linear_nowrap(float f) const
+        {
+            return 16 * sampleRateInv * std::pow(2.f, -f);
+        }
+    } srp;
+
+    static constexpr int nLanes{8};
+    using lfo_t = smod::SimpleLFO<SRProvider, 16>;
+    using bank_t = smod::SimpleLFOBank<SRProvider, 16, nLanes>;
+
+    for (int tries = 0; tries < 20; ++tries)
+    {
+        uint32_t seed = 1729 + tries * 17;
+        std::minstd_rand gen(seed);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        float rate[nLanes], deform[nLanes];
+        int shape[nLanes];
+        for (int l = 0; l < nLanes; ++l)
+        {
+            // bias the rates high so the noise and trigger shapes wrap often
+            rate[l] = unit(gen) * 8 - 1;
+            deform[l] = unit(gen) * 2 - 1;
+            shape[l] = (l + tries) % (lfo_t::RANDOM_TRIGGER + 1);
+        }
+        INFO("Try " << tries << " reverse " << (tries & 1));
+
+        bank_t bank(&srp, seed);
+        std::vector<std::unique_ptr<lfo_t>> lfos;
+        for (int l = 0; l < nLanes; ++l)
+        {
+            lfos.push_back(std::make_unique<lfo_t>(&srp, seed + l));
+            lfos[l]->setAmplitude(0.25f + 0.1f * l);
+            bank.setAmplitude(l, 0.25f + 0.1f * l);
+        }
+
+        for (int blk = 0; blk < 300; ++blk)
+        {
+            bank.process_block(rate, deform, shape, tries & 1);
+            for (int l = 0; l < nLanes; ++l)
+            {
+                lfos[l]->process_block(rate[l], deform[l], shape[l], tries & 1);
+                INFO("Block " << blk << " lane " << l << " shape " << shape[l]);
+                REQUIRE(bank.phase[l] == Approx(lfos[l]->phase).margin(1e-5));
+                for (int i = 0; i < 16; ++i)
+                    REQUIRE(bank.outputBlock[l][i] ==
+                            Approx(lfos[l]->outputBlock[i]).margin(1e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("Modulators Go Quiescent", "[mod]")
+{
+    SECTION("SimpleLFO at zero amplitude")
+    {
+        struct SRProvider
+        {
+            double samplerate{48000};
+            float envelope_rate_linear_nowrap(float f) const
+            {
+                return 16 / samplerate * std::pow(2.f, -f);
+            }
+        } srp;
+        smod::SimpleLFO<SRProvider, 16> lfo(&srp, 8675309);
+        for (int i = 0; i < 10; ++i)
+            lfo.process_block(2, 0, smod::SimpleLFO<SRProvider, 16>::SINE);
+        REQUIRE(!lfo.isQuiescent());
+
+        lfo.setAmplitude(0.f);
+        lfo.process_block(2, 0, smod::SimpleLFO<SRProvider, 16>::SINE);
+        // the first silent block ramps down to zero
+        REQUIRE(!lfo.isQuiescent());
+        REQUIRE(lfo.outputBlock[0] != 0.f);
+
+        auto phase = lfo.phase;
+        lfo.process_block(2, 0, smod::SimpleLFO<SRProvider, 16>::SINE);
+        REQUIRE(lfo.isQuiescent());
+        REQUIRE(lfo.phase != phase);
+        for (int i = 0; i < 16; ++i)
+            REQUIRE(lfo.outputBlock[i] == 0.f);
+
+        lfo.setAmplitude(1.f);
+        lfo.process_block(2, 0, smod::SimpleLFO<SRProvider, 16>::SINE);
+        REQUIRE(!lfo.isQuiescent());
+        REQUIRE(lfo.outputBlock[15] != 0.f);
+    }
+
+    SECTION("FXModControl at zero depth")
+    {
+        smod::FXModControl<32> mc(48000, 1.0 / 48000);
+        for (int s = 0; s < 100; ++s)
+        {
+            mc.pre_process(smod::FXModControl<32>::mod_sine, 0.001, 0.f, 0.f);
+            REQUIRE(mc.isQuiescent());
+            REQUIRE(mc.value() == 0.f);
+            mc.post_process();
+        }
+
+        mc.pre_process(smod::FXModControl<32>::mod_sine, 0.001, 1.f, 0.f);
+        mc.post_process();
+        REQUIRE(!mc.isQuiescent());
+        mc.pre_process(smod::FXModControl<32>::mod_sine, 0.001, 1.f, 0.f);
+        REQUIRE(mc.value() != 0.f);
+    }
+}
+
+TEST_CASE("FXModControl Resumes After Zero Depth", "[mod]")
+{
+    using mc_t = smod::FXModControl<32>;
+    for (int m = mc_t::mod_sine; m <= mc_t::mod_square; ++m)
+    {
+        DYNAMIC_SECTION("Depth toggles for type " << m)
+        {
+            // a tiny depth never goes quiescent, so the reference never takes the fast path
+            auto run = [m](bool reference) {
+                srand(8675309 + m);
+                mc_t mc(48000, 1.0 / 48000);
+                std::vector<float> res;
+                float out[32];
+                for (int b = 0; b < 240; ++b)
+                {
+                    float rate = (b % 30) < 6 ? 0.f : 0.01 + 0.003 * (b % 11);
+                    float phofs = 0.07 * (b % 13);
+                    float depth = (b / 40) % 2 ? 0.4 + 0.01 * (b % 5) : 0.f;
+                    if (reference && depth == 0.f)
+                        depth = 1e-30f;
+
+                    if (reference)
+                    {
+                        mc.pre_process(m, rate, depth, phofs);
+                        for (int i = 0; i < 32; ++i)
+                        {
+                            out[i] = mc.value();
+                            mc.post_process();
+                        }
+                    }
+                    else
+                    {
+                        mc.processBlock(m, rate, depth, phofs, out);
+                    }
+                    res.insert(res.end(), out, out + 32);
+                }
+                return res;
+            };
+
+            auto fast = run(false);
+            auto ref = run(true);
+            for (auto i = 0U; i < fast.size(); ++i)
+            {
+                INFO("Block " << i / 32 << " sample " << i % 32);
+                REQUIRE(fast[i] == Approx(ref[i]).margin(1e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("FXModControl Block Matches Stepped", "[mod]")
+{
+    for (int m = smod::FXModControl<32>::mod_sine; m <= smod::FXModControl<32>::mod_square; ++m)
+    {
+        if (m == smod::FXModControl<32>::mod_noise || m == smod::FXModControl<32>::mod_snh)
+            continue; // these draw from rand() so two instances can't match
+
+        DYNAMIC_SECTION("Block curve for type " << m)
+        {
+            smod::FXModControl<32> stepped(48000, 1.0 / 48000), block(48000, 1.0 / 48000);
+            float out[32];
+            for (int b = 0; b < 200; ++b)
+            {
+                float rate = 0.01 + 0.002 * (b % 17);
+                float depth = (b / 50) % 2 ? 0.f : 0.3 + 0.01 * (b % 7);
+
+                block.processBlock(m, rate, depth, 0.25, out);
+                stepped.pre_process(m, rate, depth, 0.25);
+                for (int i = 0; i < 32; ++i)
+                {
+                    INFO("Block " << b << " sample " << i);
+                    REQUIRE(out[i] == Approx(stepped.value()).margin(1e-5));
+                    stepped.post_process();
+                }
+            }
+        }
+    }
+}
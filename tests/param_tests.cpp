@@ -28,9 +28,12 @@
 #include "smoke_test_sse.h"
 #include <cmath>
 #include <iostream>
+#include <cstring>
 #include <type_traits>
+#include <vector>
 
 #include "sst/basic-blocks/params/ParamMetadata.h"
+#include "sst/basic-blocks/params/ParamMetadataSIMD.h"
 
 namespace pmd = sst::basic_blocks::params;
 TEST_CASE("Percent and BiPolar Percent", "[param]")
@@ -355,3 +358,220 @@ TEST_CASE("25 Second Exp", "[param]")
         REQUIRE(md.has_value());
     }
 }
+
+TEST_CASE("Value To String Into Buffers", "[param]")
+{
+    using fs_t = pmd::ParamMetaData::FeatureState;
+    std::vector<pmd::ParamMetaData> ps{
+        pmd::ParamMetaData().asPercentBipolar(), pmd::ParamMetaData().asDecibel(),
+        pmd::ParamMetaData().asAudibleFrequency(), pmd::ParamMetaData().asMIDINote(),
+        pmd::ParamMetaData().asLfoRate(), pmd::ParamMetaData().as25SecondExpTime(),
+        pmd::ParamMetaData().asCubicDecibelAttenuation(), pmd::ParamMetaData().asBool()};
+
+    SECTION("Matches The String API")
+    {
+        char buf[64];
+        for (const auto &p : ps)
+        {
+            for (int i = 0; i <= 20; ++i)
+            {
+                auto v = p.minVal + (p.maxVal - p.minVal) * i / 20.f;
+                for (auto fs : {fs_t(), fs_t().withHighPrecision(true), fs_t().withTemposync(true)})
+                {
+                    auto s = p.valueToString(v, fs);
+                    auto n = p.valueToString(v, buf, sizeof(buf), fs);
+                    REQUIRE(s.has_value() == n.has_value());
+                    if (s.has_value())
+                    {
+                        REQUIRE(*n == s->size());
+                        REQUIRE(std::string(buf) == *s);
+                    }
+                }
+            }
+        }
+
+        auto p = pmd::ParamMetaData().asLfoRate();
+        for (float f = -8; f < 5; f += 0.25)
+        {
+            auto n = p.temposyncNotation(f, buf, sizeof(buf));
+            REQUIRE(std::string(buf) == p.temposyncNotation(f));
+            REQUIRE(n == strlen(buf));
+        }
+    }
+
+    SECTION("Truncates Like snprintf")
+    {
+        auto p = pmd::ParamMetaData().asDecibel();
+        auto full = *p.valueToString(-12.3456f);
+        char small[6];
+        auto n = p.valueToString(-12.3456f, small, sizeof(small));
+        REQUIRE(n.has_value());
+        REQUIRE(*n == full.size());
+        REQUIRE(std::string(small) == full.substr(0, sizeof(small) - 1));
+
+        REQUIRE(*p.valueToString(-12.3456f, nullptr, 0) == full.size());
+    }
+
+    SECTION("Alternate Strings Leave An Empty Buffer")
+    {
+        char buf[8]{'x', 'x'};
+        auto p = pmd::ParamMetaData().asAudibleFrequency();
+        REQUIRE(!p.valueToAlternateString(440.f, buf, sizeof(buf)).has_value());
+        REQUIRE(buf[0] == 0);
+        REQUIRE(!p.valueToAlternateString(440.f).has_value());
+    }
+}
+
+TEST_CASE("Value From String With Parse Errors", "[param]")
+{
+    using pe_t = pmd::ParamMetaData::ParseError;
+
+    SECTION("Values And Codes")
+    {
+        auto p = pmd::ParamMetaData().asPercent();
+        pe_t err;
+        REQUIRE(*p.valueFromString("  42.5 %", err) == Approx(0.425f));
+        REQUIRE(!err);
+        REQUIRE(*p.valueFromString("+10", err) == Approx(0.1f));
+
+        REQUIRE(!p.valueFromString("whoozits", err).has_value());
+        REQUIRE(err.code == pe_t::INVALID_NUMBER);
+        REQUIRE(!p.valueFromString("1e50", err).has_value());
+        REQUIRE(err.code == pe_t::INVALID_NUMBER);
+        REQUIRE(!p.valueFromString("140", err).has_value());
+        REQUIRE(err.code == pe_t::OUT_OF_RANGE);
+
+        auto f = pmd::ParamMetaData().asAudibleFrequency();
+        REQUIRE(*f.valueFromString("440 Hz", err) == Approx(0.f).margin(1e-5));
+        REQUIRE(!f.valueFromString("-3 Hz", err).has_value());
+        REQUIRE(err.code == pe_t::OUT_OF_RANGE);
+
+        auto n = pmd::ParamMetaData().asMIDINote();
+        REQUIRE(*n.valueFromString("C4", err) == 60);
+        REQUIRE(*n.valueFromString("c#4", err) == 61);
+        REQUIRE(*n.valueFromString("Db-1", err) == 1);
+        REQUIRE(*n.valueFromString("", err) == 0);
+    }
+
+    SECTION("Messages Match The String API")
+    {
+        auto p = pmd::ParamMetaData().asLinearDecibel();
+        pe_t err;
+        std::string em;
+        for (auto s : {"-200 dB", "nonsense", "24"})
+        {
+            REQUIRE(!p.valueFromString(s, err).has_value());
+            REQUIRE(!p.valueFromString(s, em).has_value());
+            REQUIRE(p.parseErrorToString(err) == em);
+        }
+        REQUIRE(em == "-96.00 dB < val < 12.00 dB");
+    }
+
+    SECTION("Modulation Depth")
+    {
+        auto p = pmd::ParamMetaData().asPercentBipolar();
+        pe_t err;
+        REQUIRE(*p.modulationNaturalFromString("50", 0.f, err) == Approx(0.5f));
+        REQUIRE(!p.modulationNaturalFromString("500", 0.f, err).has_value());
+        REQUIRE(err.code == pe_t::EXCEEDS_MAX_DEPTH);
+
+        std::string em;
+        REQUIRE(!p.modulationNaturalFromString("500", 0.f, em).has_value());
+        REQUIRE(em == p.parseErrorToString(err));
+        REQUIRE(!p.modulationNaturalFromString("x", 0.f, err).has_value());
+        REQUIRE(err.code == pe_t::INVALID_NUMBER);
+    }
+}
+
+TEST_CASE("Batch Normalized Conversion", "[param]")
+{
+    std::vector<pmd::ParamMetaData> ps{pmd::ParamMetaData().asPercent(),
+                                       pmd::ParamMetaData().asAudibleFrequency(),
+                                       pmd::ParamMetaData().asDecibel(),
+                                       pmd::ParamMetaData().asBool(),
+                                       pmd::ParamMetaData().asInt().withRange(-3, 12)};
+    static constexpr size_t n{257};
+    std::vector<float> norm(n), nat(n), out(n);
+    for (auto &p : ps)
+    {
+        INFO("Param type " << p.type << " range " << p.minVal << " " << p.maxVal);
+        for (size_t i = 0; i < n; ++i)
+        {
+            norm[i] = 1.f * i / (n - 1);
+            nat[i] = p.minVal + (p.maxVal - p.minVal) * i / (n - 1);
+        }
+
+        auto d = p.normalizationDescriptor();
+        pmd::ParamMetaData::normalized01ToNatural(d, norm.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == p.normalized01ToNatural(norm[i]));
+
+        p.naturalToNormalized01(nat.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == p.naturalToNormalized01(nat[i]));
+
+        pmd::simd::normalized01ToNatural(d, norm.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == p.normalized01ToNatural(norm[i]));
+
+        pmd::simd::naturalToNormalized01(d, nat.data(), out.data(), n);
+        for (size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == p.naturalToNormalized01(nat[i]));
+    }
+
+    SECTION("Clamps Out Of Range")
+    {
+        auto p = pmd::ParamMetaData().asPercent();
+        float in[3]{-0.5f, 0.5f, 1.5f}, res[3];
+        p.normalized01ToNatural(in, res, 3);
+        REQUIRE(res[0] == p.minVal);
+        REQUIRE(res[1] == Approx(0.5f));
+        REQUIRE(res[2] == p.maxVal);
+
+        float in4[4]{-0.5f, 0.25f, 1.5f, 1.f}, res4[4];
+        pmd::simd::normalized01ToNatural(p.normalizationDescriptor(), in4, res4, 4);
+        REQUIRE(res4[0] == p.minVal);
+        REQUIRE(res4[2] == p.maxVal);
+    }
+}
+
+TEST_CASE("Hot Descriptors", "[param]")
+{
+    using hot_t = pmd::ParamMetaData::HotDescriptor;
+    static_assert(sizeof(hot_t) == 32);
+
+    std::vector<pmd::ParamMetaData> ps{
+        pmd::ParamMetaData().asPercent().withID(7),
+        pmd::ParamMetaData().asAudibleFrequency().withID(12),
+        pmd::ParamMetaData().asCubicDecibelAttenuation().withID(3),
+        pmd::ParamMetaData().asInt().withRange(-3, 12).withID(99),
+        pmd::ParamMetaData().as25SecondExpTime().withID(4).extendable()};
+    pmd::ParamMetaData::HotDescriptorSet set(ps.begin(), ps.end());
+    REQUIRE(set.size() == ps.size());
+
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        auto &p = ps[i];
+        auto &h = set[i];
+        REQUIRE(set.idAt(i) == p.id);
+        REQUIRE(*set.indexOf(p.id) == i);
+        REQUIRE(h.type() == p.type);
+        REQUIRE(h.displayScale() == p.displayScale);
+        REQUIRE(h.polarity() == p.getPolarity());
+        REQUIRE(h.has(hot_t::CAN_EXTEND) == p.canExtend);
+        REQUIRE(h.defaultVal == p.defaultVal);
+        for (int j = 0; j <= 16; ++j)
+        {
+            auto nv = j / 16.f;
+            REQUIRE(h.normalized01ToNatural(nv) == p.normalized01ToNatural(nv));
+            auto v = h.normalized01ToNatural(nv);
+            REQUIRE(h.naturalToNormalized01(v) == p.naturalToNormalized01(v));
+        }
+    }
+    REQUIRE(!set.indexOf(1234).has_value());
+
+    REQUIRE(set[1].displayValue(0.f) == Approx(440.f));
+    REQUIRE(set[1].displayValue(12.f) == Approx(880.f));
+    REQUIRE(set[2].displayValue(set[2].defaultVal) == Approx(0.f).margin(1e-5));
+    REQUIRE(set[0].displayValue(0.5f) == Approx(50.f));
+}
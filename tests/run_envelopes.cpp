@@ -38,6 +38,7 @@
 
 #include "sst/basic-blocks/modulators/ADAREnvelope.h"
 #include "sst/basic-blocks/modulators/ADSREnvelope.h"
+#include "sst/basic-blocks/modulators/ADSREnvelopeBank.h"
 #include "sst/basic-blocks/modulators/DAHDEnvelope.h"
 #include "sst/basic-blocks/modulators/AHDSRShapedSC.h"
 #include "sst/basic-blocks/modulators/SimpleLFO.h"
@@ -174,4 +175,196 @@ TEST_CASE("Run SC Envelope Some", "[run]")
         }
         dumpMulti(all, "multiShape");
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("ADSR Without Cubed Cache", "[run]")
+{
+    namespace smod = sst::basic_blocks::modulators;
+    auto withCube = smod::ADSREnvelope<SampleSRProvider, tbs>(&srp);
+    auto noCube = smod::ADSREnvelope<SampleSRProvider, tbs, smod::TenSecondRange, false>(&srp);
+    // FMA contraction may round the two instantiations differently in the last bit
+#if defined(__FMA__)
+    constexpr float tol = 1e-6f;
+#else
+    constexpr float tol = 0.f;
+#endif
+
+    for (auto isDigital : {true, false})
+    {
+        INFO("Digital " << isDigital);
+        withCube.attackFrom(0.f, 0.f, 1, isDigital);
+        noCube.attackFrom(0.f, 0.f, 1, isDigital);
+        for (int blk = 0; blk < 400; ++blk)
+        {
+            bool gate = blk < 250;
+            withCube.processBlock(0.2, 0.3, 0.6, 0.25, 1, 1, 1, gate);
+            noCube.processBlock(0.2, 0.3, 0.6, 0.25, 1, 1, 1, gate);
+            for (int i = 0; i < tbs; ++i)
+            {
+                auto v = withCube.outputCache[i];
+                REQUIRE(noCube.outputCache[i] == Approx(v).epsilon(0).margin(tol));
+                REQUIRE(withCube.outputCacheCubed[i] == Approx(v * v * v).margin(1e-7));
+            }
+            REQUIRE(noCube.outputCubed == Approx(withCube.outputCubed).margin(1e-7));
+        }
+    }
+}
+
+TEST_CASE("ADSR Gate Change Within A Block", "[run]")
+{
+    using env_t = sst::basic_blocks::modulators::ADSREnvelope<SampleSRProvider, tbs>;
+
+    for (auto isDigital : {true, false})
+    {
+        INFO("Digital " << isDigital);
+        auto split = env_t(&srp);
+        auto whole = env_t(&srp);
+        split.attackFrom(0.f, 0.f, 1, isDigital);
+        whole.attackFrom(0.f, 0.f, 1, isDigital);
+
+        const float sus{0.6};
+        for (int blk = 0; blk < 2000; ++blk)
+        {
+            split.processBlock(0.1, 0.1, sus, 0.3, 1, 1, 1, true);
+            whole.processBlock(0.1, 0.1, sus, 0.3, 1, 1, 1, true);
+        }
+        REQUIRE(split.stage >= env_t::s_decay);
+        REQUIRE(split.stage <= env_t::s_sustain);
+        REQUIRE(split.outBlock0 == Approx(sus).margin(1e-3));
+
+        SECTION("Offset zero is a block gate change")
+        {
+            split.processBlockWithGateChangeAt(0.1, 0.1, sus, 0.3, 1, 1, 1, false, 0);
+            whole.processBlock(0.1, 0.1, sus, 0.3, 1, 1, 1, false);
+            for (int i = 0; i < tbs; ++i)
+                REQUIRE(split.outputCache[i] == whole.outputCache[i]);
+        }
+
+        SECTION("Release starts at the offset")
+        {
+            static constexpr int offset{tbs / 2 + 3};
+            split.processBlockWithGateChangeAt(0.1, 0.1, sus, 0.3, 1, 1, 1, false, offset);
+            REQUIRE(split.stage == env_t::s_release);
+            for (int i = 0; i < offset; ++i)
+                REQUIRE(split.outputCache[i] == Approx(sus).margin(1e-3));
+            for (int i = offset + 1; i < tbs; ++i)
+                REQUIRE(split.outputCache[i] < split.outputCache[i - 1]);
+
+            // and it releases down to the end
+            int blk{0};
+            while (split.stage != env_t::s_complete && blk < 10000)
+            {
+                split.processBlock(0.1, 0.1, sus, 0.3, 1, 1, 1, false);
+                blk++;
+            }
+            REQUIRE(split.stage == env_t::s_complete);
+            for (int i = 0; i < tbs; ++i)
+                REQUIRE(split.outputCache[i] == 0.f);
+        }
+    }
+}
+
+TEST_CASE("ADSR Envelope Bank Matches ADSR", "[run]")
+{
+    namespace smod = sst::basic_blocks::modulators;
+    static constexpr int nv{8};
+    using env_t = smod::ADSREnvelope<SampleSRProvider, tbs>;
+    using bank_t = smod::ADSREnvelopeBank<SampleSRProvider, tbs, nv>;
+
+    for (int tries = 0; tries < 10; ++tries)
+    {
+        INFO("Try " << tries);
+        float a[nv], d[nv], s[nv], r[nv];
+        int ash[nv], dsh[nv], rsh[nv], release[nv];
+        bool gate[nv];
+        for (int v = 0; v < nv; ++v)
+        {
+            a[v] = 0.3 * rand() / RAND_MAX;
+            d[v] = 0.3 * rand() / RAND_MAX;
+            s[v] = 1.0 * rand() / RAND_MAX;
+            r[v] = 0.3 * rand() / RAND_MAX;
+            ash[v] = (v + tries) % 3;
+            dsh[v] = (v + tries + 1) % 3;
+            rsh[v] = (v + 2 * tries) % 3;
+            release[v] = rand() % 300;
+        }
+
+        bank_t bank(&srp);
+        std::vector<std::unique_ptr<env_t>> envs;
+        for (int v = 0; v < nv; ++v)
+        {
+            envs.push_back(std::make_unique<env_t>(&srp));
+            // leave the last voice idle for the first part of the run
+            if (v != nv - 1)
+            {
+                bank.attackFrom(v, 0.f, ash[v]);
+                envs[v]->attackFrom(0.f, 0.f, ash[v], true);
+            }
+        }
+
+        for (int blk = 0; blk < 1500; ++blk)
+        {
+            if (blk == 100)
+            {
+                bank.attackFrom(nv - 1, 0.f, ash[nv - 1]);
+                envs[nv - 1]->attackFrom(0.f, 0.f, ash[nv - 1], true);
+            }
+            for (int v = 0; v < nv; ++v)
+                gate[v] = blk < release[v] + (v == nv - 1 ? 100 : 0);
+
+            bank.processBlock(a, d, s, r, ash, dsh, rsh, gate);
+            for (int v = 0; v < nv; ++v)
+            {
+                INFO("Block " << blk << " voice " << v);
+                envs[v]->processBlock(a[v], d[v], s[v], r[v], ash[v], dsh[v], rsh[v], gate[v]);
+                REQUIRE(bank.stage[v] == envs[v]->stage);
+                REQUIRE(bank.eoc_output[v] == envs[v]->eoc_output);
+                for (int i = 0; i < tbs; ++i)
+                    REQUIRE(bank.outputCache[v][i] ==
+                            Approx(envs[v]->outputCache[i]).margin(1e-5));
+            }
+        }
+        for (int v = 0; v < nv; ++v)
+            REQUIRE(bank.stage[v] == env_t::s_complete);
+    }
+}
+
+TEST_CASE("Envelopes Go Quiescent", "[run]")
+{
+    namespace smod = sst::basic_blocks::modulators;
+    using env_t = smod::ADSREnvelope<SampleSRProvider, tbs>;
+    using bank_t = smod::ADSREnvelopeBank<SampleSRProvider, tbs, 4>;
+
+    auto env = env_t(&srp);
+    REQUIRE(env.isQuiescent());
+
+    env.attackFrom(0.f, 0.f, 1, true);
+    REQUIRE(!env.isQuiescent());
+    int blk{0};
+    while (!env.isQuiescent() && blk < 10000)
+    {
+        env.processBlock(0.1, 0.1, 0.7, 0.1, 1, 1, 1, blk < 100);
+        REQUIRE((env.stage != env_t::s_complete || env.isQuiescent()));
+        blk++;
+    }
+    REQUIRE(env.isQuiescent());
+    for (int i = 0; i < 20; ++i)
+    {
+        env.processBlock(0.1, 0.1, 0.7, 0.1, 1, 1, 1, false);
+        REQUIRE(env.isQuiescent());
+        for (int s = 0; s < tbs; ++s)
+            REQUIRE(env.outputCache[s] == 0.f);
+    }
+
+    env.attackFrom(0.f, 0.f, 1, true);
+    env.processBlock(0.1, 0.1, 0.7, 0.1, 1, 1, 1, true);
+    REQUIRE(!env.isQuiescent());
+    REQUIRE(env.outputCache[tbs - 1] > 0.f);
+
+    bank_t bank(&srp);
+    for (int v = 0; v < 4; ++v)
+        REQUIRE(bank.isQuiescent(v));
+    bank.attackFrom(2, 0.f, 1);
+    REQUIRE(!bank.isQuiescent(2));
+    REQUIRE(bank.isQuiescent(1));
+}
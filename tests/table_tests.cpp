@@ -30,6 +30,16 @@
 #include "sst/basic-blocks/tables/DbToLinearProvider.h"
 #include "sst/basic-blocks/tables/EqualTuningProvider.h"
 #include "sst/basic-blocks/tables/TwoToTheXProvider.h"
+#include "sst/basic-blocks/tables/LanczosTableProvider.h"
+#include "sst/basic-blocks/tables/SineTableProvider.h"
+#include "sst/basic-blocks/tables/SincTableProvider.h"
+#include "sst/basic-blocks/tables/SharedTableRegistry.h"
+#include "sst/basic-blocks/dsp/LanczosResampler.h"
+#include "sst/basic-blocks/modulators/FXModControl.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 namespace tabl = sst::basic_blocks::tables;
 
@@ -69,3 +79,212 @@ TEST_CASE("Two to the X Provider", "[tables]")
         REQUIRE(twox.twoToThe(x) == Approx(pow(2.0, x)).margin(1e-5));
     }
 }
+
+TEST_CASE("Shared Sine and Lanczos Tables", "[tables]")
+{
+    SECTION("Sine")
+    {
+        using st_t = tabl::SineTableProvider<8192>;
+        REQUIRE(&st_t::shared() == &st_t::shared());
+        const auto &st = st_t::shared();
+        for (int i = 0; i < 8192; i += 7)
+            REQUIRE(st.table[i] == Approx(sin(2.0 * M_PI * i / 8192)).margin(1e-7));
+
+        // the FX mod control no longer carries its own copy
+        REQUIRE(sizeof(sst::basic_blocks::modulators::FXModControl<32>) < 1024);
+    }
+
+    SECTION("Lanczos")
+    {
+        using lt_t = tabl::LanczosTableProvider<4>;
+        const auto &lt = lt_t::shared();
+        REQUIRE(&lt == &lt_t::shared());
+        for (size_t t = 0; t < 8192; t += 13)
+        {
+            for (size_t i = 0; i < lt_t::filterWidth; ++i)
+            {
+                auto x = lt_t::dx * t + i - 4.0;
+                REQUIRE(lt.lanczosTable[t][i] == Approx(lt_t::kernel(x)).margin(1e-7));
+                REQUIRE(lt.lanczosTableDX[t][i] ==
+                        Approx(lt.lanczosTable[t + 1][i] - lt.lanczosTable[t][i]).margin(1e-7));
+            }
+        }
+
+        sst::basic_blocks::dsp::LanczosResampler<32> a(48000, 44100), b(44100, 96000);
+        REQUIRE(a.lanczosTable == &lt.lanczosTable[0]);
+        REQUIRE(b.lanczosTableDX == &lt.lanczosTableDX[0]);
+    }
+}
+
+TEST_CASE("SIMD and Block Table Lookups", "[tables]")
+{
+    // not a multiple of four so the tails run. The lanes use the scalar arithmetic but FMA
+    // contraction can differ, hence the tiny epsilon
+    static constexpr size_t n{259};
+    float in alignas(16)[n], out alignas(16)[n], lane alignas(16)[4];
+
+    SECTION("DB to Linear")
+    {
+        tabl::DbToLinearProvider dbt;
+        dbt.init();
+        for (size_t i = 0; i < n; ++i)
+            in[i] = -190.f + i * 0.7731f;
+        dbt.dbToLinearBlock(in, out, n);
+        for (size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == Approx(dbt.dbToLinear(in[i])).epsilon(1e-6));
+        _mm_store_ps(lane, dbt.dbToLinear(_mm_setr_ps(-6.f, 0.f, 3.5f, -96.f)));
+        REQUIRE(lane[1] == Approx(dbt.dbToLinear(0.f)).epsilon(1e-6));
+        REQUIRE(lane[3] == Approx(dbt.dbToLinear(-96.f)).epsilon(1e-6));
+    }
+
+    SECTION("Equal Tuning")
+    {
+        tabl::EqualTuningProvider equal;
+        equal.init();
+        for (size_t i = 0; i < n; ++i)
+            in[i] = -30.f + i * 0.6132f;
+        equal.note_to_pitch_block(in, out, n);
+        for (size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == Approx(equal.note_to_pitch(in[i])).epsilon(1e-6));
+        _mm_store_ps(lane, equal.note_to_pitch(_mm_setr_ps(60.f, 12.f, 0.f, -12.f)));
+        REQUIRE(lane[0] == 32.0);
+        REQUIRE(lane[1] == 2.0);
+        REQUIRE(lane[2] == 1.0);
+        REQUIRE(lane[3] == 0.5);
+    }
+
+    SECTION("Two to the X")
+    {
+        tabl::TwoToTheXProvider twox;
+        twox.init();
+        for (size_t i = 0; i < n; ++i)
+            in[i] = -20.f + i * 0.1417f;
+        twox.twoToTheBlock(in, out, n);
+        for (size_t i = 0; i < n; ++i)
+            REQUIRE(out[i] == Approx(twox.twoToThe(in[i])).epsilon(1e-6));
+
+        // the very top of the range stays inside the tables
+        _mm_store_ps(lane, twox.twoToThe(_mm_set1_ps(100.f)));
+        REQUIRE(lane[0] == Approx(pow(2.0, twox.providerRange + twox.intBase)).epsilon(1e-6));
+    }
+}
+
+TEST_CASE("Constexpr Generated Tables", "[tables]")
+{
+    // these are evaluated by the compiler; the checks are that they match init()
+    static constexpr auto twoX = tabl::TwoToTheXProvider::generated();
+    static constexpr auto dbt = tabl::DbToLinearProvider::generated();
+    static constexpr auto equal = tabl::EqualTuningProvider::generated();
+    static_assert(twoX.baseValue[15] == 1.f && twoX.table_two_to_the[1000] == 2.f);
+
+    tabl::TwoToTheXProvider twoXR;
+    tabl::DbToLinearProvider dbtR;
+    tabl::EqualTuningProvider equalR;
+    twoXR.init();
+    dbtR.init();
+    equalR.init();
+
+    // the entries themselves, in float ulps, since init() depends on the platform pow
+    auto ulps = [](float a, float b) {
+        int32_t ia, ib;
+        memcpy(&ia, &a, sizeof(float));
+        memcpy(&ib, &b, sizeof(float));
+        return std::abs(ia - ib);
+    };
+    for (int i = 0; i < tabl::TwoToTheXProvider::providerRange; ++i)
+        REQUIRE(ulps(twoX.baseValue[i], twoXR.baseValue[i]) <= 1);
+    for (int i = 0; i < tabl::TwoToTheXProvider::nInterp; ++i)
+        REQUIRE(ulps(twoX.table_two_to_the[i], twoXR.table_two_to_the[i]) <= 1);
+
+    for (float x = -14.9; x < 16; x += 0.0173)
+        REQUIRE(twoX.twoToThe(x) == Approx(twoXR.twoToThe(x)).epsilon(1e-6));
+    for (float db = -192; db < 100; db += 0.0327)
+        REQUIRE(dbt.dbToLinear(db) == Approx(dbtR.dbToLinear(db)).epsilon(1e-6));
+    for (float n = -100; n < 200; n += 0.0119)
+        REQUIRE(equal.note_to_pitch(n) == Approx(equalR.note_to_pitch(n)).epsilon(1e-6));
+
+    REQUIRE(equal.note_to_pitch(60) == 32.0);
+    REQUIRE(equal.note_to_pitch(12) == 2.0);
+}
+
+namespace
+{
+struct RateTable
+{
+    static inline int builds{0};
+    double rate{-1};
+    RateTable() { builds++; }
+    explicit RateTable(double sr) : rate(sr) { builds++; }
+};
+} // namespace
+
+TEST_CASE("Shared Table Registry", "[tables]")
+{
+    using reg = tabl::TableRegistry;
+
+    SECTION("One Initialized Copy Per Type")
+    {
+        using tt_t = tabl::TwoToTheXProvider;
+        REQUIRE(reg::useCount<tt_t>() == 0);
+        auto a = reg::acquire<tt_t>();
+        auto b = reg::acquire<tt_t>();
+        REQUIRE(a.get() == b.get());
+        REQUIRE(reg::useCount<tt_t>() == 2);
+        REQUIRE((size_t)a.get() % 64 == 0);
+        REQUIRE(a->twoToThe(3.f) == Approx(8.0).margin(1e-5));
+
+        {
+            auto c = a;
+            REQUIRE(reg::useCount<tt_t>() == 3);
+            auto d = std::move(c);
+            REQUIRE(!c);
+            REQUIRE(reg::useCount<tt_t>() == 3);
+        }
+        REQUIRE(reg::useCount<tt_t>() == 2);
+        a.reset();
+        b.reset();
+        REQUIRE(reg::useCount<tt_t>() == 0);
+
+        auto sinc = reg::acquire<tabl::ShortcircuitSincTableProvider>();
+        REQUIRE(sinc->SincTableF32[8 * 16 + 8] != 0.f);
+    }
+
+    SECTION("Keyed By Sample Rate")
+    {
+        RateTable::builds = 0;
+        auto a = reg::acquire<RateTable>(48000);
+        auto b = reg::acquire<RateTable>(44100);
+        auto c = reg::acquire<RateTable>(48000);
+        REQUIRE(RateTable::builds == 2);
+        REQUIRE(a.get() == c.get());
+        REQUIRE(a.get() != b.get());
+        REQUIRE(b->rate == 44100);
+        REQUIRE(reg::useCount<RateTable>(48000) == 2);
+
+        a.reset();
+        c.reset();
+        REQUIRE(reg::useCount<RateTable>(48000) == 0);
+        auto d = reg::acquire<RateTable>(48000);
+        REQUIRE(RateTable::builds == 3);
+    }
+
+    SECTION("Unkeyed Apart From Rate Zero")
+    {
+        RateTable::builds = 0;
+        auto zero = reg::acquire<RateTable>(0.0);
+        auto unkeyed = reg::acquire<RateTable>();
+        REQUIRE(RateTable::builds == 2);
+        REQUIRE(zero.get() != unkeyed.get());
+        REQUIRE(zero->rate == 0);
+        REQUIRE(unkeyed->rate == -1);
+        REQUIRE(reg::useCount<RateTable>() == 1);
+        REQUIRE(reg::useCount<RateTable>(0.0) == 1);
+
+        zero.reset();
+        REQUIRE(reg::useCount<RateTable>(0.0) == 0);
+        REQUIRE(reg::useCount<RateTable>() == 1);
+        auto again = reg::acquire<RateTable>();
+        REQUIRE(again.get() == unkeyed.get());
+        REQUIRE(RateTable::builds == 2);
+    }
+}